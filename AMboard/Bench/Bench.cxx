@@ -0,0 +1,482 @@
+#include <AMboard/CustomNodes/SimdMath.hxx>
+#include <AMboard/Macro/DataPin.hxx>
+#include <AMboard/Macro/ExecuteNode.hxx>
+#include <AMboard/Macro/ExecutionManager.hxx>
+
+#include <Util/RangeManager.hxx>
+
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cstdio>
+#include <format>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <random>
+#include <ranges>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace {
+
+// =========================================================================
+// HARNESS
+// =========================================================================
+
+struct SBenchOptions {
+    std::vector<size_t> Sizes { 16, 256, 4096 };
+    std::chrono::milliseconds MinTime { 200 };
+    std::string Filter;
+    std::string OutputPath;
+};
+
+struct SBenchResult {
+    std::string Name;
+    size_t Size;
+    uint64_t Runs;
+    uint64_t OpsPerRun;
+    double MedianNsPerOp;
+    double MinNsPerOp;
+};
+
+/// Prepare builds the graph once, untimed, every call of the returned function performs OpsPerRun operations
+struct SBenchCase {
+    std::string Name;
+    std::function<uint64_t(size_t Size)> OpsPerRun;
+    std::function<std::function<void()>(size_t Size)> Prepare;
+};
+
+/// Keeps the optimizer from discarding benchmarked reads
+template <typename Ty>
+void DoNotOptimize(const Ty& Value)
+{
+    static volatile Ty Sink;
+    Sink = Value;
+}
+
+SBenchResult Measure(const SBenchCase& Case, const size_t Size, const std::chrono::milliseconds MinTime)
+{
+    using Clock = std::chrono::steady_clock;
+
+    const auto Run = Case.Prepare(Size);
+    const auto OpsPerRun = Case.OpsPerRun(Size);
+
+    /// Warm caches and pools before anything is timed
+    Run();
+
+    std::vector<double> Samples;
+    const auto Deadline = Clock::now() + MinTime;
+    while (Samples.size() < 5 || Clock::now() < Deadline) {
+        const auto Start = Clock::now();
+        Run();
+        const auto Elapsed = std::chrono::duration<double, std::nano>(Clock::now() - Start).count();
+        Samples.push_back(Elapsed / static_cast<double>(OpsPerRun));
+    }
+
+    std::ranges::sort(Samples);
+    return {
+        .Name = Case.Name,
+        .Size = Size,
+        .Runs = Samples.size(),
+        .OpsPerRun = OpsPerRun,
+        .MedianNsPerOp = Samples[Samples.size() / 2],
+        .MinNsPerOp = Samples.front(),
+    };
+}
+
+std::string ToJson(const std::vector<SBenchResult>& Results, const SBenchOptions& Options)
+{
+    std::string Json = std::format("{{\n  \"min_time_ms\": {},\n  \"benchmarks\": [", Options.MinTime.count());
+    for (size_t Index = 0; Index < Results.size(); ++Index) {
+        const auto& Result = Results[Index];
+        Json += std::format(R"({}
+    {{"name": "{}", "size": {}, "runs": {}, "ops_per_run": {}, "ns_per_op": {:.3f}, "min_ns_per_op": {:.3f}, "ops_per_sec": {:.1f}}})",
+            Index == 0 ? "" : ",", Result.Name, Result.Size, Result.Runs, Result.OpsPerRun, Result.MedianNsPerOp, Result.MinNsPerOp, 1e9 / Result.MedianNsPerOp);
+    }
+
+    Json += "\n  ]\n}\n";
+    return Json;
+}
+
+// =========================================================================
+// NODES
+// =========================================================================
+
+/// Data node passing its input through plus one
+class CBenchDataNode : public CBaseNode {
+public:
+    explicit CBenchDataNode(const size_t InputCount = 1)
+    {
+        for (size_t Index = 0; Index < InputCount; ++Index)
+            EmplacePin<CDataPin>(true)->SetIsUniversalPin();
+        EmplacePin<CDataPin>(false)->SetIsUniversalPin();
+    }
+
+    bool Evaluate() noexcept override
+    {
+        CBaseNode::Evaluate();
+
+        uint64_t Sum = 1;
+        for (const auto& Pin : GetInputPins())
+            Sum += Pin->As<CDataPin>()->PinGetTrivial(uint64_t);
+        GetOutputPins()[0]->As<CDataPin>()->PinSet(uint64_t, Sum);
+        return true;
+    }
+};
+
+/// Pulls its data inputs the same way a flow step does, without running a flow
+class CBenchSinkNode : public CExecuteNode {
+public:
+    explicit CBenchSinkNode(const size_t InputCount = 1)
+    {
+        for (size_t Index = 0; Index < InputCount; ++Index)
+            EmplacePin<CDataPin>(true)->SetIsUniversalPin();
+    }
+
+    void Pull() noexcept
+    {
+        SFlowStep Step;
+        Step.Epoch = m_Manager->AdvanceEpoch();
+
+        const CStepScope Scope { Step };
+        PrepareInputPin();
+    }
+};
+
+class CBenchExecNode : public CExecuteNode {
+protected:
+    void Execute() override { }
+};
+
+template <typename NodeTy>
+using NodeList = std::vector<std::unique_ptr<NodeTy>>;
+
+template <typename NodeTy, typename... Args>
+NodeTy* Spawn(CExecutionManager& Manager, NodeList<CBaseNode>& Nodes, Args&&... Arguments)
+{
+    auto* Node = static_cast<NodeTy*>(Nodes.emplace_back(std::make_unique<NodeTy>(std::forward<Args>(Arguments)...)).get());
+    Manager.RegisterNode(Node);
+    return Node;
+}
+
+/// Owns everything a case needs across runs, nodes are released before the manager
+struct SBenchGraph {
+    std::unique_ptr<CExecutionManager> Manager = std::make_unique<CExecutionManager>();
+    NodeList<CBaseNode> Nodes;
+
+    ~SBenchGraph() { Nodes.clear(); }
+};
+
+// =========================================================================
+// CASES
+// =========================================================================
+
+std::vector<SBenchCase> MakeCases()
+{
+    std::vector<SBenchCase> Cases;
+
+    Cases.push_back({
+        "pin/connect_disconnect",
+        [](const size_t Size) { return Size * 2; },
+        [](const size_t Size) -> std::function<void()> {
+            auto Graph = std::make_shared<SBenchGraph>();
+            std::vector<std::pair<CPin*, CPin*>> Pairs;
+            for (size_t Index = 0; Index < Size; ++Index) {
+                auto* From = Spawn<CBenchDataNode>(*Graph->Manager, Graph->Nodes);
+                auto* To = Spawn<CBenchDataNode>(*Graph->Manager, Graph->Nodes);
+                Pairs.emplace_back(From->GetOutputPins()[0].get(), To->GetInputPins()[0].get());
+            }
+
+            return [Graph, Pairs = std::move(Pairs)] {
+                for (const auto& [Output, Input] : Pairs)
+                    Output->ConnectPin(Input);
+                for (const auto& [Output, Input] : Pairs)
+                    Output->DisconnectPin(Input);
+            };
+        },
+    });
+
+    Cases.push_back({
+        "datapin/set_get_trivial",
+        [](const size_t Size) { return Size * 2; },
+        [](const size_t Size) -> std::function<void()> {
+            auto Graph = std::make_shared<SBenchGraph>();
+            std::vector<CDataPin*> Pins;
+            for (size_t Index = 0; Index < Size; ++Index)
+                Pins.push_back(Spawn<CBenchDataNode>(*Graph->Manager, Graph->Nodes)->GetOutputPins()[0]->As<CDataPin>());
+
+            return [Graph, Pins = std::move(Pins)] {
+                uint64_t Sum = 0;
+                for (auto* Pin : Pins)
+                    Pin->PinSet(uint64_t, Sum++);
+                for (const auto* Pin : Pins)
+                    Sum += Pin->PinGetTrivial(uint64_t);
+                DoNotOptimize(Sum);
+            };
+        },
+    });
+
+    Cases.push_back({
+        "datapin/set_get_shared",
+        [](const size_t Size) { return Size * 2; },
+        [](const size_t Size) -> std::function<void()> {
+            auto Graph = std::make_shared<SBenchGraph>();
+            std::vector<CDataPin*> Pins;
+            for (size_t Index = 0; Index < Size; ++Index)
+                Pins.push_back(Spawn<CBenchDataNode>(*Graph->Manager, Graph->Nodes)->GetOutputPins()[0]->As<CDataPin>());
+
+            return [Graph, Pins = std::move(Pins)] {
+                for (auto* Pin : Pins)
+                    Pin->Set(MakeDataType("string"), std::make_shared<std::string>("benchmark"));
+                size_t Length = 0;
+                for (const auto* Pin : Pins)
+                    Length += Pin->Get<std::string>(MakeDataType("string")).size();
+                DoNotOptimize(Length);
+            };
+        },
+    });
+
+    Cases.push_back({
+        "datapin/assign",
+        [](const size_t Size) { return Size; },
+        [](const size_t Size) -> std::function<void()> {
+            auto Graph = std::make_shared<SBenchGraph>();
+            std::vector<std::pair<CDataPin*, CDataPin*>> Pairs;
+            for (size_t Index = 0; Index < Size; ++Index) {
+                auto* Source = Spawn<CBenchDataNode>(*Graph->Manager, Graph->Nodes)->GetOutputPins()[0]->As<CDataPin>();
+                auto* Target = Spawn<CBenchDataNode>(*Graph->Manager, Graph->Nodes)->GetInputPins()[0]->As<CDataPin>();
+                Source->PinSet(uint64_t, Index);
+                Pairs.emplace_back(Source, Target);
+            }
+
+            return [Graph, Pairs = std::move(Pairs)] {
+                for (const auto& [Source, Target] : Pairs)
+                    Target->Assign(Source);
+            };
+        },
+    });
+
+    /// Every node on the chain is re-evaluated, Size evaluations per run
+    Cases.push_back({
+        "prepare/deep_dirty",
+        [](const size_t Size) { return Size; },
+        [](const size_t Size) -> std::function<void()> {
+            auto Graph = std::make_shared<SBenchGraph>();
+            auto* Head = Spawn<CBenchDataNode>(*Graph->Manager, Graph->Nodes);
+            CBaseNode* Tail = Head;
+            for (size_t Index = 1; Index < Size; ++Index) {
+                auto* Next = Spawn<CBenchDataNode>(*Graph->Manager, Graph->Nodes);
+                Tail->GetOutputPins()[0]->ConnectPin(Next->GetInputPins()[0].get());
+                Tail = Next;
+            }
+
+            auto* Sink = Spawn<CBenchSinkNode>(*Graph->Manager, Graph->Nodes);
+            Tail->GetOutputPins()[0]->ConnectPin(Sink->GetInputPins()[1].get());
+
+            return [Graph, Head, Sink] {
+                Head->MarkDirty();
+                Sink->Pull();
+            };
+        },
+    });
+
+    /// Nothing changed upstream, measures the memo check over the chain
+    Cases.push_back({
+        "prepare/deep_clean",
+        [](const size_t Size) { return Size; },
+        [](const size_t Size) -> std::function<void()> {
+            auto Graph = std::make_shared<SBenchGraph>();
+            CBaseNode* Tail = Spawn<CBenchDataNode>(*Graph->Manager, Graph->Nodes);
+            for (size_t Index = 1; Index < Size; ++Index) {
+                auto* Next = Spawn<CBenchDataNode>(*Graph->Manager, Graph->Nodes);
+                Tail->GetOutputPins()[0]->ConnectPin(Next->GetInputPins()[0].get());
+                Tail = Next;
+            }
+
+            auto* Sink = Spawn<CBenchSinkNode>(*Graph->Manager, Graph->Nodes);
+            Tail->GetOutputPins()[0]->ConnectPin(Sink->GetInputPins()[1].get());
+
+            return [Graph, Sink] { Sink->Pull(); };
+        },
+    });
+
+    /// One sink with Size independent producers, goes through the worker pool
+    Cases.push_back({
+        "prepare/wide_dirty",
+        [](const size_t Size) { return Size; },
+        [](const size_t Size) -> std::function<void()> {
+            auto Graph = std::make_shared<SBenchGraph>();
+            auto* Sink = Spawn<CBenchSinkNode>(*Graph->Manager, Graph->Nodes, Size);
+
+            std::vector<CBaseNode*> Producers;
+            for (size_t Index = 0; Index < Size; ++Index) {
+                auto* Producer = Spawn<CBenchDataNode>(*Graph->Manager, Graph->Nodes);
+                Producer->GetOutputPins()[0]->ConnectPin(Sink->GetInputPins()[Index + 1].get());
+                Producers.push_back(Producer);
+            }
+
+            return [Graph, Sink, Producers = std::move(Producers)] {
+                for (auto* Producer : Producers)
+                    Producer->MarkDirty();
+                Sink->Pull();
+            };
+        },
+    });
+
+    Cases.push_back({
+        "execute/flow_chain",
+        [](const size_t Size) { return Size; },
+        [](const size_t Size) -> std::function<void()> {
+            auto Graph = std::make_shared<SBenchGraph>();
+            auto* Head = Spawn<CBenchExecNode>(*Graph->Manager, Graph->Nodes);
+            CExecuteNode* Tail = Head;
+            for (size_t Index = 1; Index < Size; ++Index) {
+                auto* Next = Spawn<CBenchExecNode>(*Graph->Manager, Graph->Nodes);
+                Tail->GetFlowOutputPins()[0]->ConnectPin(Next->GetFlowInputPins()[0]);
+                Tail = Next;
+            }
+
+            return [Graph, Head] { Graph->Manager->Execute(Head); };
+        },
+    });
+
+    /// Element-wise kernel behind vector<> math nodes, operands already of the result type
+    Cases.push_back({
+        "math/vector_add",
+        [](const size_t Size) { return Size; },
+        [](const size_t Size) -> std::function<void()> {
+            auto Lhs = std::make_shared<std::vector<float>>(Size, 1.5f);
+            auto Rhs = std::make_shared<std::vector<float>>(Size, 2.5f);
+            auto Output = std::make_shared<std::vector<float>>(Size);
+
+            return [Lhs, Rhs, Output] {
+                SimdMath::ElementWise<EMathOperation::Add, float>(std::span<const float> { *Lhs }, std::span<const float> { *Rhs }, *Output);
+                DoNotOptimize(Output->back());
+            };
+        },
+    });
+
+    /// Same, with an int operand promoted to float as it is read
+    Cases.push_back({
+        "math/vector_add_promoted",
+        [](const size_t Size) { return Size; },
+        [](const size_t Size) -> std::function<void()> {
+            auto Lhs = std::make_shared<std::vector<int32_t>>(Size, 3);
+            auto Rhs = std::make_shared<std::vector<float>>(Size, 2.5f);
+            auto Output = std::make_shared<std::vector<float>>(Size);
+
+            return [Lhs, Rhs, Output] {
+                SimdMath::ElementWise<EMathOperation::Add, float>(std::span<const int32_t> { *Lhs }, std::span<const float> { *Rhs }, *Output);
+                DoNotOptimize(Output->back());
+            };
+        },
+    });
+
+    /// Every other slot taken, then single slots and short ranges churn through the holes
+    Cases.push_back({
+        "range/set_remove_fragmented",
+        [](const size_t Size) { return Size * 2; },
+        [](const size_t Size) -> std::function<void()> {
+            auto Ranges = std::make_shared<CRangeManager>();
+            for (size_t Index = 0; Index < Size; ++Index)
+                Ranges->SetSlot(static_cast<int>(Index * 2));
+
+            std::vector<int> Holes(Size);
+            for (size_t Index = 0; Index < Size; ++Index)
+                Holes[Index] = static_cast<int>(Index * 2 + 1);
+            std::ranges::shuffle(Holes, std::mt19937 { 42 });
+
+            return [Ranges, Holes = std::move(Holes)] {
+                for (const auto Hole : Holes)
+                    Ranges->SetRange(Hole, 1);
+                for (const auto Hole : Holes)
+                    Ranges->RemoveRange(Hole, 1);
+            };
+        },
+    });
+
+    Cases.push_back({
+        "range/first_fit_fragmented",
+        [](const size_t) -> uint64_t { return 2; },
+        [](const size_t Size) -> std::function<void()> {
+            auto Ranges = std::make_shared<CRangeManager>();
+            for (size_t Index = 0; Index < Size; ++Index)
+                Ranges->SetSlot(static_cast<int>(Index * 2));
+
+            return [Ranges] {
+                /// A single slot fits the first hole, two slots only fit past the end
+                DoNotOptimize(Ranges->FirstFit(1));
+                DoNotOptimize(Ranges->FirstFit(2));
+            };
+        },
+    });
+
+    return Cases;
+}
+
+bool ParseArguments(const int Argc, char** Argv, SBenchOptions& Options)
+{
+    for (int i = 1; i < Argc; ++i) {
+        const std::string_view Arg = Argv[i];
+        if (i + 1 >= Argc)
+            return false;
+
+        const std::string_view Value = Argv[++i];
+        if (Arg == "--filter") {
+            Options.Filter = Value;
+        } else if (Arg == "--out") {
+            Options.OutputPath = Value;
+        } else if (Arg == "--min-time") {
+            int64_t Milliseconds = 0;
+            if (std::from_chars(Value.data(), Value.data() + Value.size(), Milliseconds).ec != std::errc())
+                return false;
+            Options.MinTime = std::chrono::milliseconds(Milliseconds);
+        } else if (Arg == "--sizes") {
+            Options.Sizes.clear();
+            for (const auto Token : std::views::split(Value, ',')) {
+                size_t Size = 0;
+                const std::string_view Text { Token.begin(), Token.end() };
+                if (std::from_chars(Text.data(), Text.data() + Text.size(), Size).ec != std::errc() || Size == 0)
+                    return false;
+                Options.Sizes.push_back(Size);
+            }
+        } else {
+            return false;
+        }
+    }
+
+    return true;
+}
+}
+
+int main(const int Argc, char** Argv)
+{
+    SBenchOptions Options;
+    if (!ParseArguments(Argc, Argv, Options)) {
+        std::fputs("usage: amb-bench [--filter <substring>] [--sizes 16,256,4096] [--min-time <ms>] [--out <file.json>]\n", stderr);
+        return 1;
+    }
+
+    std::vector<SBenchResult> Results;
+    for (const auto& Case : MakeCases()) {
+        if (!Options.Filter.empty() && !Case.Name.contains(Options.Filter))
+            continue;
+
+        for (const auto Size : Options.Sizes) {
+            const auto& Result = Results.emplace_back(Measure(Case, Size, Options.MinTime));
+            std::fprintf(stderr, "%-32s %8zu %12.2f ns/op\n", Result.Name.c_str(), Result.Size, Result.MedianNsPerOp);
+        }
+    }
+
+    const auto Json = ToJson(Results, Options);
+    if (Options.OutputPath.empty()) {
+        std::fputs(Json.c_str(), stdout);
+    } else if (std::ofstream File { Options.OutputPath }; !(File << Json)) {
+        std::fprintf(stderr, "Failed to write %s\n", Options.OutputPath.c_str());
+        return 1;
+    }
+
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,88 @@
+#include "BoardLoader.hxx"
+
+#include <AMboard/CustomNodes/CustomNodeManager.hxx>
+#include <AMboard/Macro/BaseNode.hxx>
+#include <AMboard/Macro/ExecuteNode.hxx>
+
+#include <Util/Assertions.hxx>
+
+#include <yaml-cpp/yaml.h>
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <random>
+#include <unordered_map>
+
+bool LoadBoard(const std::filesystem::path& Path, const CCustomNodeLoader& Loader, const std::function<void(SBoardNode&&)>& OnNode)
+{
+    VERIFY(std::filesystem::exists(Path), return false);
+
+    YAML::Node Graph;
+    try {
+        Graph = YAML::LoadFile(Path.string());
+    } catch (const YAML::Exception& Ex) {
+        spdlog::error("Failed to parse board {}: {}", Path.string(), Ex.what());
+        return false;
+    }
+
+    std::unordered_map<uint64_t, CPin*> PinHashMap;
+
+    for (const auto& Node : Graph["Nodes"]) {
+        SBoardNode Loaded;
+        Loaded.Name = Node["ID"].as<std::string>();
+        if (Node["pos"].IsDefined())
+            Loaded.Position = { Node["pos"][0].as<float>(), Node["pos"][1].as<float>() };
+        Loaded.HeaderColor = Node["header_color"].as<uint32_t>(Loaded.HeaderColor);
+
+        Loaded.Node = Loader.CreateNodeExt(Loaded.Name);
+        if (Loaded.Node == nullptr) [[unlikely]] {
+            spdlog::error("Node \"{}\" is not provided by any loaded extension", Loaded.Name);
+            continue;
+        }
+
+        if (auto NodeExt = Node["Ext"]; NodeExt)
+            Loaded.Node->ReadExtraContext(Loaded.Ext = NodeExt.as<std::string>());
+
+        if (auto NodePriority = Node["priority"]; NodePriority) {
+            const auto Name = NodePriority.as<std::string>();
+            const auto It = std::ranges::find(FlowPriorityNames, Name);
+            if (auto* ExecuteNode = dynamic_cast<CExecuteNode*>(Loaded.Node.get()); ExecuteNode != nullptr && It != FlowPriorityNames.end())
+                ExecuteNode->SetFlowPriority(static_cast<EFlowPriority>(It - FlowPriorityNames.begin()));
+            else
+                spdlog::warn("Ignoring priority \"{}\" of node \"{}\"", Name, Loaded.Name);
+        }
+
+        /// Pin ids are regenerated from the node's salt in pin order, see SaveCanvasTo
+        std::mt19937 rng(Node["salt"].as<uint64_t>());
+        std::uniform_int_distribution<uint64_t> dist;
+
+        for (const auto& Pin : Loaded.Node->GetInputPins())
+            MAKE_SURE(PinHashMap.insert({ dist(rng), Pin.get() }).second);
+        for (const auto& Pin : Loaded.Node->GetOutputPins())
+            MAKE_SURE(PinHashMap.insert({ dist(rng), Pin.get() }).second);
+
+        OnNode(std::move(Loaded));
+    }
+
+    for (const auto& Link : Graph["Links"]) {
+        const auto OutputId = Link[0].as<uint64_t>();
+        const auto InputId = Link[1].as<uint64_t>();
+
+        const auto OutputIt = PinHashMap.find(OutputId);
+        const auto InputIt = PinHashMap.find(InputId);
+
+        if (OutputIt == PinHashMap.end()) [[unlikely]] {
+            spdlog::error("Pin #{} missing", OutputId);
+            continue;
+        }
+        if (InputIt == PinHashMap.end()) [[unlikely]] {
+            spdlog::error("Pin #{} missing", InputId);
+            continue;
+        }
+
+        OutputIt->second->ConnectPin(InputIt->second);
+    }
+
+    return true;
+}
\ No newline at end of file
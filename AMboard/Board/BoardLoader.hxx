@@ -0,0 +1,27 @@
+#pragma once
+
+#include <array>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <string>
+
+class CBaseNode;
+class CCustomNodeLoader;
+
+/// Node the flow starts from when a board is run
+inline constexpr std::string_view EntranceNodeName = "Entrance Node";
+
+struct SBoardNode {
+    std::string Name;
+    std::array<float, 2> Position { };
+    uint32_t HeaderColor = 0xAAAAAA88;
+    /// Raw payload the node was restored from with ReadExtraContext
+    std::string Ext;
+    std::unique_ptr<CBaseNode, void (*)(CBaseNode*)> Node { nullptr, nullptr };
+};
+
+/// Reads a board yaml without any window or GPU state.
+/// Every node is created through Loader and handed to OnNode (which takes ownership) before any link is made,
+/// so it can be registered with a manager first. Returns false if the file could not be read
+bool LoadBoard(const std::filesystem::path& Path, const CCustomNodeLoader& Loader, const std::function<void(SBoardNode&&)>& OnNode);
\ No newline at end of file
@@ -0,0 +1,354 @@
+#include "BoardCompiler.hxx"
+
+#include <AMboard/Macro/ExecuteNode.hxx>
+
+#include <algorithm>
+#include <format>
+#include <iterator>
+#include <ranges>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+
+namespace {
+
+/// Input and flow output pins hold at most one connection
+const CPin* ConnectedTo(const CPin& Pin) noexcept
+{
+    const auto& Connections = Pin.GetConnections();
+    return Connections.empty() ? nullptr : *Connections.begin();
+}
+
+size_t IndexOf(const auto& Pins, const CPin* Pin) noexcept
+{
+    return std::ranges::find(Pins, Pin, [](const auto& Entry) -> const CPin* { return &*Entry; }) - Pins.begin();
+}
+
+/// Factory symbols follow the class name, which the display name was made from by dropping the leading C and splitting words
+std::string FactoryOf(const std::string_view Name)
+{
+    std::string Class = "C";
+    std::ranges::copy_if(Name, std::back_inserter(Class), [](const char Char) { return Char != ' '; });
+    return Class;
+}
+
+/// Ext is arbitrary bytes, the literal carries its length so embedded nulls survive
+std::string EscapeExt(const std::string_view Ext)
+{
+    std::string Literal = "\"";
+    for (const char Char : Ext) {
+        const auto Byte = static_cast<unsigned char>(Char);
+        if (Char == '"' || Char == '\\')
+            Literal += std::format("\\{}", Char);
+        else if (Byte < 0x20 || Byte >= 0x7F)
+            Literal += std::format("\\{:03o}", Byte);
+        else
+            Literal += Char;
+    }
+
+    return std::format("{{ {}\", {} }}", Literal, Ext.size());
+}
+
+class CBoardCompiler {
+
+public:
+    CBoardCompiler(const std::span<const SBoardNode> Nodes, std::vector<std::string>& Errors)
+        : m_Errors(Errors)
+    {
+        for (const auto& Node : Nodes)
+            m_Nodes.emplace(Node.Node.get(), &Node);
+    }
+
+    /// First resolves every step and the nodes it needs, then emits them
+    void Compile(const CExecuteNode& Entrance)
+    {
+        Resolve(Entrance);
+        if (!m_Errors.empty())
+            return;
+
+        EmitChain(Entrance, 2, false);
+    }
+
+    [[nodiscard]] bool IsAsync() const noexcept { return m_IsAsync; }
+    [[nodiscard]] const std::string& GetBody() const noexcept { return m_Body; }
+
+    /// Factory declarations, one per node class
+    [[nodiscard]] std::string GetDeclarations() const
+    {
+        std::string Declarations;
+        std::unordered_set<std::string> Declared;
+        for (const auto* Node : m_Spawned) {
+            if (const auto Factory = FactoryOf(NameOf(Node)); Declared.insert(Factory).second)
+                Declarations += std::format("extern \"C\" CBaseNode* create_{0}();\nextern \"C\" void destroy_{0}(CBaseNode* Node);\n", Factory);
+        }
+
+        return Declarations;
+    }
+
+    /// Nodes in spawn order, then their links, made once like LoadBoard does after creating every node.
+    /// Flow links are kept too since nodes look at them, e.g. a sequence skips unconnected branches and a parallel one starts its branches itself
+    [[nodiscard]] std::string GetConstruction() const
+    {
+        std::string Construction;
+        for (const auto* Node : m_Spawned) {
+            const auto Factory = FactoryOf(NameOf(Node));
+            const auto& Ext = m_Nodes.at(Node)->Ext;
+            if (Ext.empty())
+                Construction += std::format("        Spawn(&create_{0}, &destroy_{0});\n", Factory);
+            else
+                Construction += std::format("        Spawn(&create_{0}, &destroy_{0}, {1});\n", Factory, EscapeExt(Ext));
+        }
+
+        for (const auto* Node : m_Spawned) {
+            const auto& Outputs = Node->GetOutputPins();
+            for (size_t Output = 0; Output < Outputs.size(); ++Output) {
+                for (const auto* Target : Outputs[Output]->GetConnections()) {
+                    const auto* Owner = Target->GetOwner();
+                    if (m_Index.contains(Owner))
+                        Construction += std::format("        Link({}, {}, {}, {});\n", m_Index.at(Node), Output, m_Index.at(Owner), IndexOf(Owner->GetInputPins(), Target));
+                }
+            }
+        }
+
+        return Construction;
+    }
+
+private:
+    struct SStep {
+        /// Data nodes the step reads, in topological order
+        std::vector<uint32_t> Upstream;
+        bool IsSuspendable = false;
+    };
+
+    [[nodiscard]] std::string_view NameOf(const CBaseNode* Node) const
+    {
+        const auto It = m_Nodes.find(Node);
+        return It == m_Nodes.end() ? std::string_view { "<unknown>" } : std::string_view { It->second->Name };
+    }
+
+    template <typename... Args>
+    void Error(std::format_string<Args...> Format, Args&&... Arguments)
+    {
+        m_Errors.emplace_back(std::format(Format, std::forward<Args>(Arguments)...));
+    }
+
+    uint32_t Spawn(const CBaseNode* Node)
+    {
+        const auto [It, IsNew] = m_Index.emplace(Node, static_cast<uint32_t>(m_Spawned.size()));
+        if (IsNew) {
+            if (!m_Nodes.contains(Node))
+                Error("A node linked into the board was not loaded with it");
+            m_Spawned.push_back(Node);
+        }
+
+        return It->second;
+    }
+
+    // =========================================================================
+    // RESOLVE
+    // =========================================================================
+
+    /// Every node reached by the flow, each only once since joins and loops have no straight-line order
+    void Resolve(const CExecuteNode& Entrance)
+    {
+        std::unordered_set<const CExecuteNode*> Visited { &Entrance };
+        std::vector<const CExecuteNode*> Pending { &Entrance };
+
+        while (!Pending.empty()) {
+            const auto* Node = Pending.back();
+            Pending.pop_back();
+
+            ResolveStep(*Node);
+
+            /// Reversed so nodes are numbered in flow order
+            for (const auto* Output : Node->GetFlowOutputPins() | std::views::reverse) {
+                const auto* Target = ConnectedTo(*Output);
+                if (Target == nullptr)
+                    continue;
+
+                const auto* Next = static_cast<const CExecuteNode*>(Target->GetOwner());
+                if (!Visited.insert(Next).second) {
+                    Error("{}: reached by more than one flow, joins and loops are not compiled", NameOf(Next));
+                    return;
+                }
+
+                Pending.push_back(Next);
+            }
+        }
+    }
+
+    /// Iterative post-order over the upstream data nodes like the execution plan's closure, producers land before consumers.
+    /// Execute nodes feeding data are spawned for their outputs but never stepped unless the flow reaches them
+    void ResolveStep(const CExecuteNode& Node)
+    {
+        auto& Step = m_Steps[&Node];
+        Step.IsSuspendable = Node.IsSuspendable();
+        m_IsAsync |= Step.IsSuspendable;
+
+        std::unordered_set<const CBaseNode*> Visited;
+        std::vector<std::pair<const CBaseNode*, bool>> Stack;
+        std::vector<const CBaseNode*> Sources;
+
+        const auto PushUpstream = [&](const CBaseNode* Consumer) {
+            for (const auto& Input : Consumer->GetInputPins()) {
+                const auto* Source = *Input == EPinType::Data ? ConnectedTo(*Input) : nullptr;
+                if (Source == nullptr)
+                    continue;
+
+                if (const auto* Upstream = Source->GetOwner(); *Upstream == ENodeType::Execution)
+                    Sources.push_back(Upstream);
+                else if (!Visited.contains(Upstream))
+                    Stack.emplace_back(Upstream, false);
+            }
+        };
+
+        PushUpstream(&Node);
+        while (!Stack.empty()) {
+            const auto [Upstream, Expanded] = Stack.back();
+            Stack.pop_back();
+
+            if (Expanded) {
+                Step.Upstream.push_back(Spawn(Upstream));
+                continue;
+            }
+
+            /// Also guards against data cycles
+            if (!Visited.insert(Upstream).second)
+                continue;
+
+            Stack.emplace_back(Upstream, true);
+            PushUpstream(Upstream);
+        }
+
+        Spawn(&Node);
+        for (const auto* Source : Sources)
+            Spawn(Source);
+    }
+
+    // =========================================================================
+    // EMIT
+    // =========================================================================
+
+    void Line(const size_t Depth, const std::string_view Text)
+    {
+        m_Body.append(Depth * 4, ' ').append(Text).push_back('\n');
+    }
+
+    /// Steps Node and whatever follows it. Once its flow ends a nested chain breaks back to the step that called it
+    void EmitChain(const CExecuteNode& Node, const size_t Depth, const bool IsNested)
+    {
+        const auto Index = m_Index.at(&Node);
+        const auto& Step = m_Steps.at(&Node);
+
+        std::string Upstream;
+        for (const auto Data : Step.Upstream)
+            Upstream += std::format("{}{}", Upstream.empty() ? "" : ", ", Data);
+        Line(Depth, std::format("auto Step{0} = Prepare({0}, {{ {1}{2}}});", Index, Upstream, Upstream.empty() ? "" : " "));
+
+        if (m_IsAsync && Step.IsSuspendable) {
+            Line(Depth, std::format("for (auto IsDone = StartChild(Step{0}); !IsDone; IsDone = ResumeChild(Step{0}))", Index));
+            Line(Depth + 1, std::format("co_await WaitFor(Step{}.Ready->load());", Index));
+        } else {
+            Line(Depth, std::format("Run(Step{});", Index));
+        }
+
+        std::vector<std::pair<size_t, const CExecuteNode*>> Successors;
+        const auto& Outputs = Node.GetFlowOutputPins();
+        for (size_t Pin = 0; Pin < Outputs.size(); ++Pin) {
+            if (const auto* Target = ConnectedTo(*Outputs[Pin]))
+                Successors.emplace_back(Pin, static_cast<const CExecuteNode*>(Target->GetOwner()));
+        }
+
+        /// Nothing to continue with, the flow ends here whichever pin the step picked
+        if (Successors.empty())
+            return;
+
+        /// A single way on without sub-flows is a plain chain
+        if (!Node.HasCustomFlow() && Successors.size() == 1) {
+            Line(Depth, std::format("if (Step{}.Pin != {})", Index, Successors.front().first));
+            Line(Depth + 1, IsNested ? "break;" : m_IsAsync ? "co_return;" : "return;");
+            EmitChain(*Successors.front().second, Depth, IsNested);
+            return;
+        }
+
+        Line(Depth, std::format("for (; Step{0}.Pin != NoPin; Continue(Step{0})) {{", Index));
+        Line(Depth + 1, std::format("switch (Step{}.Pin) {{", Index));
+        for (const auto& [Pin, Next] : Successors) {
+            Line(Depth + 1, std::format("case {}: {{", Pin));
+            EmitChain(*Next, Depth + 2, true);
+            Line(Depth + 2, "break;");
+            Line(Depth + 1, "}");
+        }
+        Line(Depth + 1, "}");
+        Line(Depth, "}");
+    }
+
+    std::vector<std::string>& m_Errors;
+    std::unordered_map<const CBaseNode*, const SBoardNode*> m_Nodes;
+
+    /// Generated code addresses nodes by their place in m_Spawned
+    std::vector<const CBaseNode*> m_Spawned;
+    std::unordered_map<const CBaseNode*, uint32_t> m_Index;
+    std::unordered_map<const CExecuteNode*, SStep> m_Steps;
+
+    std::string m_Body;
+    bool m_IsAsync = false;
+};
+
+bool IsIdentifier(const std::string_view Name) noexcept
+{
+    const auto IsAlpha = [](const char Char) { return (Char >= 'a' && Char <= 'z') || (Char >= 'A' && Char <= 'Z') || Char == '_'; };
+    return !Name.empty() && IsAlpha(Name.front()) && std::ranges::all_of(Name, [&](const char Char) { return IsAlpha(Char) || (Char >= '0' && Char <= '9'); });
+}
+}
+
+SCompiledBoard CompileBoard(const std::span<const SBoardNode> Nodes, const std::string_view NodeName, const std::string_view BoardName)
+{
+    SCompiledBoard Result;
+
+    if (!IsIdentifier(NodeName)) {
+        Result.Errors.emplace_back(std::format("\"{}\" is not a valid C++ identifier", NodeName));
+        return Result;
+    }
+
+    const CExecuteNode* Entrance = nullptr;
+    for (const auto& Node : Nodes) {
+        if (Node.Name != EntranceNodeName)
+            continue;
+        if (Entrance != nullptr) {
+            Result.Errors.emplace_back(std::format("More than one {}", EntranceNodeName));
+            return Result;
+        }
+        Entrance = static_cast<const CExecuteNode*>(Node.Node.get());
+    }
+
+    if (Entrance == nullptr) {
+        Result.Errors.emplace_back(std::format("No {}", EntranceNodeName));
+        return Result;
+    }
+
+    CBoardCompiler Compiler { Nodes, Result.Errors };
+    Compiler.Compile(*Entrance);
+    if (!Result.Errors.empty())
+        return Result;
+
+    const auto ClassName = std::format("C{}Node", NodeName);
+    auto& Source = Result.Source;
+
+    Source += std::format("//\n// Generated by amb-aot from {}, changes are lost on the next export\n//\n\n", BoardName.empty() ? "a board" : BoardName);
+    Source += "#include <AMboard/Compiler/CompiledNode.hxx>\n"
+              "#include <AMboard/Macro/MacroDefines.hxx>\n\n";
+    Source += Compiler.GetDeclarations();
+
+    Source += std::format("\nclass {} : public CCompiledNode {{\npublic:\n", ClassName);
+    Source += std::format("    {}()\n    {{\n", ClassName);
+    Source += Compiler.GetConstruction();
+    Source += "    }\n\nprotected:\n";
+    Source += Compiler.IsAsync() ? "    CFlowTask ExecuteAsync() override\n" : "    void Execute() override\n";
+    Source += "    {\n";
+    Source += Compiler.GetBody();
+    Source += "    }\n};\n\n";
+    Source += std::format("REGISTER_MACROS({})\n", ClassName);
+
+    return Result;
+}
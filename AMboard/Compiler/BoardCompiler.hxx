@@ -0,0 +1,21 @@
+#pragma once
+
+#include <AMboard/Board/BoardLoader.hxx>
+
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+struct SCompiledBoard {
+    /// Complete translation unit, builds into a plugin exposing a single node
+    std::string Source;
+    /// One line per construct that could not be translated, Source is unusable unless empty
+    std::vector<std::string> Errors;
+};
+
+/// Translate the flow reachable from the board's entrance node into one CCompiledNode.
+/// The board's nodes are created through their plugins' factories with the Ext they were loaded with and their pins wired once,
+/// the flow becomes straight-line code stepping through them in an order resolved here, so every node keeps its plugin's semantics.
+/// Nodes must come from LoadBoard with their links made, NodeName is used for the class and the registered name
+SCompiledBoard CompileBoard(std::span<const SBoardNode> Nodes, std::string_view NodeName, std::string_view BoardName = { });
\ No newline at end of file
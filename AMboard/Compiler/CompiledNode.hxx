@@ -0,0 +1,135 @@
+#pragma once
+
+#include <AMboard/Macro/ExecuteNode.hxx>
+#include <AMboard/Macro/ExecutionManager.hxx>
+
+#include <atomic>
+#include <initializer_list>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+/// Base of the nodes amb-aot exports. The board's nodes are created through their plugins' factories and their pins wired once,
+/// the generated Execute or ExecuteAsync then steps through them in the order resolved at export
+class CCompiledNode : public CExecuteNode {
+public:
+    std::string_view GetCategory() noexcept override
+    {
+        return "Compiled";
+    }
+
+protected:
+    /// One pass through a board execute node, the flow continues from Pin or, if IsSubFlow, runs the sub-flow behind it
+    struct SChildStep {
+        CExecuteNode* Node = nullptr;
+        SFlowStep Step;
+        size_t Pin = NoPin;
+        bool IsSubFlow = false;
+        /// Set by the wake sources of a suspended child, replaced before every resume
+        std::shared_ptr<std::atomic<std::shared_ptr<CFlowEvent>>> Ready;
+    };
+
+    void Spawn(const CreateFunc Create, const DestroyFunc Destroy, const std::string_view Ext = { })
+    {
+        const auto& Node = m_Nodes.emplace_back(Create(), Destroy);
+        if (!Ext.empty())
+            Node->ReadExtraContext(std::string { Ext });
+    }
+
+    /// Flow links are made too, nodes look at them even though the generated code decides where the flow goes
+    void Link(const size_t From, const size_t Output, const size_t To, const size_t Input) const
+    {
+        m_Nodes[From]->GetOutputPins()[Output]->ConnectPin(m_Nodes[To]->GetInputPins()[Input].get());
+    }
+
+    /// Refresh the data nodes Index reads, listed in topological order, under the epoch its step then runs in
+    SChildStep Prepare(const size_t Index, const std::initializer_list<uint32_t> Upstream)
+    {
+        AdoptManager();
+
+        const auto& Outer = GetStep();
+        SChildStep Child { .Node = static_cast<CExecuteNode*>(m_Nodes[Index].get()), .Step = { .Flow = Outer.Flow, .StopToken = Outer.StopToken } };
+
+        /// Without a manager there is no epoch to share, the step pulls its inputs itself
+        if (m_Manager != nullptr) {
+            Child.Step.Epoch = m_Manager->AcquireStepEpoch(Outer.Flow, Child.Node);
+            Child.Step.IsEpochPrepared = true;
+            for (const auto Node : Upstream)
+                m_Nodes[Node]->Refresh(Child.Step.Epoch);
+        }
+
+        return Child;
+    }
+
+    /// Child that never suspends, a suspendable one outside ExecuteAsync blocks the thread instead
+    void Run(SChildStep& Child) const
+    {
+        Child.Node->ExecuteNode(Child.Step);
+        Settle(Child);
+    }
+
+    /// Suspendable child within ExecuteAsync, the caller awaits Child.Ready until StartChild or ResumeChild returns true
+    bool StartChild(SChildStep& Child) const
+    {
+        Child.Ready = std::make_shared<std::atomic<std::shared_ptr<CFlowEvent>>>(std::make_shared<CFlowEvent>());
+        if (!Child.Node->StartAsync(Child.Step, [Ready = Child.Ready] { Ready->load()->Set(); }))
+            return false;
+
+        FinishChild(Child);
+        return true;
+    }
+
+    bool ResumeChild(SChildStep& Child) const
+    {
+        /// Our wait also ends on a stop request, the child wakes on the same request right after
+        Child.Ready->load()->Wait();
+        Child.Ready->store(std::make_shared<CFlowEvent>());
+        if (!Child.Node->ResumeAsync(Child.Step))
+            return false;
+
+        FinishChild(Child);
+        return true;
+    }
+
+    /// Called once the flow behind Child.Pin ended, a sub-flow returns to the child while any other flow is over
+    void Continue(SChildStep& Child) const
+    {
+        if (!Child.IsSubFlow || Child.Pin == NoPin) {
+            Child.Pin = NoPin;
+            return;
+        }
+
+        Child.Node->ReturnFromSubFlow(Child.Step, Child.Step.SubFlowState);
+        Settle(Child);
+    }
+
+private:
+    void FinishChild(SChildStep& Child) const
+    {
+        Child.Node->FinishAsync(Child.Step);
+        Settle(Child);
+    }
+
+    /// A stop request ends the flow between steps, like it does in the manager
+    void Settle(SChildStep& Child) const
+    {
+        Child.IsSubFlow = Child.Step.SubFlowPin != NoPin;
+        Child.Pin = IsStopRequested() ? NoPin : Child.IsSubFlow ? std::exchange(Child.Step.SubFlowPin, NoPin) : Child.Step.DesiredOutputPin;
+    }
+
+    /// Board nodes follow us into our manager, in index order so the data nodes among them keep a valid topological order
+    void AdoptManager()
+    {
+        if (m_AdoptedManager == m_Manager)
+            return;
+
+        for (const auto& Node : m_Nodes)
+            Node->SetManager(m_Manager);
+        m_AdoptedManager = m_Manager;
+    }
+
+    std::vector<std::unique_ptr<CBaseNode, DestroyFunc>> m_Nodes;
+    CExecutionManager* m_AdoptedManager = nullptr;
+};
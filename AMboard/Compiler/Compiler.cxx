@@ -0,0 +1,104 @@
+#include "BoardCompiler.hxx"
+
+#include <AMboard/CustomNodes/CustomNodeManager.hxx>
+#include <AMboard/Macro/BaseNode.hxx>
+#include <AMboard/Macro/ExecutionManager.hxx>
+#include <AMboard/Macro/GraphTransaction.hxx>
+
+#include <spdlog/spdlog.h>
+
+#include <fstream>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+namespace {
+enum EExitCode : int {
+    Success = 0,
+    UsageError = 1,
+    LoadError = 2,
+    CompileError = 3,
+    WriteError = 4,
+};
+
+void PrintUsage()
+{
+    spdlog::info("usage: amb-aot <board.yaml> --name <NodeName> [--ext <dir>] [--out <file.cxx>]");
+}
+
+struct SCompileOptions {
+    std::filesystem::path Board;
+    std::filesystem::path ExtDir = "NodeExts";
+    std::filesystem::path Output;
+    std::string NodeName;
+};
+
+std::optional<SCompileOptions> ParseArguments(const int Argc, char** Argv)
+{
+    SCompileOptions Options;
+    for (int i = 1; i < Argc; ++i) {
+        const std::string_view Arg = Argv[i];
+        const bool HasValue = i + 1 < Argc;
+
+        if (Arg == "--ext" && HasValue) {
+            Options.ExtDir = Argv[++i];
+        } else if (Arg == "--name" && HasValue) {
+            Options.NodeName = Argv[++i];
+        } else if (Arg == "--out" && HasValue) {
+            Options.Output = Argv[++i];
+        } else if (Options.Board.empty() && !Arg.starts_with("--")) {
+            Options.Board = Arg;
+        } else {
+            return std::nullopt;
+        }
+    }
+
+    if (Options.Board.empty() || Options.NodeName.empty())
+        return std::nullopt;
+    if (Options.Output.empty())
+        Options.Output = Options.Board.stem().string() + ".cxx";
+    return Options;
+}
+}
+
+int main(const int Argc, char** Argv)
+{
+    const auto Options = ParseArguments(Argc, Argv);
+    if (!Options) {
+        PrintUsage();
+        return UsageError;
+    }
+
+    /// Destroyed in reverse, nodes before the manager and everything before the plugins their code lives in
+    const CCustomNodeLoader Loader { Options->ExtDir, nullptr };
+    CExecutionManager Manager;
+    std::vector<SBoardNode> Nodes;
+
+    {
+        CGraphTransaction Transaction { Manager };
+
+        const bool Loaded = LoadBoard(Options->Board, Loader, [&](SBoardNode&& Node) {
+            Manager.RegisterNode(Node.Node.get());
+            Nodes.emplace_back(std::move(Node));
+        });
+
+        if (!Loaded)
+            return LoadError;
+    }
+
+    const auto Compiled = CompileBoard(Nodes, Options->NodeName, Options->Board.filename().string());
+    if (!Compiled.Errors.empty()) {
+        for (const auto& Error : Compiled.Errors)
+            spdlog::error("{}", Error);
+        return CompileError;
+    }
+
+    std::ofstream File { Options->Output, std::ios::binary };
+    if (!(File << Compiled.Source)) {
+        spdlog::error("Failed to write {}", Options->Output.string());
+        return WriteError;
+    }
+
+    spdlog::info("Compiled {} node(s) into {}", Nodes.size(), Options->Output.string());
+    return Success;
+}
\ No newline at end of file
@@ -96,14 +96,14 @@ CInputDispatcher& CInputDispatcher::Get()
     return instance;
 }
 
-void CInputDispatcher::Play(const std::vector<SPlaybackEvent>& sequence)
+void CInputDispatcher::Play(const std::vector<SPlaybackEvent>& sequence, std::function<void()> onFinished)
 {
     Stop(); // Ensure any currently playing sequence is stopped
 
     m_playing = true;
     m_CurrentPlaybackCount = sequence.size();
     m_CurrentPlaybackProgress = 0;
-    m_playbackThread = std::thread(&CInputDispatcher::PlaybackLoop, this, sequence);
+    m_playbackThread = std::thread(&CInputDispatcher::PlaybackLoop, this, sequence, std::move(onFinished));
 }
 
 void CInputDispatcher::Stop()
@@ -122,7 +122,7 @@ bool CInputDispatcher::IsPlaying() const
     return m_playing.load();
 }
 
-void CInputDispatcher::PlaybackLoop(const std::vector<SPlaybackEvent> Sequence)
+void CInputDispatcher::PlaybackLoop(const std::vector<SPlaybackEvent> Sequence, const std::function<void()> OnFinished)
 {
     const auto StartTimestamp = std::chrono::steady_clock::now();
     for (int i = 0; i < Sequence.size(); ++i) {
@@ -144,4 +144,7 @@ void CInputDispatcher::PlaybackLoop(const std::vector<SPlaybackEvent> Sequence)
 
     m_playing = false;
     spdlog::info("[Dispatcher] Playback finished");
+
+    if (OnFinished)
+        OnFinished();
 }
\ No newline at end of file
@@ -16,7 +16,8 @@ public:
     static CInputDispatcher& Get();
 
     // Starts playing a sequence of events in a background thread
-    void Play(const std::vector<SPlaybackEvent>& sequence);
+    // The optional callback is invoked on the playback thread once it ends, finished or stopped
+    void Play(const std::vector<SPlaybackEvent>& sequence, std::function<void()> onFinished = nullptr);
 
     // Instantly stops playback, interrupting any ongoing delays
     void Stop();
@@ -38,6 +39,6 @@ private:
     volatile size_t m_CurrentPlaybackCount { 0 };
     volatile size_t m_CurrentPlaybackProgress { 0 };
 
-    void PlaybackLoop(std::vector<SPlaybackEvent> Sequence);
+    void PlaybackLoop(std::vector<SPlaybackEvent> Sequence, std::function<void()> OnFinished);
     void InjectEvent(const SInputEvent& ev);
 };
\ No newline at end of file
@@ -33,6 +33,10 @@ class CScreenCapture : public CBaseNode {
 public:
     CScreenCapture()
     {
+        /// Screen content changes behind our back, but not within one flow step
+        m_IsVolatile = true;
+        m_IsShareable = true;
+
         EmplacePin<CDataPin>(true)->SetValueType("cv::Rect").SetToolTips("Area");
         EmplacePin<CDataPin>(false)->SetValueType("cv::Mat").SetToolTips("Image");
     }
@@ -42,56 +46,65 @@ public:
         if (!CBaseNode::Evaluate())
             return false;
 
-        SDpiSetup DS;
+        const auto* RectPtr = GetInputPinsWith<EPinType::Data>().front()->As<CDataPin>()->PinTryGet(cv::Rect);
+        if (RectPtr == nullptr)
+            return false;
 
-        const auto Rect = GetInputPinsWith<EPinType::Data>().front()->As<CDataPin>()->PinGet(cv::Rect);
+        const auto Rect = *RectPtr;
         if (Rect.area() == 0)
             return true; /// ???
 
-        // 2. Get device contexts and create a bitmap
-        const HDC hScreenDC = GetDC(nullptr);
-        const HDC hMemoryDC = CreateCompatibleDC(hScreenDC);
-        const HBITMAP hBitmap = CreateCompatibleBitmap(hScreenDC, Rect.width, Rect.height);
-        const auto hOldBitmap = static_cast<HBITMAP>(SelectObject(hMemoryDC, hBitmap));
-
-        // 3. Copy pixels from the screen to the memory device context
-        BitBlt(hMemoryDC, 0, 0, Rect.width, Rect.height, hScreenDC, Rect.x, Rect.y, SRCCOPY);
-
-        // 4. Prepare OpenCV Mat
-        // FIX: cv::Mat takes (rows, cols) -> (height, width)!!!
-        cv::Mat img(Rect.height, Rect.width, CV_8UC4);
-
-        // 5. Set up Bitmap Info Header
-        BITMAPINFOHEADER bi;
-        bi.biSize = sizeof(BITMAPINFOHEADER);
-        bi.biWidth = Rect.width;
-        // IMPORTANT: Negative height ensures a top-down DIB (matches OpenCV's layout)
-        bi.biHeight = -Rect.height;
-        bi.biPlanes = 1;
-        bi.biBitCount = 32;
-        bi.biCompression = BI_RGB;
-        bi.biSizeImage = 0;
-        bi.biXPelsPerMeter = 0;
-        bi.biYPelsPerMeter = 0;
-        bi.biClrUsed = 0;
-        bi.biClrImportant = 0;
-
-        // FIX: Unselect the bitmap from the memory DC BEFORE calling GetDIBits
-        // (Microsoft docs state the bitmap must not be selected into a DC during GetDIBits)
-        SelectObject(hMemoryDC, hOldBitmap);
-
-        // 6. Extract pixels directly into the cv::Mat data buffer
-        if (!GetDIBits(hScreenDC, hBitmap, 0, Rect.height, img.data, reinterpret_cast<BITMAPINFO*>(&bi), DIB_RGB_COLORS)) {
-            spdlog::error("GetDIBits failed to extract pixels.");
-        }
-
-        // 7. CLEANUP
-        DeleteObject(hBitmap);
-        DeleteDC(hMemoryDC);
-        ReleaseDC(nullptr, hScreenDC);
-
-        // 8. Convert BGRA to BGR (OpenCV standard)
-        cv::cvtColor(img, GetOutputPins()[0]->As<CDataPin>()->Set("cv::Mat", std::make_shared<cv::Mat>()), cv::COLOR_BGRA2BGR);
+        /// Blocking I/O, the flow only waits once something reads the image
+        GetOutputPins()[0]->As<CDataPin>()->PinSetAsync(cv::Mat, GetWorkerPool(), [Rect] {
+            SDpiSetup DS;
+
+            // 2. Get device contexts and create a bitmap
+            const HDC hScreenDC = GetDC(nullptr);
+            const HDC hMemoryDC = CreateCompatibleDC(hScreenDC);
+            const HBITMAP hBitmap = CreateCompatibleBitmap(hScreenDC, Rect.width, Rect.height);
+            const auto hOldBitmap = static_cast<HBITMAP>(SelectObject(hMemoryDC, hBitmap));
+
+            // 3. Copy pixels from the screen to the memory device context
+            BitBlt(hMemoryDC, 0, 0, Rect.width, Rect.height, hScreenDC, Rect.x, Rect.y, SRCCOPY);
+
+            // 4. Prepare OpenCV Mat
+            // FIX: cv::Mat takes (rows, cols) -> (height, width)!!!
+            cv::Mat img(Rect.height, Rect.width, CV_8UC4);
+
+            // 5. Set up Bitmap Info Header
+            BITMAPINFOHEADER bi;
+            bi.biSize = sizeof(BITMAPINFOHEADER);
+            bi.biWidth = Rect.width;
+            // IMPORTANT: Negative height ensures a top-down DIB (matches OpenCV's layout)
+            bi.biHeight = -Rect.height;
+            bi.biPlanes = 1;
+            bi.biBitCount = 32;
+            bi.biCompression = BI_RGB;
+            bi.biSizeImage = 0;
+            bi.biXPelsPerMeter = 0;
+            bi.biYPelsPerMeter = 0;
+            bi.biClrUsed = 0;
+            bi.biClrImportant = 0;
+
+            // FIX: Unselect the bitmap from the memory DC BEFORE calling GetDIBits
+            // (Microsoft docs state the bitmap must not be selected into a DC during GetDIBits)
+            SelectObject(hMemoryDC, hOldBitmap);
+
+            // 6. Extract pixels directly into the cv::Mat data buffer
+            if (!GetDIBits(hScreenDC, hBitmap, 0, Rect.height, img.data, reinterpret_cast<BITMAPINFO*>(&bi), DIB_RGB_COLORS)) {
+                spdlog::error("GetDIBits failed to extract pixels.");
+            }
+
+            // 7. CLEANUP
+            DeleteObject(hBitmap);
+            DeleteDC(hMemoryDC);
+            ReleaseDC(nullptr, hScreenDC);
+
+            // 8. Convert BGRA to BGR (OpenCV standard)
+            auto Result = std::make_shared<cv::Mat>();
+            cv::cvtColor(img, *Result, cv::COLOR_BGRA2BGR);
+            return Result;
+        });
 
         return true;
     }
@@ -124,9 +137,11 @@ protected:
         if (!*InputPin)
             return;
 
-        const auto& Image = InputPin->PinGet(cv::Mat);
-        if (Image.empty())
+        /// Null if the capture producing it failed
+        const auto* ImagePtr = InputPin->PinTryGet(cv::Mat);
+        if (ImagePtr == nullptr || ImagePtr->empty())
             return;
+        const auto& Image = *ImagePtr;
 
         // 1. Encode the image into a BMP format in memory
         std::vector<uchar> buffer;
@@ -197,7 +212,7 @@ public:
     void Execute() override
     {
         if (std::filesystem::exists(m_ImagePath)) {
-            GetOutputPinsWith<EPinType::Data>().front()->As<CDataPin>()->Set("cv::Mat", std::make_shared<cv::Mat>(cv::imread(m_ImagePath)));
+            GetOutputPinsWith<EPinType::Data>().front()->As<CDataPin>()->PinSetAsync(cv::Mat, GetWorkerPool(), [Path = m_ImagePath] { return std::make_shared<cv::Mat>(cv::imread(Path)); });
         }
     }
 
@@ -235,6 +250,8 @@ class CImageTemplateMatch : public CBaseNode {
 public:
     CImageTemplateMatch()
     {
+        m_IsPure = true;
+
         EmplacePin<CDataPin>(true)->SetValueType("cv::Mat").SetToolTips("Source");
         EmplacePin<CDataPin>(true)->SetValueType("cv::Mat").SetToolTips("Template");
         EmplacePin<CDataPin>(true)->SetValueType("bool").SetToolTips("grayscale");
@@ -255,8 +272,13 @@ public:
             | std::views::transform([](const auto& ptr) { return static_cast<CDataPin*>(ptr.get()); })
             | std::ranges::to<std::vector>();
 
-        auto Source = InputPins[0]->PinGet(cv::Mat);
-        auto Template = InputPins[1]->PinGet(cv::Mat);
+        const auto* SourcePtr = InputPins[0]->PinTryGet(cv::Mat);
+        const auto* TemplatePtr = InputPins[1]->PinTryGet(cv::Mat);
+        if (SourcePtr == nullptr || TemplatePtr == nullptr)
+            return false;
+
+        auto Source = *SourcePtr;
+        auto Template = *TemplatePtr;
 
         if (InputPins[2]->PinGetTrivial(bool)) {
             cv::cvtColor(Source, Source, cv::COLOR_BGR2GRAY);
@@ -277,4 +299,5 @@ public:
 };
 
 REGISTER_MACROS(CScreenCapture, CLoadImage, CWriteImageToClipboard, CImageTemplateMatch)
+REGISTER_COLLECTIONS(MakeVectorTraits<cv::Mat>(MakeDataType("vector<cv::Mat>"), MakeDataType("cv::Mat")))
 ENABLE_IMGUI()
\ No newline at end of file
@@ -11,8 +11,19 @@
 #include <AMboard/Control/InputDispatcher.hxx>
 #include <AMboard/Control/InputService.hxx>
 
+#include "SimdMath.hxx"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdio>
 #include <iostream>
+#include <ranges>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
 #include <variant>
+#include <vector>
 
 #include <spdlog/spdlog.h>
 
@@ -25,14 +36,6 @@
 #include <Carbon/Carbon.h>
 #endif
 
-// 1. Define the Math Operations
-enum class EMathOperation {
-    Add,
-    Subtract,
-    Multiply,
-    Divide
-};
-
 // A. Add the type to the Variant
 using NumericVariant = std::variant<
     int8_t, uint8_t,
@@ -65,6 +68,31 @@ constexpr std::string_view TypeName<float> = "float";
 template <>
 constexpr std::string_view TypeName<double> = "double";
 
+// Array pins, element-wise counterparts of the scalars above
+template <>
+constexpr std::string_view TypeName<std::vector<int8_t>> = "vector<int8_t>";
+template <>
+constexpr std::string_view TypeName<std::vector<uint8_t>> = "vector<uint8_t>";
+template <>
+constexpr std::string_view TypeName<std::vector<int16_t>> = "vector<int16_t>";
+template <>
+constexpr std::string_view TypeName<std::vector<uint16_t>> = "vector<uint16_t>";
+template <>
+constexpr std::string_view TypeName<std::vector<int32_t>> = "vector<int32_t>";
+template <>
+constexpr std::string_view TypeName<std::vector<uint32_t>> = "vector<uint32_t>";
+template <>
+constexpr std::string_view TypeName<std::vector<int64_t>> = "vector<int64_t>";
+template <>
+constexpr std::string_view TypeName<std::vector<uint64_t>> = "vector<uint64_t>";
+template <>
+constexpr std::string_view TypeName<std::vector<float>> = "vector<float>";
+template <>
+constexpr std::string_view TypeName<std::vector<double>> = "vector<double>";
+
+template <typename T>
+constexpr SDataType TypeOf = MakeDataType(TypeName<T>);
+
 // C. Define the Promotion Rank (Higher rank becomes the result type)
 template <typename T>
 constexpr int TypeRank = 0;
@@ -97,31 +125,161 @@ constexpr int TypeRank<double> = 10;
 template <typename T1, typename T2>
 using PromotedType = std::conditional_t<(TypeRank<T1> > TypeRank<T2>), T1, T2>;
 
-// Parse void* to Variant using C++17 Fold Expressions
-template <typename Variant>
-Variant ParseData(const std::string_view& ty, const double data)
+// =========================================================================
+// MATH DISPATCH TABLE
+// =========================================================================
+
+constexpr size_t NumericTypeCount = std::variant_size_v<NumericVariant>;
+constexpr size_t MathOperationCount = 4;
+
+template <size_t Index>
+using NumericAt = std::variant_alternative_t<Index, NumericVariant>;
+
+// Scalars first, then their vector<> counterparts in the same order
+constexpr size_t OperandTypeCount = NumericTypeCount * 2;
+
+constexpr auto OperandTypeIds = []<size_t... Is>(std::index_sequence<Is...>) {
+    return std::array<DataTypeId, OperandTypeCount> { TypeOf<NumericAt<Is>>.Id..., TypeOf<std::vector<NumericAt<Is>>>.Id... };
+}(std::make_index_sequence<NumericTypeCount> { });
+
+// Smallest modulus under which every operand type id lands in its own slot
+constexpr size_t OperandSlotCount = [] {
+    for (size_t Modulus = OperandTypeCount;; ++Modulus) {
+        std::array<bool, 256> Used { };
+        bool Distinct = true;
+        for (const auto Id : OperandTypeIds)
+            Distinct &= !std::exchange(Used[Id % Modulus], true);
+        if (Distinct)
+            return Modulus;
+    }
+}();
+static_assert(OperandSlotCount <= 256);
+
+// Slot -> operand index + 1, 0 for empty slots
+constexpr auto OperandSlots = [] {
+    std::array<uint8_t, OperandSlotCount> Slots { };
+    for (size_t Index = 0; Index < OperandTypeCount; ++Index)
+        Slots[OperandTypeIds[Index] % OperandSlotCount] = static_cast<uint8_t>(Index + 1);
+    return Slots;
+}();
+
+// Index into OperandTypeIds, or OperandTypeCount for anything else
+constexpr size_t OperandIndexOf(const DataTypeId Id) noexcept
 {
-    Variant result;
-    bool found = false;
+    const size_t Slot = OperandSlots[Id % OperandSlotCount];
+    return Slot != 0 && OperandTypeIds[Slot - 1] == Id ? Slot - 1 : OperandTypeCount;
+}
 
-    // C++20 Templated Lambda to iterate over all types in the variant
-    [&]<typename... Ts>(std::variant<Ts...>&) {
-        found = ((ty == TypeName<Ts> ? (result = reinterpret_cast<const Ts&>(data), true) : false) || ...);
-    }(result);
+template <typename Fn>
+void VisitNumericAt(const size_t Index, Fn&& Callback)
+{
+    [&]<size_t... Is>(std::index_sequence<Is...>) {
+        ((Is == Index ? (Callback.template operator()<NumericAt<Is>>(), true) : false) || ...);
+    }(std::make_index_sequence<NumericTypeCount> { });
+}
 
-    if (!found)
-        throw std::invalid_argument(std::format("Unsupported type: {}", ty));
-    return result;
+// Operands arrive as the raw bits of the pin's inline storage, the result is written back the same way
+using MathKernel = SDataType (*)(double Lhs, double Rhs, double* Output);
+
+template <EMathOperation Op, size_t LhsIndex, size_t RhsIndex>
+SDataType MathKernelFor(const double Lhs, const double Rhs, double* Output)
+{
+    using T1 = NumericAt<LhsIndex>;
+    using T2 = NumericAt<RhsIndex>;
+    using ResultType = PromotedType<T1, T2>;
+
+    const auto c1 = static_cast<ResultType>(reinterpret_cast<const T1&>(Lhs));
+    const auto c2 = static_cast<ResultType>(reinterpret_cast<const T2&>(Rhs));
+    ResultType result { };
+
+    if constexpr (Op == EMathOperation::Add) {
+        result = c1 + c2;
+    } else if constexpr (Op == EMathOperation::Subtract) {
+        result = c1 - c2;
+    } else if constexpr (Op == EMathOperation::Multiply) {
+        result = c1 * c2;
+    } else {
+        if constexpr (std::is_integral_v<ResultType>) {
+            if (c2 == 0)
+                return VoidDataType;
+        }
+        result = c1 / c2;
+    }
+
+    *Output = 0;
+    reinterpret_cast<ResultType&>(*Output) = result;
+    return TypeOf<ResultType>;
+}
+
+// Flat [op][lhs][rhs] table, one arithmetic evaluation is a single indirect call
+constexpr auto MathDispatch = []<size_t... Is>(std::index_sequence<Is...>) {
+    constexpr auto Square = NumericTypeCount * NumericTypeCount;
+    return std::array<MathKernel, sizeof...(Is)> {
+        &MathKernelFor<static_cast<EMathOperation>(Is / Square), Is % Square / NumericTypeCount, Is % NumericTypeCount>...
+    };
+}(std::make_index_sequence<MathOperationCount * NumericTypeCount * NumericTypeCount> { });
+
+// A scalar pin reads as a single element, which the kernels broadcast
+template <typename Ty>
+std::span<const Ty> ElementsOf(const CDataPin& Pin, Ty& Scalar) noexcept
+{
+    if (Pin.GetValueType().Id == TypeOf<std::vector<Ty>>.Id) {
+        const auto* Values = Pin.TryGet<std::vector<Ty>>(TypeOf<std::vector<Ty>>);
+        return Values != nullptr ? std::span<const Ty> { *Values } : std::span<const Ty> { };
+    }
+
+    Scalar = Pin.TryGetTrivial<Ty>(TypeOf<Ty>);
+    return { &Scalar, 1 };
 }
 
+// Element-wise path, taken when either operand is a vector<>
+using VectorMathKernel = SDataType (*)(const CDataPin& Lhs, const CDataPin& Rhs, CDataPin& Output);
+
+template <EMathOperation Op, size_t LhsIndex, size_t RhsIndex>
+SDataType VectorMathKernelFor(const CDataPin& Lhs, const CDataPin& Rhs, CDataPin& Output)
+{
+    using T1 = NumericAt<LhsIndex>;
+    using T2 = NumericAt<RhsIndex>;
+    using ResultType = PromotedType<T1, T2>;
+
+    T1 LhsScalar { };
+    T2 RhsScalar { };
+    const auto LhsElements = ElementsOf(Lhs, LhsScalar);
+    const auto RhsElements = ElementsOf(Rhs, RhsScalar);
+
+    size_t Count = LhsElements.size();
+    if (LhsElements.size() == 1)
+        Count = RhsElements.size();
+    else if (RhsElements.size() != 1 && RhsElements.size() != Count)
+        return VoidDataType;
+
+    if constexpr (Op == EMathOperation::Divide && std::is_integral_v<ResultType>) {
+        if (std::ranges::any_of(RhsElements, [](const T2 Value) { return static_cast<ResultType>(Value) == 0; }))
+            return VoidDataType;
+    }
+
+    /// Mismatched operands are promoted while the kernel reads them, never copied up front
+    auto Result = std::make_shared<std::vector<ResultType>>(Count);
+    SimdMath::ElementWise<Op, ResultType>(LhsElements, RhsElements, *Result);
+    Output.Set(TypeOf<std::vector<ResultType>>, std::move(Result));
+    return TypeOf<std::vector<ResultType>>;
+}
+
+constexpr auto VectorMathDispatch = []<size_t... Is>(std::index_sequence<Is...>) {
+    constexpr auto Square = NumericTypeCount * NumericTypeCount;
+    return std::array<VectorMathKernel, sizeof...(Is)> {
+        &VectorMathKernelFor<static_cast<EMathOperation>(Is / Square), Is % Square / NumericTypeCount, Is % NumericTypeCount>...
+    };
+}(std::make_index_sequence<MathOperationCount * NumericTypeCount * NumericTypeCount> { });
+
 template <typename Variant>
-void FromStringImpl(const std::string_view& Type, const std::string_view& Value, double& Data)
+void FromStringImpl(const SDataType& Type, const std::string_view& Value, double& Data)
 {
     bool found = false;
     Variant dummy;
 
     [&]<typename... Ts>(std::variant<Ts...>&) {
-        found = ((Type == TypeName<Ts> ? ([&]() {
+        found = ((Type.Id == TypeOf<Ts>.Id ? ([&]() {
             Ts temp_val { };
 
             // Parse the string_view directly into the temporary typed variable
@@ -129,7 +287,7 @@ void FromStringImpl(const std::string_view& Type, const std::string_view& Value,
 
             // Check for parsing errors
             if (ec != std::errc()) {
-                throw std::invalid_argument(std::format("Failed to parse '{}' as {}", Value, Type));
+                throw std::invalid_argument(std::format("Failed to parse '{}' as {}", Value, Type.Name));
             }
 
             // Cast the void* to the correct type pointer and write the value
@@ -137,18 +295,18 @@ void FromStringImpl(const std::string_view& Type, const std::string_view& Value,
     }(dummy);
 
     if (!found) {
-        throw std::invalid_argument(std::format("Unsupported type: {}", Type));
+        throw std::invalid_argument(std::format("Unsupported type: {}", Type.Name));
     }
 }
 
-void FromString(const std::string_view& Type, const std::string_view& Value, double& Data)
+void FromString(const SDataType& Type, const std::string_view& Value, double& Data)
 {
     FromStringImpl<NumericVariant>(Type, Value, Data);
 }
 
 // Convert void* to string using Fold Expressions and std::format
 template <typename Variant>
-std::string ToStringImpl(const std::string_view& ty, const double data)
+std::string ToStringImpl(const SDataType& ty, const double data)
 {
     std::string result;
     bool found = false;
@@ -156,20 +314,63 @@ std::string ToStringImpl(const std::string_view& ty, const double data)
 
     [&]<typename... Ts>(std::variant<Ts...>&) {
         // Unary '+' ensures int8_t/uint8_t format as numbers, not ASCII chars
-        found = ((ty == TypeName<Ts> ? (result = std::format("{}", +reinterpret_cast<const Ts&>(data)), true) : false) || ...);
+        found = ((ty.Id == TypeOf<Ts>.Id ? (result = std::format("{}", +reinterpret_cast<const Ts&>(data)), true) : false) || ...);
     }(dummy);
 
     if (!found)
-        throw std::invalid_argument(std::format("Unsupported type: {}", ty));
+        throw std::invalid_argument(std::format("Unsupported type: {}", ty.Name));
     return result;
 }
 
 // Public ToString wrapper
-std::string ToString(std::string_view Ty, const double Data)
+std::string ToString(const SDataType& Ty, const double Data)
 {
     return ToStringImpl<NumericVariant>(Ty, Data);
 }
 
+// Vector pins print and parse as comma separated lists
+std::string ToString(const CDataPin& Pin)
+{
+    const auto Index = OperandIndexOf(Pin.GetValueType().Id);
+    if (Index < NumericTypeCount || Index == OperandTypeCount)
+        return ToString(Pin.GetValueType(), Pin.AsDouble());
+
+    std::string Result;
+    VisitNumericAt(Index - NumericTypeCount, [&]<typename Ty>() {
+        Ty Scalar;
+        for (const auto& Value : ElementsOf(Pin, Scalar))
+            Result += std::format("{}{}", Result.empty() ? "" : ", ", +Value);
+    });
+    return Result;
+}
+
+void FromString(const SDataType& Type, const std::string_view& Value, CDataPin& Output)
+{
+    const auto Index = OperandIndexOf(Type.Id);
+    if (Index < NumericTypeCount || Index == OperandTypeCount) {
+        double TrivialResult = 0;
+        FromString(Type, Value, TrivialResult);
+        Output.Set(Type, TrivialResult);
+        return;
+    }
+
+    VisitNumericAt(Index - NumericTypeCount, [&]<typename Ty>() {
+        auto Values = std::make_shared<std::vector<Ty>>();
+        for (const auto Token : std::views::split(Value, ',')) {
+            std::string_view Element { Token.begin(), Token.end() };
+            Element.remove_prefix(std::min(Element.find_first_not_of(' '), Element.size()));
+            Element.remove_suffix(Element.size() - std::min(Element.find_last_not_of(' ') + 1, Element.size()));
+            if (Element.empty())
+                continue;
+
+            double TrivialResult = 0;
+            FromString(TypeOf<Ty>, Element, TrivialResult);
+            Values->push_back(reinterpret_cast<const Ty&>(TrivialResult));
+        }
+        Output.Set(Type, std::move(Values));
+    });
+}
+
 class CEntranceNode : public CExecuteNode {
 public:
     CEntranceNode()
@@ -183,6 +384,7 @@ public:
     COnTriggerNode()
     {
         ErasePin(GetInputPins()[0].get());
+        m_FlowPriority = EFlowPriority::Interactive;
     }
 
     std::string GetTitle() override
@@ -221,10 +423,10 @@ public:
 
         if (m_KeyCode == InputEvent.keyCode) {
             if (m_Manager != nullptr) {
-                if (m_Manager->StartExecuteAsync(this)) {
-                    spdlog::info("[OnTrigger] Trigger accepted, async execution started");
+                if (const auto Flow = m_Manager->StartExecuteAsync(this); Flow != InvalidFlowId) {
+                    spdlog::info("[OnTrigger] Trigger accepted, flow {} queued", Flow);
                 } else {
-                    spdlog::info("[OnTrigger] Trigger ignored: execution already in flight");
+                    spdlog::info("[OnTrigger] Trigger ignored: flow from this trigger already in flight");
                 }
             }
         }
@@ -278,6 +480,8 @@ class CToStringNode : public CBaseNode {
 public:
     CToStringNode()
     {
+        m_IsPure = true;
+
         EmplacePin<CDataPin>(true)->SetIsUniversalPin();
         EmplacePin<CDataPin>(false)->SetValueType("string");
     }
@@ -294,7 +498,7 @@ protected:
             return false;
 
         const auto& Value = reinterpret_cast<const CDataPin&>(*GetInputPins()[0]);
-        reinterpret_cast<CDataPin&>(*GetOutputPins()[0]).Set("string", std::make_shared<std::string>(ToString(Value.GetValueType(), Value.AsDouble())));
+        reinterpret_cast<CDataPin&>(*GetOutputPins()[0]).Set(MakeDataType("string"), std::make_shared<std::string>(ToString(Value)));
 
         return true;
     }
@@ -318,7 +522,8 @@ protected:
         CExecuteNode::Execute();
 
         const auto& Value = reinterpret_cast<const CDataPin&>(*GetInputPins()[1]);
-        spdlog::info("{}", Value.Get<std::string>("string"));
+        if (const auto* Text = Value.TryGet<std::string>(MakeDataType("string")))
+            spdlog::info("{}", *Text);
     }
 };
 
@@ -344,12 +549,20 @@ protected:
             if (auto DataPin = GetInputPinsWith<EPinType::Data>();
                 !DataPin.empty() && !static_cast<CDataPin*>(DataPin.front().get())->PinGetTrivial(bool))
 
-                m_DesiredOutputPin = 1;
+                SetDesiredOutputPin(1);
         }
     }
 };
 
-class CSequenceNode : public CExecuteNode, public INodeImGuiPupUpExt {
+enum class ESequenceMode : uint8_t {
+    Sequential,
+    /// Run all branches concurrently and join
+    Parallel,
+    /// Continue once the first branch finishes, the rest are cancelled and not waited for
+    Race
+};
+
+class CSequenceNode : public CExecuteNode, public INodeImGuiPupUpExt, public INodeInnerText {
 public:
     std::string GetTitle() override
     {
@@ -371,6 +584,10 @@ public:
             }
         }
 
+        constexpr const char* ModeNames[] = { "Sequential", "Parallel", "Race" };
+        if (int Mode = static_cast<int>(m_Mode); ImGui::Combo("Mode", &Mode, ModeNames, std::size(ModeNames)))
+            SetMode(static_cast<ESequenceMode>(Mode));
+
         return true;
     }
 
@@ -379,117 +596,713 @@ public:
         return "Flow";
     }
 
-    CExecuteNode* ExecuteNode() override
+    /// Only parallel and race wait for their branches, sequential ones never pay for a coroutine frame
+    friend void DeduceNodeTraits(CSequenceNode* Node) noexcept
+    {
+        Node->DeduceFlowTraits<CSequenceNode>();
+        Node->SetMode(Node->m_Mode);
+    }
+
+    void Execute() override
     {
-        if (m_Manager == nullptr) [[unlikely]]
-            return nullptr;
+        /// The manager keeps our place between branches, nested sequences never grow the native stack
+        CallBranchFrom(0);
+    }
 
+    CFlowTask ExecuteAsync() override
+    {
+        std::vector<CExecuteNode*> Branches;
         for (const auto* Pin : GetFlowOutputPins())
-            if (*Pin) {
-                auto* Node = Pin->GetTheOnlyConnected()->GetOwner()->As<CExecuteNode>();
-                m_Manager->Execute(Node);
-            }
+            if (*Pin)
+                Branches.emplace_back(Pin->GetTheOnlyConnected()->GetOwner()->As<CExecuteNode>());
+
+        /// Also reached when the mode changed after the flow decided to run us suspendable
+        if (m_Mode == ESequenceMode::Sequential || Branches.size() < 2 || m_Manager == nullptr) {
+            CallBranchFrom(0);
+            co_return;
+        }
+
+        /// Branches are flows of their own on the flow workers, we park until they join.
+        /// They share one source so the race winner can cancel its siblings
+        const auto& Step = GetStep();
+        std::stop_source BranchStop;
+        const bool IsRace = m_Mode == ESequenceMode::Race;
+
+        const auto Joined = std::make_shared<CFlowEvent>();
+        const auto Remaining = std::make_shared<std::atomic<size_t>>(Branches.size());
+        const auto OnBranchEnd = [Joined, Remaining, IsRace] {
+            if (IsRace || Remaining->fetch_sub(1, std::memory_order_acq_rel) == 1)
+                Joined->Set();
+        };
+
+        for (auto* Node : Branches)
+            if (m_Manager->StartBranchAsync(Node, BranchStop.get_token(), Step.Flow, OnBranchEnd) == InvalidFlowId)
+                OnBranchEnd();
 
-        return nullptr;
+        co_await WaitFor(Joined);
+
+        /// Losers of a race, or every branch once our own flow got stopped, wind down in the background
+        BranchStop.request_stop();
+        SetDesiredOutputPin(NoPin);
     }
 
     void WriteExtraContext(std::string& ExtContext) const override
     {
         assert(GetFlowOutputPins().size() < std::numeric_limits<uint8_t>::max());
-        if (GetFlowOutputPins().size() > 1)
+        if (GetFlowOutputPins().size() > 1 || m_Mode != ESequenceMode::Sequential)
             ExtContext.push_back(static_cast<uint8_t>(GetFlowOutputPins().size()));
+        if (m_Mode != ESequenceMode::Sequential)
+            ExtContext.push_back(static_cast<uint8_t>(m_Mode));
     }
 
     void ReadExtraContext(const std::string& ExtContext) override
     {
-        if (ExtContext.size() == 1) {
+        if (!ExtContext.empty()) {
             for (int i = static_cast<uint8_t>(ExtContext[0]); i > 1; --i) {
                 EmplacePin<CFlowPin>(false);
             }
         }
+
+        if (ExtContext.size() >= 2 && static_cast<uint8_t>(ExtContext[1]) <= static_cast<uint8_t>(ESequenceMode::Race))
+            SetMode(static_cast<ESequenceMode>(ExtContext[1]));
+    }
+
+protected:
+    void OnSubFlowEnd(const uint64_t State) override
+    {
+        CallBranchFrom(State + 1);
+    }
+
+    /// Sub-flow into the first connected branch from Pin on, the flow ends here once there is none
+    void CallBranchFrom(size_t Pin) noexcept
+    {
+        SetDesiredOutputPin(NoPin);
+        for (; Pin < GetFlowOutputPins().size(); ++Pin) {
+            if (*GetFlowOutputPins()[Pin]) {
+                CallSubFlow(Pin, Pin);
+                return;
+            }
+        }
+    }
+
+    void SetMode(const ESequenceMode Mode)
+    {
+        m_Mode = Mode;
+        m_IsSuspendable = Mode != ESequenceMode::Sequential;
+        SetInnerText(Mode == ESequenceMode::Parallel ? "Parallel" : Mode == ESequenceMode::Race ? "Race" : "");
     }
+
+    ESequenceMode m_Mode = ESequenceMode::Sequential;
 };
 
-class CMathCommonNode : public CBaseNode {
+// Loop bodies are sub-flows of the loop node, each iteration returns to it through the manager's frame stack
+class CForLoopNode : public CExecuteNode {
 public:
+    CForLoopNode()
+    {
+        EmplacePin<CDataPin>(true)->SetValueType("int32_t").SetToolTips("First");
+        EmplacePin<CDataPin>(true)->SetValueType("int32_t").SetToolTips("Last");
+        EmplacePin<CFlowPin>(false)->SetToolTips("Completed");
+        EmplacePin<CDataPin>(false)->SetValueType("int32_t").SetToolTips("Index");
+    }
+
     std::string_view GetCategory() noexcept override
     {
-        return "Numeric";
+        return "Flow";
     }
 
-    CMathCommonNode()
+protected:
+    void Execute() override
     {
-        EmplacePin<CDataPin>(true)->SetIsUniversalPin();
-        EmplacePin<CDataPin>(false);
+        CExecuteNode::Execute();
+        Iterate(static_cast<const CDataPin&>(*GetInputPins()[1]).PinGetTrivial(int32_t));
+    }
+
+    /// Last is pulled again every iteration, the body may move it
+    void OnSubFlowEnd(const uint64_t State) override
+    {
+        CExecuteNode::Execute();
+        Iterate(static_cast<int64_t>(State) + 1);
+    }
+
+    void Iterate(const int64_t Index)
+    {
+        if (Index > static_cast<const CDataPin&>(*GetInputPins()[2]).PinGetTrivial(int32_t)) {
+            SetDesiredOutputPin(1);
+            return;
+        }
+
+        static_cast<CDataPin&>(*GetOutputPins()[2]).PinSet(int32_t, static_cast<int32_t>(Index));
+        CallSubFlow(0, static_cast<uint64_t>(Index));
+    }
+};
+
+class CWhileLoopNode : public CExecuteNode {
+public:
+    CWhileLoopNode()
+    {
+        EmplacePin<CDataPin>(true)->SetValueType("bool").SetToolTips("bCondition");
+        EmplacePin<CFlowPin>(false)->SetToolTips("Completed");
+    }
+
+    std::string_view GetCategory() noexcept override
+    {
+        return "Flow";
     }
 
 protected:
-    std::string_view Operate(EMathOperation op, const std::string_view& Ty1, const std::string_view& Ty2, const double Data1, const double Data2, void* DataOutput)
+    void Execute() override
     {
-        auto val1 = ParseData<NumericVariant>(Ty1, Data1);
-        auto val2 = ParseData<NumericVariant>(Ty2, Data2);
+        CExecuteNode::Execute();
+        Iterate();
+    }
 
-        return std::visit([op, DataOutput](auto v1, auto v2) -> std::string_view {
-            using T1 = decltype(v1);
-            using T2 = decltype(v2);
-            using ResultType = PromotedType<T1, T2>;
+    void OnSubFlowEnd(uint64_t) override
+    {
+        Execute();
+    }
 
-            ResultType c1 = static_cast<ResultType>(v1);
-            ResultType c2 = static_cast<ResultType>(v2);
-            ResultType result { };
+    void Iterate()
+    {
+        if (static_cast<const CDataPin&>(*GetInputPins()[1]).PinGetTrivial(bool))
+            CallSubFlow(0);
+        else
+            SetDesiredOutputPin(1);
+    }
+};
 
-            switch (op) {
-            case EMathOperation::Add:
-                result = c1 + c2;
-                break;
-            case EMathOperation::Subtract:
-                result = c1 - c2;
-                break;
-            case EMathOperation::Multiply:
-                result = c1 * c2;
-                break;
-            case EMathOperation::Divide:
-                if constexpr (std::is_integral_v<ResultType>) {
-                    if (c2 == 0)
-                        throw std::runtime_error("Integer division by zero!");
+class CForEachLoopNode : public CExecuteNode {
+public:
+    CForEachLoopNode()
+    {
+        EmplacePin<CDataPin>(true)->SetIsUniversalPin().SetToolTips("Array");
+        EmplacePin<CFlowPin>(false)->SetToolTips("Completed");
+        EmplacePin<CDataPin>(false)->SetIsUniversalPin().SetToolTips("Element");
+        EmplacePin<CDataPin>(false)->SetValueType("int32_t").SetToolTips("Index");
+    }
+
+    std::string_view GetCategory() noexcept override
+    {
+        return "Flow";
+    }
+
+protected:
+    void Execute() override
+    {
+        CExecuteNode::Execute();
+        Iterate(0);
+    }
+
+    /// The array is pulled again every iteration, a shrinking array ends the loop early
+    void OnSubFlowEnd(const uint64_t State) override
+    {
+        CExecuteNode::Execute();
+        Iterate(State + 1);
+    }
+
+    void Iterate(const uint64_t Index)
+    {
+        if (!SetElement(Index)) {
+            SetDesiredOutputPin(1);
+            return;
+        }
+
+        static_cast<CDataPin&>(*GetOutputPins()[3]).PinSet(int32_t, static_cast<int32_t>(Index));
+        CallSubFlow(0, Index);
+    }
+
+    /// False past the end or for anything but a numeric vector
+    bool SetElement(const uint64_t Index)
+    {
+        const auto& Array = static_cast<const CDataPin&>(*GetInputPins()[1]);
+        const auto Operand = OperandIndexOf(Array.GetValueType().Id);
+        if (Operand < NumericTypeCount || Operand >= OperandTypeCount)
+            return false;
+
+        bool IsSet = false;
+        VisitNumericAt(Operand - NumericTypeCount, [&]<typename Ty>() {
+            if (const auto* Values = Array.TryGet<std::vector<Ty>>(TypeOf<std::vector<Ty>>); Values != nullptr && Index < Values->size()) {
+                static_cast<CDataPin&>(*GetOutputPins()[2]).Set(TypeOf<Ty>, static_cast<Ty>((*Values)[Index]));
+                IsSet = true;
+            }
+        });
+
+        return IsSet;
+    }
+};
+
+// The body is the data subgraph between our Element/Index outputs and the Result input, copies of it run on the worker pool
+class CMapNode : public CExecuteNode, public INodeImGuiPupUpExt, public INodeInnerText {
+public:
+    CMapNode()
+    {
+        /// Keeps the execution plan from pulling the body through the Result input
+        m_HasCustomFlow = true;
+
+        EmplacePin<CDataPin>(true)->SetIsUniversalPin().SetToolTips("Array");
+        EmplacePin<CDataPin>(true)->SetIsUniversalPin().SetToolTips("Result");
+        EmplacePin<CDataPin>(false)->SetIsUniversalPin().SetToolTips("Element");
+        EmplacePin<CDataPin>(false)->SetValueType("int32_t").SetToolTips("Index");
+        EmplacePin<CDataPin>(false)->SetIsUniversalPin().SetToolTips("Results");
+    }
+
+    std::string_view GetCategory() noexcept override
+    {
+        return "Flow";
+    }
+
+    std::string GetTitle() override
+    {
+        return "Map";
+    }
+
+    bool Render() override
+    {
+        ImGui::InputInt("Max parallel (0 for all workers)", &m_MaxParallel);
+        m_MaxParallel = std::max(m_MaxParallel, 0);
+        ImGui::Checkbox("Keep order", &m_IsOrdered);
+
+        return true;
+    }
+
+    void OnEndPopup() override
+    {
+        SetInnerText(m_IsOrdered ? "" : "Unordered");
+    }
+
+    void WriteExtraContext(std::string& ExtContext) const override
+    {
+        if (m_MaxParallel != 0 || !m_IsOrdered)
+            ExtContext = std::format("{} {}", m_MaxParallel, m_IsOrdered ? 1 : 0);
+    }
+    void ReadExtraContext(const std::string& ExtContext) override
+    {
+        int Ordered = 1;
+        if (std::sscanf(ExtContext.c_str(), "%d %d", &m_MaxParallel, &Ordered) == 2)
+            m_IsOrdered = Ordered != 0;
+        OnEndPopup();
+    }
+
+protected:
+    /// One copy of the body, evaluated for one element at a time
+    struct SLane {
+        std::vector<std::unique_ptr<CBaseNode, DestroyFunc>> Nodes;
+        std::vector<CDataPin*> ElementTargets;
+        std::vector<CDataPin*> IndexTargets;
+        /// Owners of the targets, the rest of the body is invalidated through them
+        std::vector<CBaseNode*> Readers;
+        /// Inputs fed from outside the body take over the original source's value once per execution
+        std::vector<std::pair<CDataPin*, const CDataPin*>> Snapshots;
+        /// Unconnected inputs and the original they were copied from
+        std::vector<std::pair<CDataPin*, const CDataPin*>> Constants;
+        CBaseNode* ResultNode = nullptr;
+        const CDataPin* Result = nullptr;
+
+        void Evaluate(const size_t Index, const uint64_t Epoch, const auto& Feed)
+        {
+            for (auto* Target : ElementTargets)
+                Feed(Index, *Target);
+            for (auto* Target : IndexTargets)
+                Target->PinSet(int32_t, static_cast<int32_t>(Index));
+            for (auto* Reader : Readers)
+                Reader->MarkDirty();
+
+            /// Only what depends on the element forgot the epoch, everything else is skipped
+            ResultNode->Refresh(Epoch);
+        }
+    };
+
+    void Execute() override
+    {
+        const auto Epoch = GetStep().Epoch;
+
+        /// Only the array is pulled up front, the body is evaluated per element
+        auto& Array = static_cast<CDataPin&>(*GetInputPins()[1]);
+        if (Array) {
+            if (auto* Source = Array.GetTheOnlyConnected()->GetOwner(); *Source == ENodeType::Data)
+                Source->Refresh(Epoch);
+            Array.Assign(Array.GetTheOnlyConnected()->As<CDataPin>());
+        }
+
+        std::function<void(size_t, CDataPin&)> Feed;
+        size_t Count = 0;
+        if (const auto Operand = OperandIndexOf(Array.GetValueType().Id); Operand >= NumericTypeCount && Operand < OperandTypeCount) {
+            VisitNumericAt(Operand - NumericTypeCount, [&]<typename Ty>() {
+                if (const auto* Values = Array.TryGet<std::vector<Ty>>(TypeOf<std::vector<Ty>>)) {
+                    Count = Values->size();
+                    Feed = [Values](const size_t Index, CDataPin& Pin) { Pin.Set(TypeOf<Ty>, (*Values)[Index]); };
                 }
-                result = c1 / c2;
+            });
+        } else if (const auto* Traits = CTypeRegistry::Get().FindCollection(Array.GetValueType().Id)) {
+            /// Strings, images and whatever else a plugin registered, elements are shared rather than copied
+            if (auto Collection = Array.GetShared()) {
+                Count = Traits->Size(Collection.get());
+                Feed = [Traits, Collection = std::move(Collection)](const size_t Index, CDataPin& Pin) { Pin.SetShared(Traits->ElementType, Traits->At(Collection, Index)); };
+            }
+        }
+
+        auto& Results = static_cast<CDataPin&>(*GetOutputPins()[3]);
+        if (Count == 0 || !PrepareBody(Epoch)) {
+            Results.Set(TypeOf<std::vector<double>>, std::make_shared<std::vector<double>>());
+            return;
+        }
+
+        /// Without a body every element gives the same result, the board's result node is refreshed like any other input
+        const auto* ResultSource = GetInputPins()[2]->GetTheOnlyConnected()->As<CDataPin>();
+        if (auto* ResultNode = ResultSource->GetOwner(); !std::ranges::contains(m_Body, ResultNode)) {
+            ResultNode->Refresh(Epoch);
+            Gather(Count, *ResultSource, [&](const auto& Store) {
+                for (size_t Index = 1; Index < Count; ++Index)
+                    Store(Index, *ResultSource);
+            }, Results);
+            return;
+        }
+
+        /// Every element runs on a copy of the body, the board's own nodes are left to other flows
+        if (!EnsureLanes(1)) {
+            Results.Set(TypeOf<std::vector<double>>, std::make_shared<std::vector<double>>());
+            return;
+        }
+
+        /// The first element runs on this thread, which also tells the result type
+        auto& FirstLane = *m_Lanes.front();
+        FirstLane.Evaluate(0, Epoch, Feed);
+        Gather(Count, *FirstLane.Result, [&](const auto& Store) { RunLanes(Count, Feed, Store); }, Results);
+    }
+
+    /// First holds element 0's result, RunRest hands every other element's result to the store it is given
+    void Gather(const size_t Count, const CDataPin& First, const auto& RunRest, CDataPin& Results)
+    {
+        const auto Operand = OperandIndexOf(First.GetValueType().Id);
+        if (Operand < NumericTypeCount) {
+            VisitNumericAt(Operand, [&]<typename Ty>() {
+                auto Gathered = std::make_shared<std::vector<Ty>>(Count);
+                (*Gathered)[0] = First.TryGetTrivial<Ty>(TypeOf<Ty>);
+
+                std::atomic<size_t> NextSlot { 1 };
+                RunRest([&](const size_t Index, const CDataPin& Result) {
+                    (*Gathered)[m_IsOrdered ? Index : NextSlot.fetch_add(1, std::memory_order_relaxed)] = Result.TryGetTrivial<Ty>(TypeOf<Ty>);
+                });
+
+                Results.Set(TypeOf<std::vector<Ty>>, std::move(Gathered));
+            });
+            return;
+        }
+
+        /// Results of a registered collection's element type, kept alive by reference until all lanes are done
+        const auto* Traits = CTypeRegistry::Get().FindCollectionOf(First.GetValueType().Id);
+        if (Traits == nullptr) {
+            spdlog::warn("Map has no collection to gather {} into", First.GetValueType().Name);
+            Results.Set(TypeOf<std::vector<double>>, std::make_shared<std::vector<double>>());
+            return;
+        }
+
+        std::vector<std::shared_ptr<void>> Gathered(Count);
+        Gathered[0] = First.GetShared();
+
+        std::atomic<size_t> NextSlot { 1 };
+        RunRest([&](const size_t Index, const CDataPin& Result) {
+            Gathered[m_IsOrdered ? Index : NextSlot.fetch_add(1, std::memory_order_relaxed)] = Result.GetShared();
+        });
+
+        Results.SetShared(Traits->CollectionType, Traits->Gather(Gathered));
+    }
+
+    /// Elements from 1 on, pulled from a shared counter so a slow element never holds up a lane's queue.
+    /// The first lane stays on this thread, the others go to the pool
+    void RunLanes(const size_t Count, const auto& Feed, const auto& Store)
+    {
+        /// Lanes on the pool run within our step, they only read it
+        auto& Step = GetStep();
+
+        std::atomic<size_t> NextIndex { 1 };
+        const auto Run = [&](SLane& Lane) {
+            for (size_t Index; !IsStopRequested() && (Index = NextIndex.fetch_add(1, std::memory_order_relaxed)) < Count;) {
+                Lane.Evaluate(Index, Step.Epoch, Feed);
+                Store(Index, *Lane.Result);
+            }
+        };
+
+        auto* Pool = m_Manager != nullptr ? m_Manager->GetWorkerPool() : nullptr;
+        const size_t MaxLanes = m_MaxParallel > 0 ? m_MaxParallel : Pool != nullptr ? Pool->GetWorkerCount() + 1 : 1;
+        const size_t LaneCount = std::min(Count - 1, MaxLanes);
+
+        if (Pool == nullptr || LaneCount < 2 || !m_IsBodyThreadSafe || !EnsureLanes(LaneCount)) {
+            Run(*m_Lanes.front());
+            return;
+        }
+
+        CWorkStealingPool::CTaskGroup Group { *Pool };
+        for (auto& Lane : m_Lanes | std::views::drop(1) | std::views::take(LaneCount - 1))
+            Group.Run([&Run, &Lane, &Step] {
+                const CStepScope Scope { Step };
+                Run(*Lane);
+            });
+        Run(*m_Lanes.front());
+        Group.Wait();
+    }
+
+    /// Find the body and bring the copies up to date, false if Result is not fed by a data node
+    bool PrepareBody(const uint64_t Epoch)
+    {
+        const auto& ResultPin = *GetInputPins()[2];
+        if (!ResultPin || *ResultPin.GetTheOnlyConnected()->GetOwner() != ENodeType::Data)
+            return false;
+
+        const auto Revision = m_Manager != nullptr ? m_Manager->GetGraphRevision() : 0;
+        std::vector<std::string> BodyExt;
+        if (Revision == m_BodyRevision && !m_Body.empty()) {
+            for (const auto* Node : m_Body)
+                Node->WriteExtraContext(BodyExt.emplace_back());
+        }
+
+        if (Revision != m_BodyRevision || m_Body.empty() || BodyExt != m_BodyExt) {
+            CollectBody();
+            m_BodyRevision = Revision;
+            m_BodyExt.clear();
+            for (const auto* Node : m_Body)
+                Node->WriteExtraContext(m_BodyExt.emplace_back());
+            m_Lanes.clear();
+        }
+
+        /// Whatever the body reads from outside is current before any lane starts
+        for (const auto* Node : m_Body) {
+            for (const auto& IPin : Node->GetInputPins()) {
+                if (*IPin != EPinType::Data || !*IPin)
+                    continue;
+                if (auto* Source = IPin->GetTheOnlyConnected()->GetOwner(); *Source == ENodeType::Data && !std::ranges::contains(m_Body, Source))
+                    Source->Refresh(Epoch);
+            }
+        }
+
+        for (const auto& Lane : m_Lanes)
+            SyncLane(*Lane);
+
+        return true;
+    }
+
+    /// Data nodes upstream of Result that depend on Element or Index, in topological order
+    void CollectBody()
+    {
+        auto* ResultSource = GetInputPins()[2]->GetTheOnlyConnected();
+
+        std::vector<CBaseNode*> Closure;
+        std::unordered_set<const CBaseNode*> Visited;
+        std::vector<CBaseNode*> Stack { ResultSource->GetOwner() };
+        while (!Stack.empty()) {
+            auto* Node = Stack.back();
+            Stack.pop_back();
+            if (!Visited.insert(Node).second)
+                continue;
+
+            Closure.push_back(Node);
+            for (const auto& IPin : Node->GetInputPins())
+                if (*IPin == EPinType::Data && *IPin && *IPin->GetTheOnlyConnected()->GetOwner() == ENodeType::Data)
+                    Stack.push_back(IPin->GetTheOnlyConnected()->GetOwner());
+        }
+
+        std::ranges::sort(Closure, { }, &CBaseNode::GetTopologicalOrder);
+
+        m_Body.clear();
+        m_IsBodyThreadSafe = true;
+        m_IsBodyCopyable = true;
+        for (auto* Node : Closure) {
+            const bool IsInBody = std::ranges::any_of(Node->GetInputPins(), [this](const auto& IPin) {
+                if (*IPin != EPinType::Data || !*IPin)
+                    return false;
+                const auto* Source = IPin->GetTheOnlyConnected()->GetOwner();
+                return Source == this || std::ranges::contains(m_Body, Source);
+            });
+
+            if (IsInBody) {
+                m_Body.push_back(Node);
+                m_IsBodyThreadSafe &= Node->IsThreadSafe();
+            }
+        }
+    }
+
+    bool EnsureLanes(const size_t Count)
+    {
+        while (m_IsBodyCopyable && m_Lanes.size() < Count) {
+            auto Lane = MakeLane();
+            if (Lane == nullptr) {
+                /// Some body node came without a factory, copies are impossible until the body changes
+                spdlog::warn("Map body can't be copied, a node in it has no factory");
+                m_IsBodyCopyable = false;
                 break;
-            default:
-                std::unreachable(); // C++23
             }
+            SyncLane(*Lane);
+            m_Lanes.emplace_back(std::move(Lane));
+        }
+
+        return m_Lanes.size() >= Count;
+    }
+
+    std::unique_ptr<SLane> MakeLane()
+    {
+        auto Lane = std::make_unique<SLane>();
+
+        std::unordered_map<const CBaseNode*, CBaseNode*> Copies;
+        for (const auto* Node : m_Body) {
+            auto Copy = Node->Duplicate();
+            if (Copy == nullptr)
+                return nullptr;
+            Copies.emplace(Node, Copy.get());
+            Lane->Nodes.emplace_back(std::move(Copy));
+        }
+
+        const auto OutputIndexOf = [](const CPin* Pin) {
+            const auto& Pins = Pin->GetOwner()->GetOutputPins();
+            return std::ranges::find_if(Pins, [Pin](const auto& Output) { return Output.get() == Pin; }) - Pins.begin();
+        };
 
-            if (DataOutput != nullptr) {
-                *static_cast<ResultType*>(DataOutput) = result;
+        for (size_t NodeIndex = 0; NodeIndex < m_Body.size(); ++NodeIndex) {
+            const auto* Original = m_Body[NodeIndex];
+            auto* Copy = Lane->Nodes[NodeIndex].get();
+            if (Copy->GetInputPins().size() != Original->GetInputPins().size())
+                return nullptr;
+
+            bool IsReader = false;
+            for (size_t PinIndex = 0; PinIndex < Original->GetInputPins().size(); ++PinIndex) {
+                const auto& IPin = Original->GetInputPins()[PinIndex];
+                if (*IPin != EPinType::Data)
+                    continue;
+
+                auto* Target = static_cast<CDataPin*>(Copy->GetInputPins()[PinIndex].get());
+                if (!*IPin) {
+                    Lane->Constants.emplace_back(Target, IPin->As<CDataPin>());
+                    continue;
+                }
+
+                const auto* Source = IPin->GetTheOnlyConnected();
+                if (Source->GetOwner() == this) {
+                    (Source == GetOutputPins()[1].get() ? Lane->ElementTargets : Lane->IndexTargets).push_back(Target);
+                    IsReader = true;
+                } else if (const auto It = Copies.find(Source->GetOwner()); It != Copies.end()) {
+                    It->second->GetOutputPins()[OutputIndexOf(Source)]->ConnectPin(Target);
+                } else {
+                    Lane->Snapshots.emplace_back(Target, Source->As<CDataPin>());
+                }
             }
 
-            return TypeName<ResultType>;
-        },
-            val1, val2);
+            if (IsReader)
+                Lane->Readers.push_back(Copy);
+        }
+
+        const auto* ResultSource = GetInputPins()[2]->GetTheOnlyConnected();
+        Lane->ResultNode = Copies.at(ResultSource->GetOwner());
+        Lane->Result = static_cast<const CDataPin*>(Lane->ResultNode->GetOutputPins()[OutputIndexOf(ResultSource)].get());
+        return Lane;
+    }
+
+    /// Copies hold their own pins, take over what changed on the original side since the last execution
+    static void SyncLane(SLane& Lane)
+    {
+        for (const auto& Pairs : { std::cref(Lane.Snapshots), std::cref(Lane.Constants) }) {
+            for (const auto& [Target, Source] : Pairs.get()) {
+                if (Target->HoldsSameValue(*Source))
+                    continue;
+                Target->Assign(Source);
+                Target->GetOwner()->MarkDirty();
+            }
+        }
     }
+
+    int m_MaxParallel = 0;
+    bool m_IsOrdered = true;
+
+    std::vector<CBaseNode*> m_Body;
+    std::vector<std::string> m_BodyExt;
+    uint64_t m_BodyRevision = 0;
+    bool m_IsBodyThreadSafe = false;
+    bool m_IsBodyCopyable = false;
+
+    /// Private copies of the body, the first one is used on the flow's thread
+    std::vector<std::unique_ptr<SLane>> m_Lanes;
 };
 
-class CAddNode : public CMathCommonNode {
+class CMathCommonNode : public CBaseNode {
 public:
-    CAddNode()
+    std::string_view GetCategory() noexcept override
     {
-        EmplacePin<CDataPin>(true)->SetIsUniversalPin();
+        return "Numeric";
+    }
 
-        reinterpret_cast<CDataPin&>(*GetInputPins()[0]).PinSet(float, 321.f);
-        reinterpret_cast<CDataPin&>(*GetInputPins()[1]).PinSet(uint32_t, 123);
+    explicit CMathCommonNode(const EMathOperation Operation)
+        : m_Operation(Operation)
+    {
+        m_IsPure = true;
+
+        EmplacePin<CDataPin>(true)->SetIsUniversalPin();
+        EmplacePin<CDataPin>(true)->SetIsUniversalPin();
+        EmplacePin<CDataPin>(false);
     }
 
     bool Evaluate() noexcept override
     {
-        CMathCommonNode::Evaluate();
+        CBaseNode::Evaluate();
 
         const auto& ValueA = reinterpret_cast<const CDataPin&>(*GetInputPins()[0]);
         const auto& ValueB = reinterpret_cast<const CDataPin&>(*GetInputPins()[1]);
         auto& Result = reinterpret_cast<CDataPin&>(*GetOutputPins()[0]);
 
+        return Operate(m_Operation, ValueA, ValueB, Result) != VoidDataType;
+    }
+
+protected:
+    static SDataType Operate(const EMathOperation Op, const CDataPin& Lhs, const CDataPin& Rhs, CDataPin& Result) noexcept
+    {
+        const auto LhsIndex = OperandIndexOf(Lhs.GetValueType().Id);
+        const auto RhsIndex = OperandIndexOf(Rhs.GetValueType().Id);
+        const auto Entry = (std::to_underlying(Op) * NumericTypeCount + LhsIndex % NumericTypeCount) * NumericTypeCount + RhsIndex % NumericTypeCount;
+
         double TrivialResult = 0;
-        Result.Set(Operate(EMathOperation::Add, ValueA.GetValueType(), ValueB.GetValueType(), ValueA.AsDouble(), ValueB.AsDouble(), &TrivialResult), TrivialResult);
-        return Result.GetValueType() != "void";
+        SDataType ResultType = VoidDataType;
+        if (LhsIndex < NumericTypeCount && RhsIndex < NumericTypeCount) [[likely]] {
+            ResultType = MathDispatch[Entry](Lhs.AsDouble(), Rhs.AsDouble(), &TrivialResult);
+        } else if (LhsIndex != OperandTypeCount && RhsIndex != OperandTypeCount) {
+            if ((ResultType = VectorMathDispatch[Entry](Lhs, Rhs, Result)) != VoidDataType)
+                return ResultType;
+        }
+
+        Result.Set(ResultType, TrivialResult);
+        return ResultType;
+    }
+
+    EMathOperation m_Operation;
+};
+
+class CAddNode : public CMathCommonNode {
+public:
+    CAddNode()
+        : CMathCommonNode(EMathOperation::Add)
+    {
+        reinterpret_cast<CDataPin&>(*GetInputPins()[0]).PinSet(float, 321.f);
+        reinterpret_cast<CDataPin&>(*GetInputPins()[1]).PinSet(uint32_t, 123);
+    }
+};
+
+class CSubtractNode : public CMathCommonNode {
+public:
+    CSubtractNode()
+        : CMathCommonNode(EMathOperation::Subtract)
+    {
+    }
+};
+
+class CMultiplyNode : public CMathCommonNode {
+public:
+    CMultiplyNode()
+        : CMathCommonNode(EMathOperation::Multiply)
+    {
+    }
+};
+
+class CDivideNode : public CMathCommonNode {
+public:
+    CDivideNode()
+        : CMathCommonNode(EMathOperation::Divide)
+    {
     }
 };
 
@@ -513,16 +1326,17 @@ public:
         return true;
     }
 
-    void Execute() override
+    CFlowTask ExecuteAsync() override
     {
         const auto StartTime = std::chrono::steady_clock::now();
-        const auto DelayDuration = std::chrono::duration<float>(m_Delay);
+        const auto DelayDuration = std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<float>(m_Delay));
         const auto EndTime = StartTime + DelayDuration;
+        ExpectWakeAt(EndTime);
 
         // How often the GUI should update
         constexpr auto UpdateInterval = std::chrono::milliseconds(100);
 
-        while (true) {
+        while (!IsStopRequested()) {
             auto Now = std::chrono::steady_clock::now();
 
             if (Now >= EndTime) {
@@ -532,12 +1346,8 @@ public:
             const std::chrono::duration<float> Remaining = EndTime - Now;
             SetInnerText(std::format("{:.1f}", Remaining.count()));
 
-            // If remaining time is less than 100ms, only sleep for the exact remaining time.
-            if (Remaining < UpdateInterval) {
-                std::this_thread::sleep_for(Remaining);
-            } else {
-                std::this_thread::sleep_for(UpdateInterval);
-            }
+            // If remaining time is less than 100ms, only wait for the exact remaining time.
+            co_await SleepUntil(std::min<std::chrono::steady_clock::time_point>(EndTime, Now + UpdateInterval));
         }
 
         SetInnerText(std::format("{:.1f}", m_Delay));
@@ -562,6 +1372,8 @@ class CTrivialValueNode : public CBaseNode, public INodeImGuiPupUpExt, public IN
 public:
     CTrivialValueNode()
     {
+        m_IsPure = true;
+
         EmplacePin<CDataPin>(false)->SetIsUniversalPin().AddOnConnectionChanges([this](auto, auto, auto IsConnect) {
             if (IsConnect)
                 OnStartPopup();
@@ -579,29 +1391,28 @@ public:
 
         const auto* OwnerEnd = static_cast<CDataPin*>(OurPin->GetTheOnlyConnected());
         if (OwnerEnd == nullptr) {
-            OurPin->SetValueType(OtherTy = "void");
+            OurPin->SetValueType(OtherTy = VoidDataType);
             return;
         }
 
         OurPin->SetValueType(OtherTy = OwnerEnd->GetValueType());
-        if (OtherTy != "void") {
-            m_StrBuffer[ToString(OtherTy, OurPin->AsDouble()).copy(m_StrBuffer, sizeof(m_StrBuffer) - 1)] = '\0';
+        if (OtherTy != VoidDataType) {
+            m_StrBuffer[ToString(*OurPin).copy(m_StrBuffer, sizeof(m_StrBuffer) - 1)] = '\0';
         }
     }
 
     void OnEndPopup() override
     {
-        if (OtherTy == "void")
+        if (OtherTy == VoidDataType)
             return;
 
-        double TrivialResult = 0;
-        FromString(OtherTy, std::string_view { m_StrBuffer }, TrivialResult);
-        static_cast<CDataPin*>(GetOutputPins()[0].get())->Set(OtherTy, TrivialResult);
+        FromString(OtherTy, std::string_view { m_StrBuffer }, *static_cast<CDataPin*>(GetOutputPins()[0].get()));
+        MarkDirty();
     }
 
     bool Render() override
     {
-        if (OtherTy == "void") {
+        if (OtherTy == VoidDataType) {
             return false;
         }
 
@@ -617,9 +1428,9 @@ public:
 
     void WriteExtraContext(std::string& ExtContext) const override
     {
-        if (OtherTy == "void")
+        if (OtherTy == VoidDataType)
             return;
-        ExtContext = std::format("{} {}", OtherTy, m_StrBuffer);
+        ExtContext = std::format("{} {}", OtherTy.Name, m_StrBuffer);
     }
     void ReadExtraContext(const std::string& ExtContext) override
     {
@@ -627,13 +1438,13 @@ public:
             return;
 
         const auto SpaceLocation = ExtContext.find(' ');
-        OtherTy = ExtContext.substr(0, SpaceLocation);
+        OtherTy = CTypeRegistry::Get().Intern(std::string_view { ExtContext }.substr(0, SpaceLocation));
         m_StrBuffer[ExtContext.substr(SpaceLocation + 1).copy(m_StrBuffer, sizeof(m_StrBuffer) - 1)] = '\0';
         OnEndPopup();
     }
 
 private:
-    std::string OtherTy;
+    SDataType OtherTy = VoidDataType;
     char m_StrBuffer[256] { };
 };
 
@@ -723,12 +1534,17 @@ public:
         return "Event";
     }
 
-    void Execute() override
+    CFlowTask ExecuteAsync() override
     {
-        CInputDispatcher::Get().Play(m_PlaybackEvent);
+        const auto Finished = std::make_shared<CFlowEvent>();
+        CInputDispatcher::Get().Play(m_PlaybackEvent, [Finished] { Finished->Set(); });
+
+        // How often the progress should update
+        constexpr auto UpdateInterval = std::chrono::milliseconds(50);
+
         size_t OldProgress = -1;
         while (CInputDispatcher::Get().IsPlaying()) {
-            if (!*m_Manager) {
+            if (IsStopRequested()) {
                 CInputDispatcher::Get().Stop();
                 break;
             }
@@ -737,7 +1553,7 @@ public:
                 OldProgress = NewProgress;
                 SetInnerText(std::format("{:<3}/{:<3} action(s)", OldProgress, m_PlaybackEvent.size()));
             }
-            std::this_thread::yield();
+            co_await WaitFor(Finished, UpdateInterval);
         }
 
         SetInnerText(std::format("{:<7} action(s)", m_PlaybackEvent.size()));
@@ -872,5 +1688,5 @@ private:
     std::chrono::steady_clock::time_point m_LastEventTime;
 };
 
-REGISTER_MACROS(CActionReplayNode, CDelayNode, CTrivialValueNode, CAddNode, CEntranceNode, COnTriggerNode, CToStringNode, CPrintingNode, CBranchingNode, CSequenceNode)
+REGISTER_MACROS(CActionReplayNode, CDelayNode, CTrivialValueNode, CAddNode, CSubtractNode, CMultiplyNode, CDivideNode, CEntranceNode, COnTriggerNode, CToStringNode, CPrintingNode, CBranchingNode, CSequenceNode, CForLoopNode, CWhileLoopNode, CForEachLoopNode, CMapNode)
 ENABLE_IMGUI()
\ No newline at end of file
@@ -4,6 +4,8 @@
 
 #include "CustomNodeManager.hxx"
 
+#include <AMboard/Macro/TypeId.hxx>
+
 #include <spdlog/spdlog.h>
 
 #include <algorithm>
@@ -89,6 +91,12 @@ CCustomNodeHandle::CCustomNodeHandle(const std::filesystem::path& Path, void* Im
     if (const auto ImGuiCtxFunc = reinterpret_cast<void (*)(void*)>(lib_sym(m_LibHandle, "set_imgui_context")))
         ImGuiCtxFunc(ImGuiCtx);
 
+    /// Share our type names with MacroSharedLib, ids already agree since they are hashes
+    if (const auto TypeRegistryFunc = reinterpret_cast<void (*)(void*)>(lib_sym(m_LibHandle, "set_type_registry")))
+        TypeRegistryFunc(&CTypeRegistry::Get());
+    if (const auto CollectionsFunc = reinterpret_cast<void (*)()>(lib_sym(m_LibHandle, "register_collections")))
+        CollectionsFunc();
+
     for (const char** name = NamesFunc(); *name; ++name) {
         std::string createSym = std::string("create_") + *name;
         std::string destroySym = std::string("destroy_") + *name;
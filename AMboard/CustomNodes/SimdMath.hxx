@@ -0,0 +1,252 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <type_traits>
+
+#if defined(__AVX2__)
+#define AMB_SIMD_AVX2
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define AMB_SIMD_SSE2
+#include <emmintrin.h>
+#endif
+
+enum class EMathOperation {
+    Add,
+    Subtract,
+    Multiply,
+    Divide
+};
+
+namespace SimdMath {
+
+template <EMathOperation Op, typename Ty>
+constexpr Ty ApplyScalar(const Ty Lhs, const Ty Rhs) noexcept
+{
+    if constexpr (Op == EMathOperation::Add)
+        return static_cast<Ty>(Lhs + Rhs);
+    else if constexpr (Op == EMathOperation::Subtract)
+        return static_cast<Ty>(Lhs - Rhs);
+    else if constexpr (Op == EMathOperation::Multiply)
+        return static_cast<Ty>(Lhs * Rhs);
+    else
+        return static_cast<Ty>(Lhs / Rhs);
+}
+
+/// Register wrapper per element type, Width == 0 means no vector path for that type
+template <typename Ty>
+struct SLane {
+    static constexpr size_t Width = 0;
+};
+
+#if defined(AMB_SIMD_AVX2)
+template <>
+struct SLane<float> {
+    using Register = __m256;
+    static constexpr size_t Width = 8;
+
+    static Register Load(const float* Data) noexcept { return _mm256_loadu_ps(Data); }
+    static Register Broadcast(const float Value) noexcept { return _mm256_set1_ps(Value); }
+    static void Store(float* Data, const Register Value) noexcept { _mm256_storeu_ps(Data, Value); }
+
+    template <EMathOperation Op>
+    static constexpr bool Supports = true;
+
+    template <EMathOperation Op>
+    static Register Apply(const Register Lhs, const Register Rhs) noexcept
+    {
+        if constexpr (Op == EMathOperation::Add)
+            return _mm256_add_ps(Lhs, Rhs);
+        else if constexpr (Op == EMathOperation::Subtract)
+            return _mm256_sub_ps(Lhs, Rhs);
+        else if constexpr (Op == EMathOperation::Multiply)
+            return _mm256_mul_ps(Lhs, Rhs);
+        else
+            return _mm256_div_ps(Lhs, Rhs);
+    }
+};
+
+template <>
+struct SLane<double> {
+    using Register = __m256d;
+    static constexpr size_t Width = 4;
+
+    static Register Load(const double* Data) noexcept { return _mm256_loadu_pd(Data); }
+    static Register Broadcast(const double Value) noexcept { return _mm256_set1_pd(Value); }
+    static void Store(double* Data, const Register Value) noexcept { _mm256_storeu_pd(Data, Value); }
+
+    template <EMathOperation Op>
+    static constexpr bool Supports = true;
+
+    template <EMathOperation Op>
+    static Register Apply(const Register Lhs, const Register Rhs) noexcept
+    {
+        if constexpr (Op == EMathOperation::Add)
+            return _mm256_add_pd(Lhs, Rhs);
+        else if constexpr (Op == EMathOperation::Subtract)
+            return _mm256_sub_pd(Lhs, Rhs);
+        else if constexpr (Op == EMathOperation::Multiply)
+            return _mm256_mul_pd(Lhs, Rhs);
+        else
+            return _mm256_div_pd(Lhs, Rhs);
+    }
+};
+
+/// Wrapping add/sub/mullo give the same low 32 bits for signed and unsigned
+template <typename Ty>
+struct SLane32 {
+    using Register = __m256i;
+    static constexpr size_t Width = 8;
+
+    static Register Load(const Ty* Data) noexcept { return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(Data)); }
+    static Register Broadcast(const Ty Value) noexcept { return _mm256_set1_epi32(static_cast<int32_t>(Value)); }
+    static void Store(Ty* Data, const Register Value) noexcept { _mm256_storeu_si256(reinterpret_cast<__m256i*>(Data), Value); }
+
+    template <EMathOperation Op>
+    static constexpr bool Supports = Op != EMathOperation::Divide;
+
+    template <EMathOperation Op>
+    static Register Apply(const Register Lhs, const Register Rhs) noexcept
+    {
+        if constexpr (Op == EMathOperation::Add)
+            return _mm256_add_epi32(Lhs, Rhs);
+        else if constexpr (Op == EMathOperation::Subtract)
+            return _mm256_sub_epi32(Lhs, Rhs);
+        else
+            return _mm256_mullo_epi32(Lhs, Rhs);
+    }
+};
+#elif defined(AMB_SIMD_SSE2)
+template <>
+struct SLane<float> {
+    using Register = __m128;
+    static constexpr size_t Width = 4;
+
+    static Register Load(const float* Data) noexcept { return _mm_loadu_ps(Data); }
+    static Register Broadcast(const float Value) noexcept { return _mm_set1_ps(Value); }
+    static void Store(float* Data, const Register Value) noexcept { _mm_storeu_ps(Data, Value); }
+
+    template <EMathOperation Op>
+    static constexpr bool Supports = true;
+
+    template <EMathOperation Op>
+    static Register Apply(const Register Lhs, const Register Rhs) noexcept
+    {
+        if constexpr (Op == EMathOperation::Add)
+            return _mm_add_ps(Lhs, Rhs);
+        else if constexpr (Op == EMathOperation::Subtract)
+            return _mm_sub_ps(Lhs, Rhs);
+        else if constexpr (Op == EMathOperation::Multiply)
+            return _mm_mul_ps(Lhs, Rhs);
+        else
+            return _mm_div_ps(Lhs, Rhs);
+    }
+};
+
+template <>
+struct SLane<double> {
+    using Register = __m128d;
+    static constexpr size_t Width = 2;
+
+    static Register Load(const double* Data) noexcept { return _mm_loadu_pd(Data); }
+    static Register Broadcast(const double Value) noexcept { return _mm_set1_pd(Value); }
+    static void Store(double* Data, const Register Value) noexcept { _mm_storeu_pd(Data, Value); }
+
+    template <EMathOperation Op>
+    static constexpr bool Supports = true;
+
+    template <EMathOperation Op>
+    static Register Apply(const Register Lhs, const Register Rhs) noexcept
+    {
+        if constexpr (Op == EMathOperation::Add)
+            return _mm_add_pd(Lhs, Rhs);
+        else if constexpr (Op == EMathOperation::Subtract)
+            return _mm_sub_pd(Lhs, Rhs);
+        else if constexpr (Op == EMathOperation::Multiply)
+            return _mm_mul_pd(Lhs, Rhs);
+        else
+            return _mm_div_pd(Lhs, Rhs);
+    }
+};
+
+/// SSE2 has no 32-bit mullo, multiplication stays on the scalar loop
+template <typename Ty>
+struct SLane32 {
+    using Register = __m128i;
+    static constexpr size_t Width = 4;
+
+    static Register Load(const Ty* Data) noexcept { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(Data)); }
+    static Register Broadcast(const Ty Value) noexcept { return _mm_set1_epi32(static_cast<int32_t>(Value)); }
+    static void Store(Ty* Data, const Register Value) noexcept { _mm_storeu_si128(reinterpret_cast<__m128i*>(Data), Value); }
+
+    template <EMathOperation Op>
+    static constexpr bool Supports = Op == EMathOperation::Add || Op == EMathOperation::Subtract;
+
+    template <EMathOperation Op>
+    static Register Apply(const Register Lhs, const Register Rhs) noexcept
+    {
+        if constexpr (Op == EMathOperation::Add)
+            return _mm_add_epi32(Lhs, Rhs);
+        else
+            return _mm_sub_epi32(Lhs, Rhs);
+    }
+};
+#endif
+
+#if defined(AMB_SIMD_AVX2) || defined(AMB_SIMD_SSE2)
+template <>
+struct SLane<int32_t> : SLane32<int32_t> { };
+template <>
+struct SLane<uint32_t> : SLane32<uint32_t> { };
+#endif
+
+template <typename Ty, EMathOperation Op>
+concept Vectorizable = SLane<Ty>::Width != 0 && SLane<Ty>::template Supports<Op>;
+
+/// One register of Ty from Data, other element types are converted through a stack buffer
+template <typename Ty, typename From>
+auto LoadAs(const From* Data) noexcept
+{
+    using Lane = SLane<Ty>;
+    if constexpr (std::is_same_v<Ty, From>) {
+        return Lane::Load(Data);
+    } else {
+        Ty Promoted[Lane::Width];
+        for (size_t Index = 0; Index < Lane::Width; ++Index)
+            Promoted[Index] = static_cast<Ty>(Data[Index]);
+        return Lane::Load(Promoted);
+    }
+}
+
+/// Element-wise Lhs (op) Rhs into Output, a single element operand is broadcast across the other.
+/// Operands of another element type are promoted to Ty as they are read
+template <EMathOperation Op, typename Ty, typename LhsTy, typename RhsTy>
+void ElementWise(std::span<const LhsTy> Lhs, std::span<const RhsTy> Rhs, std::span<Ty> Output) noexcept
+{
+    const size_t Count = Output.size();
+    if (Count == 0)
+        return;
+
+    const bool LhsBroadcast = Lhs.size() == 1 && Count != 1;
+    const bool RhsBroadcast = Rhs.size() == 1 && Count != 1;
+
+    size_t Index = 0;
+    if constexpr (Vectorizable<Ty, Op>) {
+        using Lane = SLane<Ty>;
+
+        const auto LhsSplat = Lane::Broadcast(static_cast<Ty>(Lhs[0]));
+        const auto RhsSplat = Lane::Broadcast(static_cast<Ty>(Rhs[0]));
+        for (; Index + Lane::Width <= Count; Index += Lane::Width) {
+            const auto A = LhsBroadcast ? LhsSplat : LoadAs<Ty>(Lhs.data() + Index);
+            const auto B = RhsBroadcast ? RhsSplat : LoadAs<Ty>(Rhs.data() + Index);
+            Lane::Store(Output.data() + Index, Lane::template Apply<Op>(A, B));
+        }
+    }
+
+    for (; Index < Count; ++Index)
+        Output[Index] = ApplyScalar<Op, Ty>(static_cast<Ty>(Lhs[LhsBroadcast ? 0 : Index]), static_cast<Ty>(Rhs[RhsBroadcast ? 0 : Index]));
+}
+
+}
\ No newline at end of file
@@ -427,6 +427,10 @@ class CGetWindowTitle : public CBaseNode {
 public:
     CGetWindowTitle()
     {
+        /// Title can change without any input changes
+        m_IsVolatile = true;
+        m_IsShareable = true;
+
         EmplacePin<CDataPin>(true)->SetValueType("HWND").SetToolTips("Window Handle");
         EmplacePin<CDataPin>(false)->SetValueType("string");
     }
@@ -470,6 +474,10 @@ class CScreenArea : public CBaseNode, public INodeImGuiPupUpExt, public INodeInn
 public:
     CScreenArea()
     {
+        /// Target window can move without any input changes
+        m_IsVolatile = true;
+        m_IsShareable = true;
+
         EmplacePin<CDataPin>(false)->SetValueType("cv::Rect").SetToolTips("Client Rect");
     }
 
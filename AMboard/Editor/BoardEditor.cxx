@@ -7,10 +7,12 @@
 #include "NodeContextMenu.hxx"
 #include "NodeRender/NodeRenderer.hxx"
 
+#include <AMboard/Board/BoardLoader.hxx>
 #include <AMboard/CustomNodes/CustomNodeManager.hxx>
 #include <AMboard/Macro/DataPin.hxx>
 #include <AMboard/Macro/ExecuteNode.hxx>
 #include <AMboard/Macro/ExecutionManager.hxx>
+#include <AMboard/Macro/GraphTransaction.hxx>
 #include <AMboard/Macro/Ext/FileDrop.hxx>
 #include <AMboard/Macro/Ext/ImGuiPopup.hxx>
 #include <AMboard/Macro/Ext/NodeInnerText.hxx>
@@ -35,6 +37,7 @@
 #include "imgui_impl_glfw.h"
 #include "imgui_impl_wgpu.h"
 
+#include <format>
 #include <fstream>
 #include <random>
 
@@ -110,10 +113,123 @@ void CBoardEditor::RenderImGuiMenu()
             ImGui::EndMenu();
         }
 
+#ifdef AMB_ENABLE_PROFILER
+        RenderProfilerMenu();
+#endif
+
         ImGui::EndMainMenuBar();
     }
 }
 
+#ifdef AMB_ENABLE_PROFILER
+void CBoardEditor::RenderProfilerMenu()
+{
+    if (!ImGui::BeginMenu("Profiler"))
+        return;
+
+    auto* Profiler = m_ExecutionManager->GetProfiler();
+
+    ImGui::MenuItem("Show Node Timings", nullptr, &m_ShowProfilerOverlay);
+    if (ImGui::MenuItem("Reset Node Timings")) {
+        for (const auto& [Left, Right] : m_NodeRenderer->GetValidRange())
+            for (auto i = Left; i <= Right; ++i)
+                if (m_Nodes[i].Node != nullptr)
+                    m_Nodes[i].Node->ResetProfile();
+    }
+
+    ImGui::Separator();
+
+    if (!Profiler->IsCapturing()) {
+        if (ImGui::MenuItem("Start Trace Capture"))
+            Profiler->BeginCapture();
+    } else if (ImGui::MenuItem("Stop Trace Capture")) {
+        Profiler->EndCapture();
+    }
+
+    if (ImGui::MenuItem("Export Chrome Trace ...", nullptr, false, !Profiler->IsCapturing()))
+        ExportProfilerTrace();
+
+    ImGui::EndMenu();
+}
+
+void CBoardEditor::RenderProfilerOverlay()
+{
+    ImGui::SetNextWindowPos(ImVec2(0, 0));
+    ImGui::SetNextWindowSize(ImGui::GetIO().DisplaySize);
+    ImGui::Begin("##ProfilerOverlay", nullptr,
+        ImGuiWindowFlags_NoTitleBar | ImGuiWindowFlags_NoResize | ImGuiWindowFlags_NoMove | ImGuiWindowFlags_NoScrollbar | ImGuiWindowFlags_NoInputs | ImGuiWindowFlags_NoBackground | ImGuiWindowFlags_NoBringToFrontOnFocus);
+
+    const auto TotalTimeOf = [](const SNodeProfile& Profile) {
+        return Profile.ExecuteNs.load(std::memory_order_relaxed) + Profile.EvaluateNs.load(std::memory_order_relaxed);
+    };
+
+    /// Heat is relative to the most expensive node on the board
+    uint64_t MaxTime = 1;
+    for (const auto& [Left, Right] : m_NodeRenderer->GetValidRange())
+        for (auto i = Left; i <= Right; ++i)
+            if (m_Nodes[i].Node != nullptr)
+                MaxTime = std::max(MaxTime, TotalTimeOf(m_Nodes[i].Node->GetProfile()));
+
+    ImDrawList* DrawList = ImGui::GetWindowDrawList();
+    for (const auto& [Left, Right] : m_NodeRenderer->GetValidRange()) {
+        for (auto i = Left; i <= Right; ++i) {
+            if (m_Nodes[i].Node == nullptr)
+                continue;
+
+            const auto& Profile = m_Nodes[i].Node->GetProfile();
+            const auto Calls = Profile.Calls.load(std::memory_order_relaxed);
+            if (Calls == 0)
+                continue;
+
+            const auto TotalTime = TotalTimeOf(Profile);
+            const auto Text = std::format("{}x  avg {:.1f}us  in {:.1f}us  {}B",
+                Calls, static_cast<double>(TotalTime) / 1000.0 / static_cast<double>(Calls),
+                static_cast<double>(Profile.PrepareInputNs.load(std::memory_order_relaxed)) / 1000.0 / static_cast<double>(Calls),
+                Profile.OutputBytes.load(std::memory_order_relaxed));
+
+            const float Heat = static_cast<float>(TotalTime) / static_cast<float>(MaxTime);
+            const auto ScreenPos = WorldToScreen(m_NodeRenderer->GetNodePosition(i));
+            const ImVec2 TextPos { ScreenPos.x, ScreenPos.y - ImGui::GetTextLineHeight() - 4 };
+            const ImVec2 TextSize = ImGui::CalcTextSize(Text.c_str());
+
+            DrawList->AddRectFilled(ImVec2 { TextPos.x - 3, TextPos.y - 1 }, ImVec2 { TextPos.x + TextSize.x + 3, TextPos.y + TextSize.y + 1 }, IM_COL32(0, 0, 0, 160), 3.0f);
+            DrawList->AddText(TextPos, IM_COL32(static_cast<int>(80 + 175 * Heat), static_cast<int>(255 - 175 * Heat), 80, 255), Text.c_str());
+        }
+    }
+
+    ImGui::End();
+}
+
+void CBoardEditor::ExportProfilerTrace()
+{
+    NFD_Init();
+
+    nfdchar_t* SavePath;
+
+    static constexpr nfdfilteritem_t FilterItem[] = { { "Chrome Trace", "json" } };
+    if (NFD_SaveDialog(&SavePath, FilterItem, 1, std::filesystem::current_path().string().c_str(), "Trace.json") == NFD_OKAY) {
+
+        /// Nodes removed since the capture only have their address left
+        std::unordered_map<const CBaseNode*, std::string> NodeNames;
+        for (const auto& [Left, Right] : m_NodeRenderer->GetValidRange())
+            for (auto i = Left; i <= Right; ++i)
+                if (m_Nodes[i].Node != nullptr)
+                    NodeNames.emplace(m_Nodes[i].Node.get(), m_NodeRenderer->GetTitle(i));
+
+        const bool Written = m_ExecutionManager->GetProfiler()->WriteChromeTrace(SavePath, [&NodeNames](const CBaseNode* Node) {
+            const auto It = NodeNames.find(Node);
+            return It != NodeNames.end() ? It->second : std::format("Removed node {}", static_cast<const void*>(Node));
+        });
+
+        if (!Written)
+            spdlog::error("Failed to write trace to {}", SavePath);
+        NFD_FreePath(SavePath);
+    }
+
+    NFD_Quit();
+}
+#endif
+
 glm::vec2 CBoardEditor::WorldToScreen(const glm::vec2& WorldPos) const noexcept
 {
     return (WorldPos - m_CameraOffset) * m_CameraZoom;
@@ -160,8 +276,7 @@ size_t CBoardEditor::RegisterNode(NodeStorage Node, const std::string& Title, co
     if (!Node)
         return -1;
 
-    if (auto* ExecutionNode = dynamic_cast<CExecuteNode*>(Node.get()))
-        ExecutionNode->SetManager(m_ExecutionManager.get());
+    m_ExecutionManager->RegisterNode(Node.get());
 
     const auto NodeId = m_NodeRenderer->CreateNode(Title, Position, HeaderColor);
     if (NodeId >= m_Nodes.size())
@@ -215,15 +330,21 @@ size_t CBoardEditor::RegisterNode(NodeStorage Node, const std::string& Title, co
                 EndPinDrag();
             }
 
-            /// Pin position changes
+            /// Pin position changes, pins and links a transaction still holds back are laid out once they are delivered
             for (const auto& SameSidePin : IsInputPin ? TargetPin->GetOwner()->GetInputPins() : TargetPin->GetOwner()->GetOutputPins()) {
-                const auto SameSidePinId = m_PinIdMapping.left.at(SameSidePin.get());
+                const auto SameSideIt = m_PinIdMapping.left.find(SameSidePin.get());
+                if (SameSideIt == m_PinIdMapping.left.end())
+                    continue;
+                const auto SameSidePinId = SameSideIt->second;
 
                 for (auto* ConnectedPin : SameSidePin->GetConnections()) {
-                    if (IsInputPin) {
-                        m_NodeRenderer->RefreshLinkedPin(m_ConnectionIdMapping.at(std::pair { ConnectedPin, SameSidePin.get() }), std::nullopt, SameSidePinId);
-                    } else {
-                        m_NodeRenderer->RefreshLinkedPin(m_ConnectionIdMapping.at(std::pair { SameSidePin.get(), ConnectedPin }), SameSidePinId, std::nullopt);
+                    const auto Key = IsInputPin ? std::pair { ConnectedPin, SameSidePin.get() } : std::pair { SameSidePin.get(), ConnectedPin };
+                    if (const auto LinkIt = m_ConnectionIdMapping.find(Key); LinkIt != m_ConnectionIdMapping.end()) {
+                        if (IsInputPin) {
+                            m_NodeRenderer->RefreshLinkedPin(LinkIt->second, std::nullopt, SameSidePinId);
+                        } else {
+                            m_NodeRenderer->RefreshLinkedPin(LinkIt->second, SameSidePinId, std::nullopt);
+                        }
                     }
                 }
 
@@ -300,6 +421,10 @@ void CBoardEditor::LoadCanvas()
 
 void CBoardEditor::LoadCanvas(const std::filesystem::path& Canvas)
 {
+    /// Listeners see each net edge change once, and every GPU buffer is written once at the end
+    const CNodeRenderBatch RenderBatch { *m_NodeRenderer };
+    CGraphTransaction Transaction { *m_ExecutionManager };
+
     for (int i = 0; i < m_Nodes.size(); ++i) {
         if (m_Nodes[i].Node != nullptr) {
             m_Nodes[i].Node.reset();
@@ -308,54 +433,13 @@ void CBoardEditor::LoadCanvas(const std::filesystem::path& Canvas)
     }
     m_EntranceNode.reset();
 
-    VERIFY(std::filesystem::exists("graph.yaml"), return);
-
-    YAML::Node Graph = YAML::LoadFile(Canvas.string());
+    LoadBoard(Canvas, *m_CustomNodeLoader, [this](SBoardNode&& Loaded) {
+        const auto NodeId = RegisterNode(std::move(Loaded.Node), Loaded.Name, glm::vec2 { Loaded.Position[0], Loaded.Position[1] }, Loaded.HeaderColor);
 
-    std::unordered_map<uint64_t, CPin*> PinHashMap;
-
-    for (const auto& Node : Graph["Nodes"]) {
-        const auto Name = Node["ID"].as<std::string>();
-        const auto Position = Node["pos"].IsDefined() ? glm::vec2 { Node["pos"][0].as<float>(), Node["pos"][1].as<float>() } : glm::vec2(0.0f, 0.0f);
-        const auto HeaderColor = Node["header_color"].as<uint32_t>(0xAAAAAA88);
-
-        auto CreatedNode = m_CustomNodeLoader->CreateNodeExt(Name);
-        if (auto NodeExt = Node["Ext"]; NodeExt)
-            CreatedNode->ReadExtraContext(NodeExt.as<std::string>());
-
-        const auto NodeId = RegisterNode(std::move(CreatedNode), Name, Position, HeaderColor);
-
-        if (Name == "Entrance Node") [[unlikely]] {
+        if (Loaded.Name == EntranceNodeName) [[unlikely]] {
             m_EntranceNode = NodeId;
         }
-
-        std::mt19937 rng(Node["salt"].as<uint64_t>());
-        std::uniform_int_distribution<uint64_t> dist;
-
-        for (const auto& Pin : m_Nodes[NodeId].Node->GetInputPins())
-            MAKE_SURE(PinHashMap.insert({ dist(rng), Pin.get() }).second);
-        for (const auto& Pin : m_Nodes[NodeId].Node->GetOutputPins())
-            MAKE_SURE(PinHashMap.insert({ dist(rng), Pin.get() }).second);
-    }
-
-    for (const auto& Link : Graph["Links"]) {
-        const auto OutputId = Link[0].as<uint64_t>();
-        const auto InputId = Link[1].as<uint64_t>();
-
-        const auto OutputIt = PinHashMap.find(OutputId);
-        const auto InputIt = PinHashMap.find(InputId);
-
-        if (OutputIt == PinHashMap.end()) [[unlikely]] {
-            spdlog::error("Pin #{} missing", OutputId);
-            continue;
-        }
-        if (InputIt == PinHashMap.end()) [[unlikely]] {
-            spdlog::error("Pin #{} missing", InputId);
-            continue;
-        }
-
-        OutputIt->second->ConnectPin(InputIt->second);
-    }
+    });
 }
 
 void CBoardEditor::SaveCanvas() noexcept
@@ -423,6 +507,10 @@ void CBoardEditor::SaveCanvasTo(const std::filesystem::path& Path) noexcept
             if (!NodeExt.empty())
                 Node["Ext"] = NodeExt;
 
+            if (const auto* ExecuteNode = dynamic_cast<const CExecuteNode*>(m_Nodes[i].Node.get()))
+                if (const auto Priority = ExecuteNode->GetFlowPriority())
+                    Node["priority"] = std::string(FlowPriorityNames[std::to_underlying(*Priority)]);
+
             Root["Nodes"].push_back(Node);
         }
     }
@@ -456,6 +544,27 @@ void CBoardEditor::FlushPendingNodeTextUpdate()
     m_PendingNodeTextUpdate.clear();
 }
 
+void CBoardEditor::OptimizeBoard()
+{
+    const auto Revision = m_ExecutionManager->GetGraphRevision();
+    if (Revision == m_OptimizedGraphRevision)
+        return;
+    m_OptimizedGraphRevision = Revision;
+
+    std::vector<CBaseNode*> Nodes;
+    for (const auto& Context : m_Nodes)
+        if (Context.Node)
+            Nodes.emplace_back(Context.Node.get());
+    m_ExecutionManager->OptimizeGraph(Nodes);
+
+    for (size_t NodeId = 0; NodeId < m_Nodes.size(); ++NodeId) {
+        if (const auto* Node = m_Nodes[NodeId].Node.get()) {
+            (m_NodeRenderer.get()->*(Node->IsFolded() ? &CNodeRenderer::SetState : &CNodeRenderer::ResetState))(NodeId, ECommonNodeState::Folded);
+            (m_NodeRenderer.get()->*(Node->IsDead() ? &CNodeRenderer::SetState : &CNodeRenderer::ResetState))(NodeId, ECommonNodeState::Dead);
+        }
+    }
+}
+
 void CBoardEditor::SetCancelOnHoldAction(auto&& Func)
 {
     if (m_CancelOnHoldAction)
@@ -671,6 +780,9 @@ CWindowBase::EWindowEventState CBoardEditor::ProcessEvent()
     /// Remove Node
     if (GetInputManager().GetKeyboardButtons().ConsumeEvent(GLFW_KEY_DELETE)) {
         SetCancelOnHoldAction(nullptr);
+
+        const CNodeRenderBatch RenderBatch { *m_NodeRenderer };
+        CGraphTransaction Transaction { *m_ExecutionManager };
         for (const auto NodeId : m_SelectedNodes) {
             m_Nodes[NodeId].Node.reset();
             m_NodeRenderer->RemoveNode(NodeId);
@@ -774,8 +886,14 @@ CWindowBase::EWindowEventState CBoardEditor::ProcessEvent()
         if (CursorHoveringPin.has_value()) {
             CursorHoveringPtr->DisconnectPins();
         } else if (CursorHoveringNode.has_value()) {
-            if ((m_PopupNode = dynamic_cast<INodeImGuiPupUpExt*>(m_Nodes[*CursorHoveringNode].Node.get()))) {
-                m_PopupTitle = m_PopupNode->GetTitle();
+            auto* Node = m_Nodes[*CursorHoveringNode].Node.get();
+            if (auto* PopupExt = dynamic_cast<INodeImGuiPupUpExt*>(Node)) {
+                m_PopupNode = Node;
+                m_PopupTitle = PopupExt->GetTitle();
+                m_TriggerPopup = true;
+            } else if (dynamic_cast<CExecuteNode*>(Node) != nullptr) {
+                m_PopupNode = Node;
+                m_PopupTitle = m_NodeRenderer->GetTitle(*CursorHoveringNode);
                 m_TriggerPopup = true;
             }
         }
@@ -877,24 +995,29 @@ CWindowBase::EWindowEventState CBoardEditor::ProcessEvent()
 void CBoardEditor::RenderBoard(const SRenderContext& RenderContext)
 {
 
-    const auto CurrentActiveNode = m_ExecutionManager->GetActiveNode();
-    if (m_LastExecutedNode != CurrentActiveNode) {
+    auto CurrentActiveNodes = m_ExecutionManager->GetActiveNodes();
+    std::ranges::sort(CurrentActiveNodes);
+    if (m_LastExecutedNodes != CurrentActiveNodes) {
 
-        if (m_LastExecutedNode != nullptr) {
-            if (const auto It = std::find(m_Nodes.begin(), m_Nodes.end(), m_LastExecutedNode); It != m_Nodes.end()) {
+        for (auto* LastNode : m_LastExecutedNodes) {
+            if (std::ranges::binary_search(CurrentActiveNodes, LastNode))
+                continue;
+            if (const auto It = std::find(m_Nodes.begin(), m_Nodes.end(), LastNode); It != m_Nodes.end()) {
                 m_NodeRenderer->DeExecute(std::distance(m_Nodes.begin(), It));
             }
         }
 
-        if (CurrentActiveNode != nullptr) {
-            if (const auto It = std::find(m_Nodes.begin(), m_Nodes.end(), CurrentActiveNode); It != m_Nodes.end()) {
+        for (auto* CurrentNode : CurrentActiveNodes) {
+            if (const auto It = std::find(m_Nodes.begin(), m_Nodes.end(), CurrentNode); It != m_Nodes.end()) {
                 m_NodeRenderer->Execute(std::distance(m_Nodes.begin(), It));
             }
         }
 
-        m_LastExecutedNode = CurrentActiveNode;
+        m_LastExecutedNodes = std::move(CurrentActiveNodes);
     }
 
+    OptimizeBoard();
+
     /// ===================================================
     ///                  Actual Rendering
     /// ===================================================
@@ -972,6 +1095,9 @@ void CBoardEditor::RenderBoard(const SRenderContext& RenderContext)
         }
 
         if (m_PopupNode) {
+            auto* PopupExt = dynamic_cast<INodeImGuiPupUpExt*>(m_PopupNode);
+            auto* PopupExecuteNode = dynamic_cast<CExecuteNode*>(m_PopupNode);
+
             ImGuiViewport* viewport = ImGui::GetMainViewport();
             ImGui::SetNextWindowPos(viewport->WorkPos);
             ImGui::SetNextWindowSize(viewport->WorkSize);
@@ -984,7 +1110,8 @@ void CBoardEditor::RenderBoard(const SRenderContext& RenderContext)
             // Trigger the popup ONLY ONCE
             if (m_TriggerPopup) {
                 ImGui::OpenPopup(m_PopupTitle.c_str());
-                m_PopupNode->OnStartPopup();
+                if (PopupExt)
+                    PopupExt->OnStartPopup();
                 m_TriggerPopup = false;
             }
 
@@ -997,16 +1124,37 @@ void CBoardEditor::RenderBoard(const SRenderContext& RenderContext)
 
             bool DoShow = true;
             if (ImGui::BeginPopupModal(m_PopupTitle.c_str(), &DoShow, ImGuiWindowFlags_AlwaysAutoResize | ImGuiWindowFlags_NoMove)) {
-                if (!m_PopupNode->Render()) {
+                if (PopupExt && !PopupExt->Render()) {
                     DoShow = false;
                     ImGui::CloseCurrentPopup();
                 }
 
+                /// "inherit" keeps the class of whichever flow reaches the node
+                if (PopupExecuteNode) {
+                    const auto Priority = PopupExecuteNode->GetFlowPriority();
+                    if (PopupExt)
+                        ImGui::Separator();
+                    if (ImGui::BeginCombo("Flow priority", Priority ? FlowPriorityNames[std::to_underlying(*Priority)].data() : "inherit")) {
+                        if (ImGui::Selectable("inherit", !Priority))
+                            PopupExecuteNode->SetFlowPriority(std::nullopt);
+                        for (size_t Index = 0; Index < FlowPriorityNames.size(); ++Index) {
+                            if (ImGui::Selectable(FlowPriorityNames[Index].data(), Priority && std::to_underlying(*Priority) == Index))
+                                PopupExecuteNode->SetFlowPriority(static_cast<EFlowPriority>(Index));
+                        }
+                        ImGui::EndCombo();
+                    }
+                }
+
                 ImGui::EndPopup();
             }
 
             if (!DoShow) {
-                m_PopupNode->OnEndPopup();
+                if (PopupExt)
+                    PopupExt->OnEndPopup();
+
+                /// Ext setting might have changed, it also takes part in the optimizer's structural hash
+                m_PopupNode->MarkDirty();
+                m_OptimizedGraphRevision = 0;
                 m_PopupNode = nullptr;
             }
 
@@ -1035,6 +1183,11 @@ void CBoardEditor::RenderBoard(const SRenderContext& RenderContext)
             ImGui::End();
         }
 
+#ifdef AMB_ENABLE_PROFILER
+        if (m_ShowProfilerOverlay)
+            RenderProfilerOverlay();
+#endif
+
         ImGui::Render();
         ImGui_ImplWGPU_RenderDrawData(ImGui::GetDrawData(), RenderContext.RenderPassEncoder.Get());
     }
@@ -1079,6 +1232,8 @@ void CBoardEditor::OnFileDragDrop(int WindowX, int WindowY, const std::vector<st
 
     if (m_LastFileDragNode.has_value() && m_Nodes[*m_LastFileDragNode].SupportFileDrop) {
         dynamic_cast<IFileDrop*>(m_Nodes[*m_LastFileDragNode].Node.get())->OnFileDrop(Files);
+        m_Nodes[*m_LastFileDragNode].Node->MarkDirty();
+        m_OptimizedGraphRevision = 0;
     }
 
     if (m_LastFileDragNode.has_value()) /// Deselect
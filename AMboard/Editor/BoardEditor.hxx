@@ -44,6 +44,13 @@ class CBoardEditor : public CWindowBase {
 
     void RenderImGuiMenu();
 
+#ifdef AMB_ENABLE_PROFILER
+    void RenderProfilerMenu();
+    /// Per-node timings drawn above each node
+    void RenderProfilerOverlay();
+    void ExportProfilerTrace();
+#endif
+
     [[nodiscard]] glm::vec2 WorldToScreen(const glm::vec2& WorldPos) const noexcept;
     [[nodiscard]] glm::vec2 ScreenToWorld(const glm::vec2& ScreenPos) const noexcept;
     [[nodiscard]] std::optional<std::size_t> WorldAboveNode(const glm::vec2& WorldPos) const noexcept;
@@ -65,6 +72,9 @@ class CBoardEditor : public CWindowBase {
 
     void FlushPendingNodeTextUpdate();
 
+    /// Rerun the graph optimizer once the board changed and show which nodes got folded or are dead
+    void OptimizeBoard();
+
     void SetCancelOnHoldAction(auto&& Func);
 
     void UpdateDragSelection(bool ResetSelection = false);
@@ -126,14 +136,17 @@ protected:
 
     std::unique_ptr<class CCustomNodeLoader> m_CustomNodeLoader;
 
-    class INodeImGuiPupUpExt* m_PopupNode = nullptr;
+    /// Node whose settings popup is open, either an INodeImGuiPupUpExt or an execute node with only its flow priority to edit
+    CBaseNode* m_PopupNode = nullptr;
     std::string m_PopupTitle;
     bool m_TriggerPopup = true;
 
     std::mutex m_PendingNodeTextUpdateMutex;
     std::unordered_map<std::pair<size_t, ENodeTextType>, std::pair<class INodeInnerText*, STextUpdateData>, SPairHash<size_t, ENodeTextType>> m_PendingNodeTextUpdate;
 
-    class CExecuteNode* m_LastExecutedNode = nullptr;
+    std::vector<class CExecuteNode*> m_LastExecutedNodes;
+    /// Graph revision the optimizer last ran on, reset to force a rerun after an Ext change
+    uint64_t m_OptimizedGraphRevision = 0;
     std::unique_ptr<class CExecutionManager> m_ExecutionManager;
 
     std::unordered_map<std::string, NodeStorage> m_NodeTemplates;
@@ -144,4 +157,8 @@ protected:
     float m_NodeSnapValue = 5;
 
     std::filesystem::path m_CurrentBoardPath;
+
+#ifdef AMB_ENABLE_PROFILER
+    bool m_ShowProfilerOverlay = false;
+#endif
 };
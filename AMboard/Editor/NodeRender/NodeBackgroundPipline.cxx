@@ -43,6 +43,8 @@ const PICKED_BORDER_WIDTH: f32 = 3.0;
 const EXECUTING_BORDER_WIDTH: f32 = 5.0;
 const FILEDROP_BORDER_WIDTH: f32 = 3.0;
 const BODY_COLOR: vec4<f32> = vec4<f32>(0.15, 0.15, 0.2, 1.0);
+const FOLDED_BODY_COLOR: vec4<f32> = vec4<f32>(0.12, 0.2, 0.2, 1.0);
+const DEAD_ALPHA: f32 = 0.4;
 const BORDER_COLOR: vec4<f32> = vec4<f32>(0.3, 0.5, 0.9, 0.7);
 const PICKED_BORDER_COLOR: vec4<f32> = vec4<f32>(1.0, 0.74, 0.0, 1.0);
 const EXECUTING_BORDER_COLOR: vec4<f32> = vec4<f32>(0.74, 1.0, 0.0, 1.0);
@@ -125,11 +127,11 @@ fn fs_main(input: VertexOutput) -> @location(0) vec4<f32> {
         if (p.y < -half_size.y + HEADER_HEIGHT) {
             color = header_color;
         } else {
-            color = BODY_COLOR;
+            color = select(BODY_COLOR, FOLDED_BODY_COLOR, (input.state & 8) != 0);
         }
 
-        // Add border
-        if(input.state == 0){
+        // Add border, folded and dead only affect the fill
+        if((input.state & 7) == 0){
             if (node_dist > -BORDER_WIDTH) {
                 color = BORDER_COLOR;
             }
@@ -162,6 +164,11 @@ fn fs_main(input: VertexOutput) -> @location(0) vec4<f32> {
     let alpha = 1.0 - smoothstep(-edge_softness, edge_softness, node_dist);
     color.a *= alpha;
 
+    // Nothing pulls from dead nodes
+    if((input.state & 16) != 0){
+        color.a *= DEAD_ALPHA;
+    }
+
     return color;
 })";
 
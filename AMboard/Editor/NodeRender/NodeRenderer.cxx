@@ -417,6 +417,24 @@ void CNodeRenderer::UnlinkPin(const size_t Id) noexcept
     m_NodeConnectionPipline->RemoveConnection(Id);
 }
 
+void CNodeRenderer::BeginBatch() const noexcept
+{
+    m_CommonNodeSSBOBuffer->BeginDeferredUpload();
+    m_NodeBackgroundPipline->GetVertexBuffer().BeginDeferredUpload();
+    m_NodeTextPipline->GetVertexBuffer().BeginDeferredUpload();
+    m_NodePinPipline->GetVertexBuffer().BeginDeferredUpload();
+    m_NodeConnectionPipline->GetVertexBuffer().BeginDeferredUpload();
+}
+
+void CNodeRenderer::EndBatch() const noexcept
+{
+    m_CommonNodeSSBOBuffer->EndDeferredUpload();
+    m_NodeBackgroundPipline->GetVertexBuffer().EndDeferredUpload();
+    m_NodeTextPipline->GetVertexBuffer().EndDeferredUpload();
+    m_NodePinPipline->GetVertexBuffer().EndDeferredUpload();
+    m_NodeConnectionPipline->GetVertexBuffer().EndDeferredUpload();
+}
+
 size_t CNodeRenderer::CreateVirtualNode(const glm::vec2& Position)
 {
     const auto FreeId = NextFreeNode();
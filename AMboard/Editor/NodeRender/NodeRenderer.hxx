@@ -24,6 +24,8 @@ enum class ECommonNodeState : uint32_t {
     Selected = 0b1,
     Executing = 0b10,
     FileDropAccept = 0b100,
+    Folded = 0b1000,
+    Dead = 0b10000,
 };
 
 struct SCommonNodeSSBO {
@@ -103,6 +105,10 @@ public:
     size_t CreateNode(const std::string& Title, const glm::vec2& Position, uint32_t HeaderColor);
     void RemoveNode(size_t Id);
 
+    /// Coalesce GPU writes until the matching EndBatch, batches nest
+    void BeginBatch() const noexcept;
+    void EndBatch() const noexcept;
+
     [[nodiscard]] bool InBound(size_t Id, const glm::vec2& Position) const;
     [[nodiscard]] bool InBound(size_t Id, const glm::vec4& Rect) const;
 
@@ -131,3 +137,21 @@ protected:
 
     friend SNodeAdditionalSourceHandle;
 };
+
+/// Scoped CNodeRenderer::BeginBatch / EndBatch
+class CNodeRenderBatch {
+
+public:
+    explicit CNodeRenderBatch(const CNodeRenderer& Renderer) noexcept
+        : m_Renderer(Renderer)
+    {
+        m_Renderer.BeginBatch();
+    }
+    ~CNodeRenderBatch() { m_Renderer.EndBatch(); }
+
+    CNodeRenderBatch(const CNodeRenderBatch&) = delete;
+    CNodeRenderBatch& operator=(const CNodeRenderBatch&) = delete;
+
+protected:
+    const CNodeRenderer& m_Renderer;
+};
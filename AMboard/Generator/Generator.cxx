@@ -0,0 +1,507 @@
+#include <AMboard/Board/BoardLoader.hxx>
+#include <AMboard/CustomNodes/CustomNodeManager.hxx>
+#include <AMboard/Macro/BaseNode.hxx>
+
+#include <spdlog/spdlog.h>
+
+#include <yaml-cpp/yaml.h>
+
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <fstream>
+#include <limits>
+#include <optional>
+#include <random>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace {
+enum EExitCode : int {
+    Success = 0,
+    UsageError = 1,
+    LoadError = 2,
+    WriteError = 3,
+};
+
+enum class ETopology {
+    /// Entrance followed by one long flow chain
+    Chain,
+    /// Binary reduction tree of math nodes over value leaves
+    Tree,
+    /// Stacked diamonds, every node read twice downstream
+    Diamond,
+    /// Random DAG of math nodes, each reading two recent producers
+    RandomDag,
+    /// Entrance fanned out through sequence nodes to many flow leaves
+    Wide
+};
+
+/// Node types the topologies are built from, all provided by ExtCommonNode
+namespace NodeName {
+    constexpr std::string_view Step = "Delay Node";
+    constexpr std::string_view Sequence = "Sequence Node";
+    constexpr std::string_view Value = "Trivial Value Node";
+    constexpr std::string_view ToString = "To String Node";
+    constexpr std::string_view Printing = "Printing Node";
+}
+
+/// A zero second delay resumes immediately, so a step costs one flow hop
+constexpr std::string_view StepExt = "0.000000";
+constexpr std::string_view ValueExt = "double 1";
+
+void PrintUsage()
+{
+    spdlog::info("usage: amb-gen <board.yaml> --topology <chain|tree|diamond|dag|wide> --nodes <count> "
+                 "[--ext <dir>] [--seed <n>] [--math <node name>] [--fanout <2-127>] [--parallel]");
+}
+
+struct SGenerateOptions {
+    std::filesystem::path Board;
+    std::filesystem::path ExtDir = "NodeExts";
+    ETopology Topology = ETopology::Chain;
+    size_t NodeCount = 0;
+    uint64_t Seed = 0;
+    std::string MathNode = "Add Node";
+    uint32_t Fanout = 16;
+    bool Parallel = false;
+};
+
+std::optional<ETopology> ParseTopology(const std::string_view Name)
+{
+    if (Name == "chain")
+        return ETopology::Chain;
+    if (Name == "tree")
+        return ETopology::Tree;
+    if (Name == "diamond")
+        return ETopology::Diamond;
+    if (Name == "dag")
+        return ETopology::RandomDag;
+    if (Name == "wide")
+        return ETopology::Wide;
+    return std::nullopt;
+}
+
+template <typename Ty>
+bool ParseNumber(const std::string_view Value, Ty& Result)
+{
+    const auto [Ptr, Ec] = std::from_chars(Value.data(), Value.data() + Value.size(), Result);
+    return Ec == std::errc() && Ptr == Value.data() + Value.size();
+}
+
+std::optional<SGenerateOptions> ParseArguments(const int Argc, char** Argv)
+{
+    SGenerateOptions Options;
+    for (int i = 1; i < Argc; ++i) {
+        const std::string_view Arg = Argv[i];
+        const bool HasValue = i + 1 < Argc;
+
+        if (Arg == "--ext" && HasValue) {
+            Options.ExtDir = Argv[++i];
+        } else if (Arg == "--topology" && HasValue) {
+            const auto Topology = ParseTopology(Argv[++i]);
+            if (!Topology)
+                return std::nullopt;
+            Options.Topology = *Topology;
+        } else if (Arg == "--nodes" && HasValue) {
+            if (!ParseNumber(Argv[++i], Options.NodeCount) || Options.NodeCount < 2)
+                return std::nullopt;
+        } else if (Arg == "--seed" && HasValue) {
+            if (!ParseNumber(Argv[++i], Options.Seed))
+                return std::nullopt;
+        } else if (Arg == "--math" && HasValue) {
+            Options.MathNode = Argv[++i];
+        } else if (Arg == "--fanout" && HasValue) {
+            /// Sequence nodes store their pin count in one raw Ext byte, which only survives yaml as ASCII
+            if (!ParseNumber(Argv[++i], Options.Fanout) || Options.Fanout < 2 || Options.Fanout > std::numeric_limits<int8_t>::max())
+                return std::nullopt;
+        } else if (Arg == "--parallel") {
+            Options.Parallel = true;
+        } else if (Options.Board.empty() && !Arg.starts_with("--")) {
+            Options.Board = Arg;
+        } else {
+            return std::nullopt;
+        }
+    }
+
+    if (Options.Board.empty() || Options.NodeCount == 0)
+        return std::nullopt;
+    return Options;
+}
+
+/// Which pin (in input then output order) serves which role, learned from a real instance
+struct SNodeLayout {
+    size_t InputCount = 0;
+    size_t OutputCount = 0;
+    std::vector<uint32_t> FlowInputs, FlowOutputs, DataInputs, DataOutputs;
+};
+
+struct SGeneratedNode {
+    std::string_view Name;
+    std::string Ext;
+    std::array<float, 2> Position;
+    uint64_t Salt;
+    const SNodeLayout* Layout;
+    std::vector<uint64_t> PinIds;
+    /// Longest data path from a leaf, used for placement
+    int Depth = 0;
+};
+
+class CBoardGenerator {
+
+public:
+    CBoardGenerator(const CCustomNodeLoader& Loader, const uint64_t Seed)
+        : m_Loader(Loader)
+        , m_Salt(Seed)
+    {
+    }
+
+    /// nullptr if no loaded extension provides the node
+    const SNodeLayout* GetLayout(const std::string_view Name, const std::string_view Ext = { })
+    {
+        std::string Key { Name };
+        Key.push_back('\0');
+        Key.append(Ext);
+
+        if (const auto It = m_Layouts.find(Key); It != m_Layouts.end())
+            return &It->second;
+
+        const auto Node = m_Loader.CreateNodeExt(std::string { Name });
+        if (Node == nullptr)
+            return nullptr;
+        if (!Ext.empty())
+            Node->ReadExtraContext(std::string { Ext });
+
+        SNodeLayout Layout;
+        Layout.InputCount = Node->GetInputPins().size();
+        Layout.OutputCount = Node->GetOutputPins().size();
+        for (uint32_t i = 0; i < Layout.InputCount; ++i)
+            (*Node->GetInputPins()[i] == EPinType::Flow ? Layout.FlowInputs : Layout.DataInputs).push_back(i);
+        for (uint32_t i = 0; i < Layout.OutputCount; ++i)
+            (*Node->GetOutputPins()[i] == EPinType::Flow ? Layout.FlowOutputs : Layout.DataOutputs).push_back(static_cast<uint32_t>(Layout.InputCount) + i);
+
+        return &m_Layouts.emplace(std::move(Key), std::move(Layout)).first->second;
+    }
+
+    size_t AddNode(const std::string_view Name, std::string Ext, const int Depth = 0)
+    {
+        auto& Node = m_Nodes.emplace_back(SGeneratedNode {
+            .Name = Name,
+            .Ext = std::move(Ext),
+            .Position = { },
+            .Salt = NextSalt(),
+            .Layout = nullptr,
+            .PinIds = { },
+            .Depth = Depth,
+        });
+        Node.Layout = GetLayout(Name, Node.Ext);
+
+        /// Same derivation as SaveCanvasTo and LoadBoard
+        std::mt19937 rng(Node.Salt);
+        std::uniform_int_distribution<uint64_t> dist;
+        Node.PinIds.resize(Node.Layout->InputCount + Node.Layout->OutputCount);
+        for (auto& Id : Node.PinIds)
+            Id = dist(rng);
+
+        return m_Nodes.size() - 1;
+    }
+
+    void LinkFlow(const size_t From, const size_t FromIndex, const size_t To)
+    {
+        m_Links.emplace_back(PinIdOf(From, m_Nodes[From].Layout->FlowOutputs[FromIndex]), PinIdOf(To, m_Nodes[To].Layout->FlowInputs[0]));
+    }
+
+    void LinkData(const size_t From, const size_t To, const size_t ToIndex)
+    {
+        m_Links.emplace_back(PinIdOf(From, m_Nodes[From].Layout->DataOutputs[0]), PinIdOf(To, m_Nodes[To].Layout->DataInputs[ToIndex]));
+    }
+
+    [[nodiscard]] SGeneratedNode& operator[](const size_t Index) noexcept { return m_Nodes[Index]; }
+    [[nodiscard]] size_t GetNodeCount() const noexcept { return m_Nodes.size(); }
+
+    /// Place every node on a grid column by its depth, stacked in creation order
+    void LayoutByDepth(const float ColumnSpacing = 260, const float RowSpacing = 140)
+    {
+        std::unordered_map<int, int> RowsInColumn;
+        for (auto& Node : m_Nodes)
+            Node.Position = { static_cast<float>(Node.Depth) * ColumnSpacing, static_cast<float>(RowsInColumn[Node.Depth]++) * RowSpacing };
+    }
+
+    bool Write(const std::filesystem::path& Path) const
+    {
+        /// Streamed, a million node board would not fit comfortably as a YAML::Node tree
+        std::ofstream File { Path };
+        if (!File)
+            return false;
+
+        YAML::Emitter Out { File };
+        Out << YAML::BeginMap << YAML::Key << "Nodes" << YAML::Value << YAML::BeginSeq;
+        for (const auto& Node : m_Nodes) {
+            Out << YAML::BeginMap;
+            Out << YAML::Key << "ID" << YAML::Value << std::string { Node.Name };
+            Out << YAML::Key << "pos" << YAML::Value << YAML::Flow << YAML::BeginSeq << Node.Position[0] << Node.Position[1] << YAML::EndSeq;
+            Out << YAML::Key << "header_color" << YAML::Value << SBoardNode { }.HeaderColor;
+            Out << YAML::Key << "salt" << YAML::Value << Node.Salt;
+            if (!Node.Ext.empty())
+                Out << YAML::Key << "Ext" << YAML::Value << Node.Ext;
+            Out << YAML::EndMap;
+        }
+        Out << YAML::EndSeq;
+
+        if (!m_Links.empty()) {
+            Out << YAML::Key << "Links" << YAML::Value << YAML::BeginSeq;
+            for (const auto& [Output, Input] : m_Links)
+                Out << YAML::Flow << YAML::BeginSeq << Output << Input << YAML::EndSeq;
+            Out << YAML::EndSeq;
+        }
+
+        Out << YAML::EndMap;
+        File << '\n';
+        return Out.good() && File.good();
+    }
+
+private:
+    [[nodiscard]] uint64_t PinIdOf(const size_t Node, const uint32_t Pin) const noexcept { return m_Nodes[Node].PinIds[Pin]; }
+
+    /// The loader seeds a 32-bit mt19937 with the salt, two salts sharing their low bits would
+    /// repeat every pin id. Rare for a hand-made board, certain somewhere in a million nodes
+    uint64_t NextSalt()
+    {
+        while (true) {
+            const auto Salt = m_Salt();
+            if (m_UsedSeeds.insert(static_cast<uint32_t>(Salt)).second)
+                return Salt;
+        }
+    }
+
+    const CCustomNodeLoader& m_Loader;
+
+    std::mt19937_64 m_Salt;
+    std::unordered_set<uint32_t> m_UsedSeeds;
+
+    std::unordered_map<std::string, SNodeLayout> m_Layouts;
+
+    std::vector<SGeneratedNode> m_Nodes;
+    std::vector<std::pair<uint64_t, uint64_t>> m_Links;
+};
+
+// =========================================================================
+// TOPOLOGIES
+// =========================================================================
+
+/// Entrance -> Printing <- To String <- Result, so running the board pulls the whole data graph once
+void AddDataSink(CBoardGenerator& Generator, const size_t Result)
+{
+    const int Depth = Generator[Result].Depth;
+
+    const auto Convert = Generator.AddNode(NodeName::ToString, { }, Depth + 1);
+    const auto Entrance = Generator.AddNode(EntranceNodeName, { }, Depth + 1);
+    const auto Printer = Generator.AddNode(NodeName::Printing, { }, Depth + 2);
+
+    Generator.LinkData(Result, Convert, 0);
+    Generator.LinkData(Convert, Printer, 0);
+    Generator.LinkFlow(Entrance, 0, Printer);
+}
+
+void BuildChain(CBoardGenerator& Generator, const SGenerateOptions& Options)
+{
+    /// Wrapped into rows so the board stays viewable
+    constexpr int RowLength = 64;
+
+    auto Previous = Generator.AddNode(EntranceNodeName, { });
+    for (size_t i = 1; i < Options.NodeCount; ++i) {
+        const auto Step = Generator.AddNode(NodeName::Step, std::string { StepExt });
+        Generator.LinkFlow(Previous, 0, Step);
+        Previous = Step;
+    }
+
+    for (size_t i = 0; i < Generator.GetNodeCount(); ++i)
+        Generator[i].Position = { static_cast<float>(i % RowLength) * 260, static_cast<float>(i / RowLength) * 140 };
+}
+
+void BuildTree(CBoardGenerator& Generator, const SGenerateOptions& Options)
+{
+    /// A full binary tree with L leaves has 2L - 1 nodes
+    std::vector<size_t> Level;
+    for (size_t i = 0; i < std::max<size_t>(2, (Options.NodeCount + 1) / 2); ++i)
+        Level.push_back(Generator.AddNode(NodeName::Value, std::string { ValueExt }));
+
+    for (int Depth = 1; Level.size() > 1; ++Depth) {
+        std::vector<size_t> Next;
+        for (size_t i = 0; i + 1 < Level.size(); i += 2) {
+            const auto Math = Generator.AddNode(Options.MathNode, { }, Depth);
+            Generator.LinkData(Level[i], Math, 0);
+            Generator.LinkData(Level[i + 1], Math, 1);
+            Next.push_back(Math);
+        }
+
+        /// The odd one out is carried to the next level
+        if (Level.size() % 2 == 1)
+            Next.push_back(Level.back());
+        Level = std::move(Next);
+    }
+
+    AddDataSink(Generator, Level.front());
+    Generator.LayoutByDepth();
+}
+
+void BuildDiamond(CBoardGenerator& Generator, const SGenerateOptions& Options)
+{
+    auto Top = Generator.AddNode(NodeName::Value, std::string { ValueExt });
+    for (size_t i = 0; i < std::max<size_t>(1, Options.NodeCount / 3); ++i) {
+        const int Depth = Generator[Top].Depth;
+
+        const auto Left = Generator.AddNode(Options.MathNode, { }, Depth + 1);
+        const auto Right = Generator.AddNode(Options.MathNode, { }, Depth + 1);
+        const auto Bottom = Generator.AddNode(Options.MathNode, { }, Depth + 2);
+
+        for (const auto Side : { Left, Right }) {
+            Generator.LinkData(Top, Side, 0);
+            Generator.LinkData(Top, Side, 1);
+        }
+        Generator.LinkData(Left, Bottom, 0);
+        Generator.LinkData(Right, Bottom, 1);
+
+        Top = Bottom;
+    }
+
+    AddDataSink(Generator, Top);
+    Generator.LayoutByDepth();
+}
+
+void BuildRandomDag(CBoardGenerator& Generator, const SGenerateOptions& Options)
+{
+    /// Reading only recent producers keeps the graph deep instead of logarithmic
+    constexpr size_t Window = 64;
+
+    std::mt19937_64 rng(Options.Seed);
+
+    std::vector<size_t> Producers;
+    for (size_t i = 0; i < std::max<size_t>(2, Options.NodeCount / 8); ++i)
+        Producers.push_back(Generator.AddNode(NodeName::Value, std::string { ValueExt }));
+
+    while (Generator.GetNodeCount() < Options.NodeCount) {
+        std::uniform_int_distribution<size_t> Pick(Producers.size() > Window ? Producers.size() - Window : 0, Producers.size() - 1);
+        const auto Lhs = Producers[Pick(rng)];
+        const auto Rhs = Producers[Pick(rng)];
+
+        const auto Math = Generator.AddNode(Options.MathNode, { }, std::max(Generator[Lhs].Depth, Generator[Rhs].Depth) + 1);
+        Generator.LinkData(Lhs, Math, 0);
+        Generator.LinkData(Rhs, Math, 1);
+        Producers.push_back(Math);
+    }
+
+    /// Producers nothing reads from stay on the board as dead nodes, like a real edited board
+    AddDataSink(Generator, Producers.back());
+    Generator.LayoutByDepth();
+}
+
+void BuildWide(CBoardGenerator& Generator, const SGenerateOptions& Options)
+{
+    std::vector<size_t> Level;
+    for (size_t i = 0; i < Options.NodeCount; ++i)
+        Level.push_back(Generator.AddNode(NodeName::Step, std::string { StepExt }));
+
+    /// Sequence nodes are built bottom up, depth counts down towards the entrance
+    for (int Depth = -1; Level.size() > 1; --Depth) {
+        std::vector<size_t> Next;
+        for (size_t Begin = 0; Begin < Level.size(); Begin += Options.Fanout) {
+            const auto End = std::min<size_t>(Begin + Options.Fanout, Level.size());
+
+            std::string Ext;
+            Ext.push_back(static_cast<char>(End - Begin));
+            if (Options.Parallel)
+                Ext.push_back(static_cast<char>(1));
+
+            const auto Sequence = Generator.AddNode(NodeName::Sequence, std::move(Ext), Depth);
+            for (size_t i = Begin; i < End; ++i)
+                Generator.LinkFlow(Sequence, i - Begin, Level[i]);
+            Next.push_back(Sequence);
+        }
+        Level = std::move(Next);
+    }
+
+    const auto Entrance = Generator.AddNode(EntranceNodeName, { }, Generator[Level.front()].Depth - 1);
+    Generator.LinkFlow(Entrance, 0, Level.front());
+    Generator.LayoutByDepth();
+}
+
+/// Every node type the topology uses must come from a loaded extension and have the pins it is wired by
+bool ValidateNodeTypes(CBoardGenerator& Generator, const SGenerateOptions& Options)
+{
+    const auto Require = [&Generator](const std::string_view Name, const std::string_view Ext, const size_t FlowIn, const size_t FlowOut, const size_t DataIn, const size_t DataOut) {
+        const auto* Layout = Generator.GetLayout(Name, Ext);
+        if (Layout == nullptr) {
+            spdlog::error("Node \"{}\" is not provided by any loaded extension", Name);
+            return false;
+        }
+
+        if (Layout->FlowInputs.size() < FlowIn || Layout->FlowOutputs.size() < FlowOut || Layout->DataInputs.size() < DataIn || Layout->DataOutputs.size() < DataOut) {
+            spdlog::error("Node \"{}\" lacks the pins the topology needs", Name);
+            return false;
+        }
+
+        return true;
+    };
+
+    switch (Options.Topology) {
+    case ETopology::Chain:
+        return Require(EntranceNodeName, { }, 0, 1, 0, 0) && Require(NodeName::Step, StepExt, 1, 1, 0, 0);
+    case ETopology::Wide:
+        return Require(EntranceNodeName, { }, 0, 1, 0, 0) && Require(NodeName::Step, StepExt, 1, 0, 0, 0)
+            && Require(NodeName::Sequence, std::string(1, static_cast<char>(Options.Fanout)), 1, Options.Fanout, 0, 0);
+    case ETopology::Tree:
+    case ETopology::Diamond:
+    case ETopology::RandomDag:
+        return Require(EntranceNodeName, { }, 0, 1, 0, 0) && Require(NodeName::Printing, { }, 1, 0, 1, 0)
+            && Require(NodeName::ToString, { }, 0, 0, 1, 1) && Require(NodeName::Value, ValueExt, 0, 0, 0, 1)
+            && Require(Options.MathNode, { }, 0, 0, 2, 1);
+    }
+
+    return false;
+}
+}
+
+int main(const int Argc, char** Argv)
+{
+    const auto Options = ParseArguments(Argc, Argv);
+    if (!Options) {
+        PrintUsage();
+        return UsageError;
+    }
+
+    const CCustomNodeLoader Loader { Options->ExtDir, nullptr };
+    CBoardGenerator Generator { Loader, Options->Seed };
+
+    if (!ValidateNodeTypes(Generator, *Options))
+        return LoadError;
+
+    switch (Options->Topology) {
+    case ETopology::Chain:
+        BuildChain(Generator, *Options);
+        break;
+    case ETopology::Tree:
+        BuildTree(Generator, *Options);
+        break;
+    case ETopology::Diamond:
+        BuildDiamond(Generator, *Options);
+        break;
+    case ETopology::RandomDag:
+        BuildRandomDag(Generator, *Options);
+        break;
+    case ETopology::Wide:
+        BuildWide(Generator, *Options);
+        break;
+    }
+
+    if (!Generator.Write(Options->Board)) {
+        spdlog::error("Failed to write {}", Options->Board.string());
+        return WriteError;
+    }
+
+    spdlog::info("Generated {} nodes into {}", Generator.GetNodeCount(), Options->Board.string());
+    return Success;
+}
\ No newline at end of file
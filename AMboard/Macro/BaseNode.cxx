@@ -5,25 +5,464 @@
 #include "BaseNode.hxx"
 
 #include "DataPin.hxx"
+#include "ExecutionManager.hxx"
+#include "GraphTransaction.hxx"
+#include "WorkStealingPool.hxx"
+
+#include <cstdint>
+#include <unordered_set>
+#include <utility>
+
+namespace {
+template <typename Fn>
+void ForEachDataUpstream(const CBaseNode* Node, Fn&& Func)
+{
+    for (const auto& IPin : Node->GetInputPins()) {
+        if (*IPin == EPinType::Data && *IPin) {
+            if (auto* Upstream = IPin->GetTheOnlyConnected()->GetOwner(); *Upstream == ENodeType::Data)
+                Func(Upstream);
+        }
+    }
+}
+
+template <typename Fn>
+void ForEachDataDownstream(const CBaseNode* Node, Fn&& Func)
+{
+    for (const auto& OPin : Node->GetOutputPins()) {
+        if (*OPin == EPinType::Data) {
+            for (const auto* ConnectedPin : OPin->GetConnections())
+                if (auto* Downstream = ConnectedPin->GetOwner(); *Downstream == ENodeType::Data)
+                    Func(Downstream);
+        }
+    }
+}
+
+/// Data nodes reachable from Start (included) in one direction, only crossing nodes whose order passes Filter
+template <bool IsDownstream>
+std::vector<CBaseNode*> CollectRegion(CBaseNode* Start, auto&& Filter)
+{
+    std::vector<CBaseNode*> Region { Start };
+    std::unordered_set<const CBaseNode*> Visited { Start };
+
+    const auto Visit = [&](CBaseNode* Node) {
+        if (Filter(Node->GetTopologicalOrder()) && Visited.insert(Node).second)
+            Region.push_back(Node);
+    };
+
+    for (size_t Index = 0; Index < Region.size(); ++Index) {
+        if constexpr (IsDownstream)
+            ForEachDataDownstream(Region[Index], Visit);
+        else
+            ForEachDataUpstream(Region[Index], Visit);
+    }
+
+    return Region;
+}
+
+/// Scratch space of one upstream walk, kept by the thread for its later walks so a refresh does not allocate
+struct SUpstreamWalk {
+    std::vector<CBaseNode*> Closure;
+    std::vector<CBaseNode*> Stack;
+
+    /// True the first time Node is seen during this walk
+    bool Visit(const CBaseNode* Node)
+    {
+        if ((m_UsedSlots.size() + 1) * 2 > m_Slots.size())
+            Grow();
+
+        const size_t Mask = m_Slots.size() - 1;
+        for (size_t Slot = SlotOf(Node) & Mask;; Slot = (Slot + 1) & Mask) {
+            if (m_Slots[Slot] == Node)
+                return false;
+            if (m_Slots[Slot] == nullptr) {
+                m_Slots[Slot] = Node;
+                m_UsedSlots.push_back(Slot);
+                return true;
+            }
+        }
+    }
+
+    /// Only the slots taken are cleared, a thread that once walked a large closure does not pay for it on every walk
+    void Reset() noexcept
+    {
+        for (const auto Slot : m_UsedSlots)
+            m_Slots[Slot] = nullptr;
+        m_UsedSlots.clear();
+        Closure.clear();
+        Stack.clear();
+    }
+
+private:
+    static size_t SlotOf(const CBaseNode* Node) noexcept
+    {
+        /// Pooled nodes are aligned, Fibonacci hashing spreads the upper bits down
+        return static_cast<size_t>((reinterpret_cast<uintptr_t>(Node) * 0x9E3779B97F4A7C15ull) >> 32);
+    }
+
+    void Grow()
+    {
+        std::vector<const CBaseNode*> Visited;
+        Visited.reserve(m_UsedSlots.size());
+        for (const auto Slot : m_UsedSlots)
+            Visited.push_back(m_Slots[Slot]);
+
+        m_Slots.assign(std::max<size_t>(m_Slots.size() * 2, 64), nullptr);
+        m_UsedSlots.clear();
+        for (const auto* Node : Visited)
+            Visit(Node);
+    }
+
+    /// Open addressing with linear probing, the size is a power of two
+    std::vector<const CBaseNode*> m_Slots;
+    std::vector<size_t> m_UsedSlots;
+};
+
+/// Walks nest, e.g. a shared node refreshes the node it shares with from inside another walk, each level leases its own scratch
+class CUpstreamWalkLease {
+public:
+    CUpstreamWalkLease()
+    {
+        if (auto& Free = FreeWalks(); !Free.empty()) {
+            m_Walk = std::move(Free.back());
+            Free.pop_back();
+        } else {
+            m_Walk = std::make_unique<SUpstreamWalk>();
+        }
+    }
+
+    ~CUpstreamWalkLease()
+    {
+        m_Walk->Reset();
+        FreeWalks().push_back(std::move(m_Walk));
+    }
+
+    CUpstreamWalkLease(const CUpstreamWalkLease&) = delete;
+    CUpstreamWalkLease& operator=(const CUpstreamWalkLease&) = delete;
+
+    SUpstreamWalk* operator->() const noexcept { return m_Walk.get(); }
+
+private:
+    static std::vector<std::unique_ptr<SUpstreamWalk>>& FreeWalks() noexcept
+    {
+        thread_local std::vector<std::unique_ptr<SUpstreamWalk>> Free;
+        return Free;
+    }
+
+    std::unique_ptr<SUpstreamWalk> m_Walk;
+};
+}
 
 void CBaseNode::PrepareInputPin() noexcept
+{
+    if (m_InputPrepared)
+        return;
+
+    AMB_PROFILE_NODE(*this, PrepareInput);
+    RefreshUpstream(m_RefreshEpoch.load(std::memory_order_relaxed));
+    AssignInputPins();
+}
+
+void CBaseNode::RefreshUpstream(const uint64_t Epoch) noexcept
+{
+    const auto ForEachUpstream = [this](auto&& Func) {
+        for (const auto& IPin : m_InputPins) {
+            if (*IPin == EPinType::Data && *IPin) {
+                /// If data node, refresh (skipped when nothing upstream changed)
+                if (auto* Upstream = IPin->GetTheOnlyConnected()->GetOwner(); *Upstream == ENodeType::Data)
+                    Func(Upstream);
+            }
+        }
+    };
+
+    /// Only worth going wide if more than one upstream has real work to do this epoch.
+    /// Another flow may be refreshing a shared producer, its epoch and dirty flag are only stable under its lock
+    const auto IsWorthOffloading = [Epoch](CBaseNode* Upstream) {
+        if (!Upstream->m_IsSubgraphThreadSafe.load(std::memory_order_relaxed))
+            return false;
+
+        std::lock_guard Lock { Upstream->m_RefreshMutex };
+        return (Epoch == 0 || Upstream->m_RefreshEpoch.load(std::memory_order_relaxed) != Epoch) && (Upstream->m_Dirty.load(std::memory_order_relaxed) || Upstream->m_IsSubgraphVolatile.load(std::memory_order_relaxed));
+    };
+
+    auto* Pool = m_Manager ? m_Manager->GetWorkerPool() : nullptr;
+
+    size_t Offloadable = 0;
+    if (Pool != nullptr)
+        ForEachUpstream([&](CBaseNode* Upstream) { Offloadable += IsWorthOffloading(Upstream); });
+
+    if (Offloadable < 2) {
+        /// Nodes outside a manager have no maintained order, they keep the recursive walk
+        if (m_Manager == nullptr)
+            ForEachUpstream([Epoch](CBaseNode* Upstream) { Upstream->Refresh(Epoch); });
+        else
+            RefreshUpstreamInOrder(Epoch);
+        return;
+    }
+
+    CWorkStealingPool::CTaskGroup Group { *Pool };
+    ForEachUpstream([&](CBaseNode* Upstream) {
+        /// Keep the last one for ourselves instead of idling in the join
+        if (IsWorthOffloading(Upstream) && Offloadable-- > 1)
+            Group.Run([Upstream, Epoch] { Upstream->Refresh(Epoch); });
+        else
+            Upstream->Refresh(Epoch);
+    });
+    Group.Wait();
+}
+
+void CBaseNode::AssignInputPins() noexcept
 {
     for (const auto& IPin : m_InputPins) {
-        if (*IPin == EPinType::Data && *IPin) {
-            const auto* ConnectedPin = IPin->GetTheOnlyConnected();
-            /// If data node, refresh
-            if (auto* ConnectedOwner = ConnectedPin->GetOwner(); *ConnectedOwner == ENodeType::Data)
-                ConnectedOwner->Evaluate();
+        if (*IPin == EPinType::Data && *IPin)
+            IPin->As<CDataPin>()->Assign(IPin->GetTheOnlyConnected()->As<CDataPin>());
+    }
+}
+
+void CBaseNode::EvaluatePrepared() noexcept
+{
+    if (auto* SharedWith = m_SharedWith.load(std::memory_order_acquire); SharedWith != nullptr) {
+        EvaluateShared(*SharedWith);
+        return;
+    }
+
+    m_InputPrepared = true;
+    {
+        AMB_PROFILE_NODE(*this, Evaluate);
+        m_Dirty.store(!Evaluate(), std::memory_order_relaxed);
+    }
+    m_InputPrepared = false;
+    ++m_Version;
+}
+
+void CBaseNode::EvaluateShared(CBaseNode& SharedWith) noexcept
+{
+    /// Same sources as ours, everything it pulls is already current this epoch
+    SharedWith.Refresh(m_RefreshEpoch.load(std::memory_order_relaxed));
+    m_Dirty.store(SharedWith.IsDirty(), std::memory_order_relaxed);
+
+    if (m_SharedVersion == SharedWith.m_Version)
+        return;
+    m_SharedVersion = SharedWith.m_Version;
+
+    for (size_t Index = 0; Index < m_OutputPins.size(); ++Index)
+        if (*m_OutputPins[Index] == EPinType::Data)
+            m_OutputPins[Index]->As<CDataPin>()->Assign(SharedWith.m_OutputPins[Index]->As<CDataPin>());
+    ++m_Version;
+}
+
+void CBaseNode::RefreshUpstreamInOrder(const uint64_t Epoch) noexcept
+{
+    /// Nodes already refreshed this epoch are still waited on, but their own upstream is not revisited
+    const CUpstreamWalkLease Walk;
+    auto& Closure = Walk->Closure;
+    auto& Stack = Walk->Stack;
+
+    ForEachDataUpstream(this, [&](CBaseNode* Upstream) { Stack.push_back(Upstream); });
+    while (!Stack.empty()) {
+        auto* Node = Stack.back();
+        Stack.pop_back();
+
+        if (!Walk->Visit(Node))
+            continue;
+
+        /// Folded outputs stay valid until an edit upstream marks the node dirty
+        if (Node->IsFolded() && !Node->IsDirty())
+            continue;
+
+        Closure.push_back(Node);
+        if (Epoch == 0 || Node->m_RefreshEpoch.load(std::memory_order_relaxed) != Epoch)
+            ForEachDataUpstream(Node, [&](CBaseNode* Upstream) { Stack.push_back(Upstream); });
+    }
+
+    std::ranges::sort(Closure, { }, &CBaseNode::m_TopologicalOrder);
+    for (auto* Node : Closure)
+        Node->RefreshInOrder(Epoch);
+}
+
+bool CBaseNode::PrefetchUpstream(const uint64_t Epoch, const bool IncludeVolatile) noexcept
+{
+    /// Our own epoch belongs to whatever step runs us right now, only upstream is touched
+    bool IsSelfContained = true;
+    const CUpstreamWalkLease Walk;
+    auto& Stack = Walk->Stack;
+
+    ForEachDataUpstream(this, [&](CBaseNode* Upstream) { Stack.push_back(Upstream); });
+    while (!Stack.empty()) {
+        auto* Node = Stack.back();
+        Stack.pop_back();
 
-            IPin->As<CDataPin>()->Assign(ConnectedPin->As<CDataPin>());
+        if (!Walk->Visit(Node) || (Node->IsFolded() && !Node->IsDirty()))
+            continue;
+
+        for (const auto& IPin : Node->m_InputPins)
+            if (*IPin == EPinType::Data && *IPin && *IPin->GetTheOnlyConnected()->GetOwner() != ENodeType::Data)
+                IsSelfContained = false;
+
+        /// A volatile result taken now would be stale by the time the step runs, only what feeds it is worth having ready.
+        /// Refreshing a node covers its whole upstream, the walk below only finds the nodes left out and execute node sources
+        if (IncludeVolatile || !Node->m_IsSubgraphVolatile.load(std::memory_order_relaxed))
+            Node->Refresh(Epoch);
+
+        ForEachDataUpstream(Node, [&](CBaseNode* Upstream) { Stack.push_back(Upstream); });
+    }
+
+    return IsSelfContained;
+}
+
+void CBaseNode::RefreshInOrder(const uint64_t Epoch) noexcept
+{
+    std::lock_guard Lock { m_RefreshMutex };
+
+    if (Epoch != 0 && m_RefreshEpoch.load(std::memory_order_relaxed) == Epoch)
+        return;
+    m_RefreshEpoch.store(Epoch, std::memory_order_relaxed);
+
+    RefreshPrepared();
+}
+
+void CBaseNode::SetManager(CExecutionManager* Manager) noexcept
+{
+    m_Manager = Manager;
+    m_TopologicalOrder = Manager != nullptr ? Manager->AcquireTopologicalOrder() : 0;
+}
+
+bool CBaseNode::CanFeed(const CBaseNode* Upstream, const CBaseNode* Downstream)
+{
+    /// Only data nodes pull recursively, a loop through an execute node is fine
+    if (*Upstream != ENodeType::Data || *Downstream != ENodeType::Data)
+        return true;
+
+    if (Upstream == Downstream)
+        return false;
+
+    /// Order 0 means not registered yet, such a node's place is unknown and the whole downstream is searched
+    const auto Bound = Upstream->m_TopologicalOrder;
+    if (Bound == 0 || Downstream->m_TopologicalOrder == 0) {
+        const auto Region = CollectRegion<true>(const_cast<CBaseNode*>(Downstream), [](uint64_t) { return true; });
+        return std::ranges::find(Region, Upstream) == Region.end();
+    }
+
+    /// Already in order, no cycle possible
+    if (Bound < Downstream->m_TopologicalOrder)
+        return true;
+
+    /// Any path from Downstream to Upstream only crosses orders up to Upstream's
+    const auto Region = CollectRegion<true>(const_cast<CBaseNode*>(Downstream), [Bound](const uint64_t Order) { return Order <= Bound; });
+    return std::ranges::find(Region, Upstream) == Region.end();
+}
+
+void CBaseNode::OrderAfterConnect(CBaseNode* Upstream, CBaseNode* Downstream)
+{
+    if (*Upstream != ENodeType::Data || *Downstream != ENodeType::Data)
+        return;
+
+    const auto Lower = Downstream->m_TopologicalOrder;
+    const auto Upper = Upstream->m_TopologicalOrder;
+    if (Lower == 0 || Upper < Lower)
+        return;
+
+    /// Downstream and what follows it within the affected region must move behind Upstream and what precedes it
+    auto Forward = CollectRegion<true>(Downstream, [Upper](const uint64_t Order) { return Order < Upper; });
+    auto Backward = CollectRegion<false>(Upstream, [Lower](const uint64_t Order) { return Order > Lower; });
+
+    std::ranges::sort(Forward, { }, &CBaseNode::m_TopologicalOrder);
+    std::ranges::sort(Backward, { }, &CBaseNode::m_TopologicalOrder);
+
+    std::vector<uint64_t> Orders;
+    Orders.reserve(Forward.size() + Backward.size());
+    for (const auto* Node : Backward)
+        Orders.push_back(Node->m_TopologicalOrder);
+    for (const auto* Node : Forward)
+        Orders.push_back(Node->m_TopologicalOrder);
+    std::ranges::sort(Orders);
+
+    auto OrderIt = Orders.begin();
+    for (auto* Node : Backward)
+        Node->m_TopologicalOrder = *OrderIt++;
+    for (auto* Node : Forward)
+        Node->m_TopologicalOrder = *OrderIt++;
+}
+
+std::unique_ptr<CBaseNode, CBaseNode::DestroyFunc> CBaseNode::Duplicate() const
+{
+    if (m_Create == nullptr || m_Destroy == nullptr)
+        return { nullptr, nullptr };
+
+    std::unique_ptr<CBaseNode, DestroyFunc> Copy { m_Create(), m_Destroy };
+
+    /// Ext may add pins, so values are copied after it
+    std::string ExtContext;
+    WriteExtraContext(ExtContext);
+    if (!ExtContext.empty())
+        Copy->ReadExtraContext(ExtContext);
+
+    for (size_t Index = 0; Index < std::min(m_InputPins.size(), Copy->m_InputPins.size()); ++Index) {
+        const auto& IPin = m_InputPins[Index];
+        if (*IPin == EPinType::Data && !*IPin && *Copy->m_InputPins[Index] == EPinType::Data)
+            Copy->m_InputPins[Index]->As<CDataPin>()->Assign(IPin->As<CDataPin>());
+    }
+
+    return Copy;
+}
+
+CWorkStealingPool* CBaseNode::GetWorkerPool() const noexcept
+{
+    return m_Manager != nullptr ? m_Manager->GetWorkerPool() : nullptr;
+}
+
+void CBaseNode::NotifyPinAdded(CPin* Pin) noexcept
+{
+    if (auto* Transaction = CGraphTransaction::Find(m_Manager); Transaction != nullptr && Transaction->Defer(Pin, nullptr, true, &DispatchPinChange))
+        return;
+
+    DispatchPinChange(Pin, nullptr, true);
+}
+
+void CBaseNode::NotifyPinRemoved(std::unique_ptr<CPin> Pin) noexcept
+{
+    auto* Transaction = CGraphTransaction::Find(m_Manager);
+
+    /// A dying node can't wait for the commit, nor can its listeners
+    if (Transaction != nullptr && !m_IsDestructing) {
+        Pin->DisconnectPins();
+        if (Transaction->Defer(Pin.get(), nullptr, false, &DispatchPinChange)) {
+            m_ErasedPins.emplace_back(std::move(Pin));
+            return;
         }
     }
+
+    /// Anything still pending on the pin, its own addition included, comes first
+    if (Transaction != nullptr)
+        Transaction->Flush(Pin.get());
+    DispatchPinChange(Pin.get(), nullptr, false);
+}
+
+void CBaseNode::DispatchPinChange(CPin* Pin, CPin*, const bool NewPin) noexcept
+{
+    auto* Owner = Pin->GetOwner();
+    for (const auto& Func : Owner->m_OnPinChanges)
+        Func(Pin, NewPin);
+
+    if (!NewPin)
+        std::erase_if(Owner->m_ErasedPins, [Pin](const auto& Erased) { return Erased.get() == Pin; });
 }
 
+#ifdef AMB_ENABLE_PROFILER
+CProfiler* CBaseNode::GetProfiler() const noexcept
+{
+    return m_Manager != nullptr ? m_Manager->GetProfiler() : nullptr;
+}
+#endif
+
 CBaseNode::~CBaseNode()
 {
     m_IsDestructing = true;
 
+    /// Removals still held back by a transaction are delivered while our listeners are alive
+    if (auto* Transaction = CGraphTransaction::Find(m_Manager))
+        for (const auto Erased = std::exchange(m_ErasedPins, { }); const auto& Pin : Erased)
+            Transaction->Flush(Pin.get());
+
     while (!m_InputPins.empty())
         ErasePin(m_InputPins.front().get());
     while (!m_OutputPins.empty())
@@ -34,4 +473,71 @@ bool CBaseNode::Evaluate() noexcept
 {
     PrepareInputPin();
     return true;
-}
\ No newline at end of file
+}
+
+void CBaseNode::Refresh(const uint64_t Epoch) noexcept
+{
+    /// Shared producers of a diamond can be pulled from several workers at once
+    std::lock_guard Lock { m_RefreshMutex };
+
+    if (Epoch != 0 && m_RefreshEpoch.load(std::memory_order_relaxed) == Epoch)
+        return;
+    m_RefreshEpoch.store(Epoch, std::memory_order_relaxed);
+
+    if (IsFolded() && !IsDirty())
+        return;
+
+    RefreshUpstream(Epoch);
+    RefreshPrepared();
+}
+
+void CBaseNode::RefreshPrepared() noexcept
+{
+    bool IsStale = IsDirty() || m_IsVolatile;
+    bool IsSubgraphThreadSafe = m_IsThreadSafe;
+    bool IsSubgraphVolatile = m_IsVolatile;
+    for (const auto& IPin : m_InputPins) {
+        if (*IPin == EPinType::Data && *IPin) {
+            const auto* Upstream = IPin->GetTheOnlyConnected()->GetOwner();
+            if (*Upstream == ENodeType::Data) {
+                IsSubgraphThreadSafe &= Upstream->m_IsSubgraphThreadSafe.load(std::memory_order_relaxed);
+                IsSubgraphVolatile |= Upstream->m_IsSubgraphVolatile.load(std::memory_order_relaxed);
+            }
+
+            /// Upstream reproduced its outputs since we last pulled them
+            IsStale |= IPin->As<CDataPin>()->GetSourceVersion() != Upstream->GetVersion();
+        }
+    }
+
+    m_IsSubgraphThreadSafe.store(IsSubgraphThreadSafe, std::memory_order_relaxed);
+    m_IsSubgraphVolatile.store(IsSubgraphVolatile, std::memory_order_relaxed);
+
+    if (!IsStale)
+        return;
+
+    AssignInputPins();
+    EvaluatePrepared();
+}
+
+void CBaseNode::MarkDirty() noexcept
+{
+    {
+        /// A refresh in progress finishes first, it would otherwise clear the flag again with outputs from the old inputs
+        std::lock_guard Lock { m_RefreshMutex };
+
+        /// Dirty nodes already have their downstream invalidated
+        if (IsDirty() || m_IsDestructing)
+            return;
+
+        m_Dirty.store(true, std::memory_order_relaxed);
+        m_RefreshEpoch.store(0, std::memory_order_relaxed);
+    }
+
+    /// Not holding our lock, a downstream node may be refreshing and about to pull from us
+    for (const auto& OPin : m_OutputPins) {
+        if (*OPin == EPinType::Data) {
+            for (auto* ConnectedPin : OPin->GetConnections())
+                ConnectedPin->GetOwner()->MarkDirty();
+        }
+    }
+}
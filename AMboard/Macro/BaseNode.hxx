@@ -10,10 +10,16 @@
 
 #include "MacroDefines.hxx"
 #include "Pin.hxx"
+#include "Profiler.hxx"
 
 #include <algorithm>
+#include <atomic>
+#include <mutex>
 #include <string>
 
+class CExecutionManager;
+class CWorkStealingPool;
+
 enum class ENodeType {
     Data,
     Execution
@@ -24,7 +30,35 @@ class MACRO_API CBaseNode {
 protected:
     virtual void PrepareInputPin() noexcept;
 
+    /// Refresh all upstream data nodes within Epoch, independent ones are spread over the manager's worker pool
+    void RefreshUpstream(uint64_t Epoch) noexcept;
+
+    /// Manager's pool for CDataPin::SetAsync producers, null outside a manager
+    [[nodiscard]] CWorkStealingPool* GetWorkerPool() const noexcept;
+    void AssignInputPins() noexcept;
+
+    /// Evaluate with input pins already assigned by the caller
+    void EvaluatePrepared() noexcept;
+    /// Take over the outputs of SharedWith, refreshing it first
+    void EvaluateShared(CBaseNode& SharedWith) noexcept;
+
+    /// Refresh the whole upstream data closure by walking the maintained topological order, no recursion
+    void RefreshUpstreamInOrder(uint64_t Epoch) noexcept;
+    /// Like Refresh, but everything upstream is already current
+    void RefreshInOrder(uint64_t Epoch) noexcept;
+    /// Staleness check and evaluation once every upstream is current
+    void RefreshPrepared() noexcept;
+
+    /// Called right after a pin was added or erased, before listeners that an open transaction may hold back
+    virtual void OnPinsChanged() noexcept { }
+    /// Fire m_OnPinChanges, or leave it to the board's open transaction
+    void NotifyPinAdded(CPin* Pin) noexcept;
+    void NotifyPinRemoved(std::unique_ptr<CPin> Pin) noexcept;
+    static void DispatchPinChange(CPin* Pin, CPin* Other, bool NewPin) noexcept;
+
 public:
+    POOLED_ALLOCATION()
+
     CBaseNode() = default;
 
     CBaseNode(const CBaseNode&) = delete;
@@ -43,8 +77,8 @@ public:
     PinTy* EmplacePin(const bool IsInput)
     {
         auto* Result = static_cast<PinTy*>((IsInput ? m_InputPins : m_OutputPins).emplace_back(std::make_unique<PinTy>(this, IsInput)).get());
-        for (const auto& Func : m_OnPinChanges)
-            Func(Result, true);
+        OnPinsChanged();
+        NotifyPinAdded(Result);
         return Result;
     }
 
@@ -58,11 +92,11 @@ public:
         auto& Pins = PinPtr->IsInputPin() ? m_InputPins : m_OutputPins;
         if (auto It = std::ranges::find_if(Pins, [PinPtr](auto&& Pin) { return Pin.get() == static_cast<const CPin*>(PinPtr); }); It != Pins.end()) {
 
-            const auto PinExtracted = std::move(*It);
+            auto PinExtracted = std::move(*It);
             Pins.erase(It);
 
-            for (const auto& Func : m_OnPinChanges)
-                Func(PinExtracted.get(), false);
+            OnPinsChanged();
+            NotifyPinRemoved(std::move(PinExtracted));
 
             return true;
         }
@@ -73,6 +107,34 @@ public:
     /// return true if successful
     virtual bool Evaluate() noexcept;
 
+    /// Evaluate only if this node or anything upstream changed since the last refresh.
+    /// A node is checked at most once per epoch (one flow step), epoch 0 disables the memo
+    void Refresh(uint64_t Epoch) noexcept;
+
+    /// Invalidate the cached outputs, propagates to all downstream data nodes.
+    /// Also forgets the last refresh epoch, so results prefetched under an epoch a step takes over are redone
+    void MarkDirty() noexcept;
+
+    /// Refresh the upstream data closure under Epoch ahead of this node's step, leaving volatile parts out unless IncludeVolatile.
+    /// Returns false if the closure reads from an execute node, whose outputs may still change before the step
+    bool PrefetchUpstream(uint64_t Epoch, bool IncludeVolatile) noexcept;
+
+    [[nodiscard]] bool IsDirty() const noexcept { return m_Dirty.load(std::memory_order_relaxed); }
+    [[nodiscard]] bool IsVolatile() const noexcept { return m_IsVolatile; }
+    [[nodiscard]] bool IsPure() const noexcept { return m_IsPure; }
+    [[nodiscard]] bool IsShareable() const noexcept { return m_IsPure || m_IsShareable; }
+
+    [[nodiscard]] bool IsThreadSafe() const noexcept { return m_IsThreadSafe; }
+
+    /// Results of the last CExecutionManager::OptimizeGraph, for display
+    [[nodiscard]] bool IsFolded() const noexcept { return m_IsFolded.load(std::memory_order_relaxed); }
+    [[nodiscard]] bool IsDead() const noexcept { return m_IsDead.load(std::memory_order_relaxed); }
+    /// Node with the same structure evaluated in this one's place, null if none
+    [[nodiscard]] const CBaseNode* GetSharedWith() const noexcept { return m_SharedWith.load(std::memory_order_acquire); }
+
+    /// Bumped every time the outputs are reproduced
+    [[nodiscard]] uint64_t GetVersion() const noexcept { return m_Version; }
+
     /// Actually placed on the canvas
     virtual void Begin() noexcept { }
     /// Actually removed from the canvas
@@ -94,13 +156,47 @@ public:
         return m_OutputPins | std::views::filter([](const auto& Pin) static { return *Pin == PinTy; });
     }
 
+    /// Also hands out the node's place in the manager's topological order
+    void SetManager(CExecutionManager* Manager) noexcept;
+    [[nodiscard]] CExecutionManager* GetManager() const noexcept { return m_Manager; }
+
     virtual void WriteExtraContext(std::string& ExtContext) const { }
     virtual void ReadExtraContext(const std::string& ExtContext) { }
 
+    using CreateFunc = CBaseNode* (*)();
+    using DestroyFunc = void (*)(CBaseNode*);
+
+    /// Set by the plugin factory, the node can only be duplicated through it
+    void SetFactory(const CreateFunc Create, const DestroyFunc Destroy) noexcept
+    {
+        m_Create = Create;
+        m_Destroy = Destroy;
+    }
+
+    /// Fresh instance with the same Ext and unconnected input values, null without a factory.
+    /// Neither connected nor registered with a manager, e.g. for evaluating a subgraph on several threads at once
+    [[nodiscard]] std::unique_ptr<CBaseNode, DestroyFunc> Duplicate() const;
+
     auto AddOnPinChanges(auto&& Func) { return m_OnPinChanges.emplace_back(Func); }
 
     [[nodiscard]] operator ENodeType() const noexcept { return m_NodeType; } // NOLINT
 
+    /// Data nodes upstream of this one always have a smaller order, 0 until registered with a manager
+    [[nodiscard]] uint64_t GetTopologicalOrder() const noexcept { return m_TopologicalOrder; }
+
+    /// False if Upstream feeding Downstream would close a cycle of data nodes.
+    /// Only the region between both orders is searched (Pearce-Kelly), all of Downstream's if either is unregistered
+    [[nodiscard]] static bool CanFeed(const CBaseNode* Upstream, const CBaseNode* Downstream);
+    /// Restore the topological order after Upstream got connected to Downstream
+    static void OrderAfterConnect(CBaseNode* Upstream, CBaseNode* Downstream);
+
+#ifdef AMB_ENABLE_PROFILER
+    [[nodiscard]] const SNodeProfile& GetProfile() const noexcept { return m_Profile; }
+    void ResetProfile() noexcept { m_Profile.Reset(); }
+    /// Manager's profiler, null outside a manager
+    [[nodiscard]] CProfiler* GetProfiler() const noexcept;
+#endif
+
     template <typename NodeTy>
         requires std::is_base_of_v<CBaseNode, NodeTy>
     [[nodiscard]] NodeTy* As() noexcept
@@ -110,11 +206,63 @@ public:
 
 protected:
     ENodeType m_NodeType = ENodeType::Data;
+    CExecutionManager* m_Manager { };
+
+    /// Volatile nodes (e.g. screen capture) bypass the cache and are evaluated once per epoch
+    bool m_IsVolatile = false;
+    /// Clear to keep the node from being evaluated on the manager's worker pool
+    bool m_IsThreadSafe = true;
+    /// Set if the outputs only depend on the inputs and evaluating has no side effect, lets the optimizer fold the node
+    bool m_IsPure = false;
+    /// Set if two instances with the same Ext and sources produce the same outputs within one flow step, e.g. screen captures.
+    /// Lets the optimizer evaluate only one of them, pure nodes always qualify
+    bool m_IsShareable = false;
+
+    /// Pure and fed by constants only, once evaluated its upstream is not visited again until an edit marks it dirty.
+    /// Rewritten by OptimizeGraph while flows run, under m_RefreshMutex so a refresh in progress keeps its verdict
+    std::atomic<bool> m_IsFolded { false };
+    /// No execute node pulls from it
+    std::atomic<bool> m_IsDead { false };
+    /// Rewritten by OptimizeGraph under m_RefreshMutex, an evaluation reads it once
+    std::atomic<CBaseNode*> m_SharedWith { nullptr };
+    /// Version of m_SharedWith our outputs were last copied from
+    uint64_t m_SharedVersion = 0;
+
+    /// Written under m_RefreshMutex, upstream walks of other flows read it without the lock
+    std::atomic<bool> m_Dirty { true };
+    uint64_t m_Version = 0;
+    uint64_t m_TopologicalOrder = 0;
+    /// Data nodes only, written under m_RefreshMutex like m_Dirty; execute nodes carry their epoch in the flow's step
+    std::atomic<uint64_t> m_RefreshEpoch { 0 };
+    std::mutex m_RefreshMutex;
+
+    /// Summaries of everything upstream, updated on every refresh and read by downstream nodes without our lock
+    std::atomic<bool> m_IsSubgraphThreadSafe { false };
+    std::atomic<bool> m_IsSubgraphVolatile { false };
 
     std::vector<std::unique_ptr<CPin>> m_InputPins;
     std::vector<std::unique_ptr<CPin>> m_OutputPins;
 
-    std::list<std::function<void(CPin* TargetPin, bool NewPin)>> m_OnPinChanges;
+    std::vector<std::function<void(CPin* TargetPin, bool NewPin)>> m_OnPinChanges;
+    /// Removed while a transaction was open, alive until its listeners heard about it
+    std::vector<std::unique_ptr<CPin>> m_ErasedPins;
 
     bool m_IsDestructing = false;
+
+    CreateFunc m_Create = nullptr;
+    DestroyFunc m_Destroy = nullptr;
+
+    /// Data nodes only, set while EvaluatePrepared has already assigned all input pins
+    bool m_InputPrepared = false;
+
+#ifdef AMB_ENABLE_PROFILER
+    SNodeProfile m_Profile;
+    friend class CProfiler;
+#endif
+
+    friend class CExecutionManager;
+    friend class CExecutionPlan;
 };
+
+/// Called by MACRO_FACTORY on every new node, overloads for more derived node types set what the type implies
+inline void DeduceNodeTraits(CBaseNode*) noexcept { }
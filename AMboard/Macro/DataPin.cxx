@@ -3,9 +3,54 @@
 //
 
 #include "DataPin.hxx"
+#include "BaseNode.hxx"
+#include "WorkStealingPool.hxx"
 
 #include "Util/Assertions.hxx"
 
+CPendingData::CPendingData(std::function<std::shared_ptr<void>()> Producer)
+    : m_Producer(std::move(Producer))
+{
+}
+
+void CPendingData::Run() noexcept
+{
+    if (m_IsClaimed.exchange(true, std::memory_order_acq_rel))
+        return;
+
+    try {
+        m_Value = m_Producer();
+    } catch (...) {
+        /// Readers see a null value, same as a pin nothing was stored in
+    }
+
+    m_Producer = nullptr;
+    m_IsDone.store(true, std::memory_order_release);
+    m_Ready->Set();
+}
+
+const std::shared_ptr<void>& CPendingData::Wait() noexcept
+{
+    if (m_IsDone.load(std::memory_order_acquire)) [[likely]]
+        return m_Value;
+
+    /// Producing it here beats blocking a worker on a task still sitting in the queue
+    Run();
+    m_Ready->Wait();
+    return m_Value;
+}
+
+void CDataPin::AddPin(CPin* NewPin) noexcept
+{
+    CPin::AddPin(NewPin);
+
+    /// New source, cached value no longer valid
+    if (m_IsInputPin) {
+        CBaseNode::OrderAfterConnect(NewPin->GetOwner(), m_Owner);
+        m_Owner->MarkDirty();
+    }
+}
+
 void CDataPin::PreConnectPin(CPin* NewPin) noexcept
 {
     CPin::PreConnectPin(NewPin);
@@ -18,7 +63,11 @@ void CDataPin::PreConnectPin(CPin* NewPin) noexcept
 
 bool CDataPin::Compatible(CPin* NewPin) noexcept
 {
-    return CPin::Compatible(NewPin) && (m_IsUniversalPin || static_cast<const CDataPin*>(NewPin)->m_IsUniversalPin || m_DataType == static_cast<const CDataPin*>(NewPin)->m_DataType);
+    if (!CPin::Compatible(NewPin) || !(m_IsUniversalPin || static_cast<const CDataPin*>(NewPin)->m_IsUniversalPin || m_DataType.Id == static_cast<const CDataPin*>(NewPin)->m_DataType.Id))
+        return false;
+
+    /// Data nodes pull their inputs, a cycle among them would never finish refreshing
+    return m_IsInputPin ? CBaseNode::CanFeed(NewPin->GetOwner(), m_Owner) : CBaseNode::CanFeed(m_Owner, NewPin->GetOwner());
 }
 
 CDataPin::CDataPin(CBaseNode* Owner, const bool IsInputPin) noexcept
@@ -27,12 +76,22 @@ CDataPin::CDataPin(CBaseNode* Owner, const bool IsInputPin) noexcept
     m_PinType = EPinType::Data;
 }
 
+bool CDataPin::DisconnectPin(CPin* TargetPin) noexcept
+{
+    if (!CPin::DisconnectPin(TargetPin))
+        return false;
+
+    /// Either side could be the one initiating the disconnection
+    (m_IsInputPin ? this : TargetPin)->GetOwner()->MarkDirty();
+    return true;
+}
+
 std::string_view CDataPin::GetToolTips() const noexcept
 {
     if (CPin::GetToolTips().empty()) {
-        if (m_IsUniversalPin && m_DataType == "void")
+        if (m_IsUniversalPin && m_DataType == VoidDataType)
             return "Any";
-        return m_DataType;
+        return m_DataType.Name;
     }
 
     return CPin::GetToolTips();
@@ -40,8 +99,42 @@ std::string_view CDataPin::GetToolTips() const noexcept
 
 void CDataPin::Assign(const CDataPin* Source)
 {
-    MAKE_SURE(m_IsUniversalPin || Source->m_IsUniversalPin || m_DataType == Source->m_DataType);
+    MAKE_SURE(m_IsUniversalPin || Source->m_IsUniversalPin || m_DataType.Id == Source->m_DataType.Id);
 
     m_DataType = Source->m_DataType;
-    m_SharedData = Source->m_SharedData;
-}
\ No newline at end of file
+    m_InlineData = Source->m_InlineData;
+
+    /// Skip the refcount traffic when both already share the object, which includes trivial values
+    if (m_SharedData != Source->m_SharedData)
+        m_SharedData = Source->m_SharedData;
+    /// Stays pending, only whoever reads it waits
+    if (m_PendingData != Source->m_PendingData)
+        m_PendingData = Source->m_PendingData;
+    m_SourceVersion = Source->m_Owner->GetVersion();
+}
+
+size_t CDataPin::HashValue() const noexcept
+{
+    const std::string_view Bytes { reinterpret_cast<const char*>(m_InlineData.data()), m_InlineData.size() };
+    const auto Hash = std::hash<std::string_view> { }(Bytes) ^ m_DataType.Id;
+    const void* Shared = m_PendingData != nullptr ? static_cast<const void*>(m_PendingData.get()) : m_SharedData.get();
+    return Hash ^ (std::hash<const void*> { }(Shared) + 0x9e3779b9 + (Hash << 6) + (Hash >> 2));
+}
+
+bool CDataPin::HoldsSameValue(const CDataPin& Other) const noexcept
+{
+    return m_DataType.Id == Other.m_DataType.Id && m_InlineData == Other.m_InlineData && m_SharedData == Other.m_SharedData && m_PendingData == Other.m_PendingData;
+}
+
+void CDataPin::LaunchPending(CWorkStealingPool* Pool)
+{
+    if (Pool != nullptr)
+        Pool->Detach([Pending = m_PendingData] { Pending->Run(); });
+}
+
+#ifdef AMB_ENABLE_PROFILER
+void CDataPin::RecordOutputBytes(const uint64_t Bytes) noexcept
+{
+    CProfiler::RecordOutputBytes(*m_Owner, Bytes);
+}
+#endif
\ No newline at end of file
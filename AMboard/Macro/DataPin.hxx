@@ -4,85 +4,183 @@
 
 #pragma once
 
+#include "FlowTask.hxx"
 #include "MacroDefines.hxx"
 #include "Pin.hxx"
+#include "TypeId.hxx"
 
-#include <bit>
+#include <array>
+#include <atomic>
+#include <cassert>
+#include <cstring>
+#include <functional>
 #include <memory>
 #include <string_view>
 
-#define PinGetTrivial(Ty) TryGetTrivial<Ty>(#Ty)
-#define PinGet(Ty) Get<Ty>(#Ty)
-#define PinSet(Ty, Val) Set<Ty>(#Ty, Val)
+#define PinGetTrivial(Ty) TryGetTrivial<Ty>(MakeDataType(#Ty))
+#define PinGet(Ty) Get<Ty>(MakeDataType(#Ty))
+#define PinTryGet(Ty) TryGet<Ty>(MakeDataType(#Ty))
+#define PinSet(Ty, Val) Set<Ty>(MakeDataType(#Ty), Val)
+/// Variadic so the producer lambda may contain commas
+#define PinSetAsync(Ty, Pool, ...) SetAsync<Ty>(MakeDataType(#Ty), Pool, __VA_ARGS__)
+
+class CWorkStealingPool;
+
+/// Shared value still being produced, the first reader to find it unclaimed produces it in place instead of blocking
+class MACRO_API CPendingData {
+
+public:
+    explicit CPendingData(std::function<std::shared_ptr<void>()> Producer);
+
+    /// Claim and run the producer, no-op if someone else already did. A throwing producer leaves a null value
+    void Run() noexcept;
+
+    /// Block until produced, a throwing producer was already absorbed by Run
+    const std::shared_ptr<void>& Wait() noexcept;
+
+    [[nodiscard]] bool IsReady() const noexcept { return m_Ready->IsSet(); }
+    /// Set once produced, suspendable nodes wait on it instead of blocking
+    [[nodiscard]] const std::shared_ptr<CFlowEvent>& GetReadyEvent() const noexcept { return m_Ready; }
+
+protected:
+    std::function<std::shared_ptr<void>()> m_Producer;
+    std::shared_ptr<void> m_Value;
+    std::atomic<bool> m_IsClaimed { false };
+    /// Spares readers of a finished value the event's lock
+    std::atomic<bool> m_IsDone { false };
+    std::shared_ptr<CFlowEvent> m_Ready = std::make_shared<CFlowEvent>();
+};
 
 class MACRO_API CDataPin : public CPin {
 
 protected:
+    void AddPin(CPin* NewPin) noexcept override;
     void PreConnectPin(CPin* NewPin) noexcept override;
     bool Compatible(CPin* NewPin) noexcept override;
 
 public:
     CDataPin(CBaseNode* Owner, bool IsInputPin) noexcept;
 
+    bool DisconnectPin(CPin* TargetPin) noexcept override;
+
     std::string_view GetToolTips() const noexcept override;
 
+    /// Trivial values up to this size live inline, anything else is refcounted
+    static constexpr size_t InlineCapacity = 16;
+
     template <typename Ty>
-        requires(std::is_trivial_v<Ty> && sizeof(Ty) <= sizeof(std::ptrdiff_t))
-    Ty TryGetTrivial(const std::string_view& TyStr) const noexcept
+        requires(std::is_trivial_v<Ty> && sizeof(Ty) <= InlineCapacity)
+    Ty TryGetTrivial(const SDataType& Type) const noexcept
     {
-        if (m_DataType == TyStr) [[likely]] {
-            union {
-                void* Ptr;
-                Ty Data;
-            } Tmp { m_SharedData.get() };
-            return Tmp.Data;
+        if (m_DataType.Id == Type.Id) [[likely]] {
+            Ty Data;
+            std::memcpy(&Data, m_InlineData.data(), sizeof(Ty));
+            return Data;
         }
 
         return { };
     }
 
+    /// Null when the type differs, nothing has been stored yet or an async producer failed. Waits for a pending value
+    template <typename Ty>
+    Ty* TryGet(const SDataType& Type) const noexcept
+    {
+        if (m_DataType.Id == Type.Id) [[likely]]
+            return static_cast<Ty*>(GetSharedData().get());
+
+        return nullptr;
+    }
+
+    /// Waits for a pending value. The value must be there, values that may have failed or never been set are read with TryGet
     template <typename Ty>
-    Ty& Get(const std::string_view& TyStr) const noexcept
+    Ty& Get(const SDataType& Type) const noexcept
     {
-        if (m_DataType == TyStr) [[likely]] {
-            return *static_cast<Ty*>(m_SharedData.get());
+        if (m_DataType.Id == Type.Id) [[likely]] {
+            auto* Value = static_cast<Ty*>(GetSharedData().get());
+            assert(Value != nullptr && "no value, a SetAsync producer may have failed");
+            return *Value;
         }
 
         std::unreachable();
     }
 
+    /// True until the value set by SetAsync is produced
+    [[nodiscard]] bool IsPending() const noexcept { return m_PendingData != nullptr && !m_PendingData->IsReady(); }
+    /// Null unless the value came from SetAsync
+    [[nodiscard]] std::shared_ptr<CFlowEvent> GetReadyEvent() const noexcept { return m_PendingData != nullptr ? m_PendingData->GetReadyEvent() : nullptr; }
+
     template <typename Ty>
-        requires(std::is_trivial_v<Ty> && sizeof(Ty) <= sizeof(std::ptrdiff_t))
-    Ty Set(const std::string_view& TyStr, const Ty& NewValue) noexcept
+        requires(std::is_trivial_v<Ty> && sizeof(Ty) <= InlineCapacity)
+    Ty Set(const SDataType& Type, const Ty& NewValue) noexcept
     {
-        union {
-            void* Ptr;
-            Ty Data;
-        } Tmp { .Data = NewValue };
-
-        m_DataType = TyStr;
-        m_SharedData.reset(Tmp.Ptr, [](void*) static noexcept { });
+        UpdateValueType(Type);
+
+        /// Unused tail stays zeroed so AsDouble on narrow types is deterministic
+        m_InlineData = { };
+        std::memcpy(m_InlineData.data(), &NewValue, sizeof(Ty));
+        if (m_SharedData != nullptr) [[unlikely]]
+            m_SharedData.reset();
+        if (m_PendingData != nullptr) [[unlikely]]
+            m_PendingData.reset();
         return NewValue;
     }
 
     template <typename Ty>
-    Ty& Set(const std::string_view& TyStr, std::shared_ptr<Ty> NewValue) noexcept
+    Ty& Set(const SDataType& Type, std::shared_ptr<Ty> NewValue) noexcept
     {
-        m_DataType = TyStr;
+#ifdef AMB_ENABLE_PROFILER
+        if (!m_IsInputPin && NewValue != nullptr)
+            RecordOutputBytes(HeapSizeOf(*NewValue));
+#endif
+        UpdateValueType(Type);
         m_SharedData = std::static_pointer_cast<void>(std::move(NewValue));
+        if (m_PendingData != nullptr) [[unlikely]]
+            m_PendingData.reset();
         return *static_cast<Ty*>(m_SharedData.get());
     }
 
+    /// Type-erased counterpart of Set for nodes only moving values around
+    void SetShared(const SDataType& Type, std::shared_ptr<void> NewValue) noexcept
+    {
+        UpdateValueType(Type);
+        m_SharedData = std::move(NewValue);
+        if (m_PendingData != nullptr) [[unlikely]]
+            m_PendingData.reset();
+    }
+    /// Null for trivial values, waits for a pending one
+    [[nodiscard]] std::shared_ptr<void> GetShared() const noexcept { return GetSharedData(); }
+
+    /// Leave the value pending while Producer, returning std::shared_ptr<Ty>, runs on Pool.
+    /// Readers only wait once they actually get the value, without a pool the first of them produces it
+    template <typename Ty, typename Fn>
+        requires std::is_invocable_r_v<std::shared_ptr<Ty>, Fn&>
+    void SetAsync(const SDataType& Type, CWorkStealingPool* Pool, Fn&& Producer)
+    {
+        UpdateValueType(Type);
+        m_SharedData.reset();
+        m_PendingData = std::make_shared<CPendingData>([Producer = std::forward<Fn>(Producer)]() mutable -> std::shared_ptr<void> { return Producer(); });
+        LaunchPending(Pool);
+    }
+
     [[nodiscard]] double AsDouble() const noexcept
     {
-        return std::bit_cast<double>(m_SharedData.get());
+        double Data;
+        std::memcpy(&Data, m_InlineData.data(), sizeof(double));
+        return Data;
     }
 
     void Assign(const CDataPin* Source);
 
-    decltype(auto) SetValueType(auto&& Ty) noexcept
+    /// Identity of the held value, shared objects only compare equal by address
+    [[nodiscard]] size_t HashValue() const noexcept;
+    [[nodiscard]] bool HoldsSameValue(const CDataPin& Other) const noexcept;
+
+    /// Version of the source node when last assigned
+    [[nodiscard]] uint64_t GetSourceVersion() const noexcept { return m_SourceVersion; }
+
+    decltype(auto) SetValueType(const SDataType& Type)
     {
-        m_DataType = Ty;
+        m_DataType = CTypeRegistry::Get().Intern(Type.Name);
         return *this;
     }
     [[nodiscard]] const auto& GetValueType() const noexcept { return m_DataType; }
@@ -94,9 +192,43 @@ public:
     }
 
 protected:
-    std::string_view m_DataType = "void";
+#ifdef AMB_ENABLE_PROFILER
+    /// Containers report their element storage as well, anything else just its own size
+    template <typename Ty>
+    static uint64_t HeapSizeOf(const Ty& Value) noexcept
+    {
+        if constexpr (requires { Value.capacity(); typename Ty::value_type; })
+            return sizeof(Ty) + Value.capacity() * sizeof(typename Ty::value_type);
+        else
+            return sizeof(Ty);
+    }
+
+    void RecordOutputBytes(uint64_t Bytes) noexcept;
+#endif
+
+    [[nodiscard]] const std::shared_ptr<void>& GetSharedData() const noexcept
+    {
+        if (m_PendingData != nullptr) [[unlikely]]
+            return m_PendingData->Wait();
+        return m_SharedData;
+    }
+
+    void LaunchPending(CWorkStealingPool* Pool);
+
+    /// Only touches the registry when the type actually changes, so the name never outlives its plugin
+    void UpdateValueType(const SDataType& Type) noexcept
+    {
+        if (m_DataType.Id != Type.Id) [[unlikely]]
+            m_DataType = CTypeRegistry::Get().Intern(Type.Name);
+    }
+
+    SDataType m_DataType = VoidDataType;
 
     bool m_IsUniversalPin = false;
 
+    uint64_t m_SourceVersion = 0;
+    alignas(InlineCapacity) std::array<std::byte, InlineCapacity> m_InlineData { };
     std::shared_ptr<void> m_SharedData;
+    /// Takes the place of m_SharedData while set
+    std::shared_ptr<CPendingData> m_PendingData;
 };
@@ -4,47 +4,230 @@
 
 #include "ExecuteNode.hxx"
 
+#include "DataPin.hxx"
 #include "ExecutionManager.hxx"
 
 #include <cassert>
+#include <semaphore>
+#include <thread>
+#include <utility>
 
-CExecuteNode::CExecuteNode()
+namespace {
+thread_local CExecuteNode::SFlowStep* GCurrentStep = nullptr;
+}
+
+CExecuteNode::CStepScope::CStepScope(SFlowStep& Step) noexcept
+    : m_Previous(std::exchange(GCurrentStep, &Step))
 {
-    m_NodeType = ENodeType::Execution;
+}
 
-    AddOnPinChanges([this](CPin*, bool) {
-        if (m_IsDestructing)
-            return;
+CExecuteNode::CStepScope::~CStepScope()
+{
+    GCurrentStep = m_Previous;
+}
+
+CExecuteNode::SFlowStep& CExecuteNode::GetStep() noexcept
+{
+    /// Hooks called outside any flow, e.g. by tools pulling inputs directly, get a fresh step per thread
+    thread_local SFlowStep DetachedStep;
+    return GCurrentStep != nullptr ? *GCurrentStep : DetachedStep;
+}
 
-        m_InFlowingPin.clear();
-        std::ranges::copy(GetInputPins() | FlowPinFilter | FlowPinTransform, std::back_inserter(m_InFlowingPin));
-        m_OutFlowingPin.clear();
-        std::ranges::copy(GetOutputPins() | FlowPinFilter | FlowPinTransform, std::back_inserter(m_OutFlowingPin));
-    });
+CExecuteNode::CExecuteNode()
+{
+    m_NodeType = ENodeType::Execution;
 
     AddInputOutputFlowPin();
 }
 
+void CExecuteNode::OnPinsChanged() noexcept
+{
+    m_InFlowingPin.clear();
+    std::ranges::copy(GetInputPins() | FlowPinFilter | FlowPinTransform, std::back_inserter(m_InFlowingPin));
+    m_OutFlowingPin.clear();
+    std::ranges::copy(GetOutputPins() | FlowPinFilter | FlowPinTransform, std::back_inserter(m_OutFlowingPin));
+}
+
 CExecuteNode::~CExecuteNode()
 {
     if (m_Manager)
         m_Manager->UnRegisterNode(this);
 }
 
-CExecuteNode* CExecuteNode::ExecuteNode()
+CExecuteNode* CExecuteNode::ExecuteNode(SFlowStep& Step)
+{
+    if (m_IsSuspendable) {
+        std::binary_semaphore Ready { 0 };
+        for (auto IsDone = StartAsync(Step, [&Ready] { Ready.release(); }); !IsDone; IsDone = ResumeAsync(Step))
+            Ready.acquire();
+
+        return FinishAsync(Step);
+    }
+
+    BeginStep(Step);
+    {
+        std::lock_guard Lock { m_StepMutex };
+        const CStepScope Scope { Step };
+        AMB_PROFILE_NODE(*this, Execute);
+        Execute();
+    }
+    return FinishStep(Step);
+}
+
+bool CExecuteNode::StartAsync(SFlowStep& Step, std::function<void()> OnReady)
+{
+    BeginStep(Step);
+    Step.OnAsyncReady = std::move(OnReady);
+
+    /// Inputs are read before the first wait, later slices run without the lock
+    std::lock_guard Lock { m_StepMutex };
+    const CStepScope Scope { Step };
+    Step.AsyncTask = ExecuteAsync();
+
+    /// Only the slices actually running on a worker count, not the time spent parked
+    AMB_PROFILE_NODE(*this, Execute);
+    return Step.AsyncTask.Resume();
+}
+
+bool CExecuteNode::ResumeAsync(SFlowStep& Step)
+{
+    const CStepScope Scope { Step };
+    AMB_PROFILE_NODE(*this, Resume);
+    return Step.AsyncTask.Resume();
+}
+
+CExecuteNode* CExecuteNode::FinishAsync(SFlowStep& Step)
+{
+    Step.AsyncTask.Reset();
+    Step.OnAsyncReady = nullptr;
+    return FinishStep(Step);
+}
+
+CFlowTask CExecuteNode::ExecuteAsync()
 {
-    m_DesiredOutputPin = 0;
     Execute();
+    co_return;
+}
 
-    if (m_DesiredOutputPin < m_OutFlowingPin.size() && *m_OutFlowingPin[m_DesiredOutputPin])
-        return static_cast<CExecuteNode*>(m_OutFlowingPin[m_DesiredOutputPin]->GetTheOnlyConnected()->GetOwner());
+CExecuteNode::SFlowAwaiter CExecuteNode::WaitFor(std::shared_ptr<CFlowEvent> Event, const std::chrono::steady_clock::duration Timeout)
+{
+    const auto Now = std::chrono::steady_clock::now();
+    const auto Deadline = Timeout >= std::chrono::steady_clock::time_point::max() - Now ? std::chrono::steady_clock::time_point::max() : Now + Timeout;
+    return { this, &GetStep(), Deadline, std::move(Event) };
+}
+
+CExecuteNode::SFlowAwaiter CExecuteNode::WaitForData(const CDataPin& Pin)
+{
+    if (auto Event = Pin.GetReadyEvent())
+        return WaitFor(std::move(Event));
+    return SleepUntil(std::chrono::steady_clock::time_point::min());
+}
+
+bool CExecuteNode::TakeSubFlowCall(SFlowStep& Step, CExecuteNode*& Start, uint64_t& State) const noexcept
+{
+    const auto Pin = std::exchange(Step.SubFlowPin, NoPin);
+    if (Pin == NoPin)
+        return false;
+
+    Start = Pin < m_OutFlowingPin.size() && *m_OutFlowingPin[Pin] ? static_cast<CExecuteNode*>(m_OutFlowingPin[Pin]->GetTheOnlyConnected()->GetOwner()) : nullptr;
+    State = Step.SubFlowState;
+    return true;
+}
+
+CExecuteNode* CExecuteNode::ReturnFromSubFlow(SFlowStep& Step, const uint64_t State)
+{
+    BeginStep(Step);
+    {
+        std::lock_guard Lock { m_StepMutex };
+        const CStepScope Scope { Step };
+        AMB_PROFILE_NODE(*this, Execute);
+        OnSubFlowEnd(State);
+    }
+    return FinishStep(Step);
+}
+
+void CExecuteNode::PrepareInputPin() noexcept
+{
+    const auto& Step = GetStep();
+    if (Step.IsInputPrepared)
+        return;
+
+    AMB_PROFILE_NODE(*this, PrepareInput);
+    RefreshUpstream(Step.Epoch);
+    AssignInputPins();
+}
+
+void CExecuteNode::BeginStep(SFlowStep& Step) noexcept
+{
+    /// Every flow step starts a new epoch, data nodes pulled within it are evaluated at most once
+    if (!std::exchange(Step.IsEpochPrepared, false))
+        Step.Epoch = m_Manager ? m_Manager->AcquireStepEpoch(Step.Flow, this) : 0;
+    Step.IsInputPrepared = false;
+    Step.DesiredOutputPin = 0;
+    Step.ExpectedWakeTime = { };
+}
+
+CExecuteNode* CExecuteNode::FinishStep(const SFlowStep& Step) noexcept
+{
+    ++m_Version;
+
+    if (const auto Desired = Step.DesiredOutputPin; Desired < m_OutFlowingPin.size() && *m_OutFlowingPin[Desired])
+        return static_cast<CExecuteNode*>(m_OutFlowingPin[Desired]->GetTheOnlyConnected()->GetOwner());
 
     return nullptr;
 }
 
-void CExecuteNode::SetManager(CExecutionManager* Manager)
+/// Shared with every wake source, only the first one to fire signals the driver
+struct CExecuteNode::SFlowAwaiter::SWakeState {
+    std::atomic_flag Fired;
+    std::function<void()> OnReady;
+
+    void Fire()
+    {
+        if (!Fired.test_and_set(std::memory_order_acq_rel))
+            OnReady();
+    }
+};
+
+bool CExecuteNode::SFlowAwaiter::await_ready() const
+{
+    if (Step->StopToken.stop_requested() || (Node->m_Manager != nullptr && !*Node->m_Manager) || (Event != nullptr && Event->IsSet()))
+        return true;
+    if (Event == nullptr && Deadline <= std::chrono::steady_clock::now())
+        return true;
+
+    /// Detached from a manager nothing would wake us, degrade to a plain sleep
+    if (Node->m_Manager == nullptr) {
+        if (Deadline != std::chrono::steady_clock::time_point::max())
+            std::this_thread::sleep_until(Deadline);
+        return true;
+    }
+
+    return false;
+}
+
+void CExecuteNode::SFlowAwaiter::await_suspend(std::coroutine_handle<>)
+{
+    WakeState = std::make_shared<SWakeState>();
+    WakeState->OnReady = Step->OnAsyncReady;
+
+    const auto Wake = [State = WakeState] { State->Fire(); };
+    if (Deadline != std::chrono::steady_clock::time_point::max())
+        Node->m_Manager->GetTimerWheel()->Schedule(Deadline, Wake);
+    if (Event != nullptr)
+        Event->OnSet(Wake);
+    StopWatch.emplace(Step->StopToken, Wake);
+}
+
+bool CExecuteNode::SFlowAwaiter::await_resume() noexcept
+{
+    StopWatch.reset();
+    return !Step->StopToken.stop_requested() && (Node->m_Manager == nullptr || *Node->m_Manager);
+}
+
+bool CExecuteNode::IsStopRequested() const noexcept
 {
-    m_Manager = Manager;
+    return GetStep().StopToken.stop_requested() || (m_Manager != nullptr && !*m_Manager);
 }
 
 void CExecuteNode::AddInputOutputFlowPin()
@@ -6,32 +6,210 @@
 
 #include "BaseNode.hxx"
 #include "FlowPin.hxx"
+#include "FlowTask.hxx"
 
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <concepts>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
 #include <ranges>
+#include <stop_token>
+#include <string_view>
+
+class CDataPin;
+struct SFlowContext;
 
 static constexpr auto FlowPinFilter = std::views::filter([](const auto& Pin) static { return *Pin == EPinType::Flow; });
 static constexpr auto FlowPinTransform = std::views::transform([](const auto& Pin) static { return static_cast<CFlowPin*>(Pin.get()); });
 
+/// Scheduling class of a flow, queued flows of a more urgent class start first
+enum class EFlowPriority : uint8_t {
+    Interactive,
+    Normal,
+    Background
+};
+
+/// Spelling used in board files and the editor
+inline constexpr std::array<std::string_view, 3> FlowPriorityNames { "interactive", "normal", "background" };
+
 class MACRO_API CExecuteNode : public CBaseNode {
 
 public:
+    /// One flow's pass through the node, owned by whoever drives it and never by the node.
+    /// Flows running through the same node at once each have their own
+    struct SFlowStep {
+        SFlowContext* Flow = nullptr;
+        std::stop_token StopToken;
+        /// Data nodes pulled within the step are evaluated at most once
+        uint64_t Epoch = 0;
+        /// Set while the driver has already assigned all input pins
+        bool IsInputPrepared = false;
+        /// Set by drivers that refreshed the node's data upstream under Epoch themselves, the step then keeps that epoch
+        bool IsEpochPrepared = false;
+        /// NoPin ends the flow here
+        size_t DesiredOutputPin = 0;
+        size_t SubFlowPin = NoPin;
+        uint64_t SubFlowState = 0;
+        std::chrono::steady_clock::time_point ExpectedWakeTime;
+
+        /// Coroutine of a suspendable node and how its waits signal the driver, alive from StartAsync to FinishAsync
+        CFlowTask AsyncTask;
+        std::function<void()> OnAsyncReady;
+    };
+
+    /// Returned by Sleep and WaitFor, resumes on the deadline, the event or a stop request, whichever comes first
+    struct MACRO_API SFlowAwaiter {
+        CExecuteNode* Node;
+        SFlowStep* Step;
+        std::chrono::steady_clock::time_point Deadline;
+        std::shared_ptr<CFlowEvent> Event;
+
+        [[nodiscard]] bool await_ready() const;
+        void await_suspend(std::coroutine_handle<> Handle);
+        /// False if woken by a stop request
+        bool await_resume() noexcept;
+
+        struct SWakeState;
+        std::shared_ptr<SWakeState> WakeState;
+        std::optional<std::stop_callback<std::function<void()>>> StopWatch;
+    };
+
     CExecuteNode();
     ~CExecuteNode() override;
 
-    virtual CExecuteNode* ExecuteNode();
+    /// Run the node to completion on the calling thread, suspendable nodes block it between suspensions.
+    /// Step carries the flow and its stop token in, the chosen successor and any sub-flow call out
+    virtual CExecuteNode* ExecuteNode(SFlowStep& Step);
 
-    void SetManager(class CExecutionManager* Manager);
+    /// Flows driving a suspendable node themselves release the thread while it waits, Step must stay put until FinishAsync.
+    /// StartAsync and ResumeAsync return true once finished, otherwise OnReady is invoked from any thread when ResumeAsync should be called
+    [[nodiscard]] bool IsSuspendable() const noexcept { return m_IsSuspendable; }
+    /// Set if the node drives its own flow, e.g. through sub-flows, see m_HasCustomFlow
+    [[nodiscard]] bool HasCustomFlow() const noexcept { return m_HasCustomFlow; }
+    bool StartAsync(SFlowStep& Step, std::function<void()> OnReady);
+    bool ResumeAsync(SFlowStep& Step);
+    CExecuteNode* FinishAsync(SFlowStep& Step);
+
+    /// Class flows take on once they reach this node, nullopt keeps the class of the flow.
+    /// Flows started here begin in it, Normal if unset
+    [[nodiscard]] std::optional<EFlowPriority> GetFlowPriority() const noexcept { return m_FlowPriority; }
+    void SetFlowPriority(const std::optional<EFlowPriority> Priority) noexcept { m_FlowPriority = Priority; }
 
     [[nodiscard]] const auto& GetFlowInputPins() const noexcept { return m_InFlowingPin; }
     [[nodiscard]] const auto& GetFlowOutputPins() const noexcept { return m_OutFlowingPin; }
 
+    /// Flags implied by what NodeTy overrides, so the execution plan never flattens a node with its own flow.
+    /// Overrides hidden from us (non-public ones) count as overridden, treating a plain node as custom only costs speed
+    template <typename NodeTy>
+    void DeduceFlowTraits() noexcept
+    {
+        constexpr bool KeepsExecuteNode = requires { requires std::is_same_v<decltype(&NodeTy::ExecuteNode), decltype(&CExecuteNode::ExecuteNode)>; };
+        constexpr bool KeepsOnSubFlowEnd = requires { requires std::is_same_v<decltype(&NodeTy::OnSubFlowEnd), decltype(&CExecuteNode::OnSubFlowEnd)>; };
+        constexpr bool KeepsExecuteAsync = requires { requires std::is_same_v<decltype(&NodeTy::ExecuteAsync), decltype(&CExecuteNode::ExecuteAsync)>; };
+
+        m_HasCustomFlow |= !KeepsExecuteNode || !KeepsOnSubFlowEnd;
+        m_IsSuspendable |= !KeepsExecuteAsync;
+    }
+
+    /// True if Step called a sub-flow, the manager pushes a frame and continues at Start, which is null for an unconnected pin
+    [[nodiscard]] bool TakeSubFlowCall(SFlowStep& Step, CExecuteNode*& Start, uint64_t& State) const noexcept;
+    /// Step taken once the sub-flow called with State ended, returns the successor like ExecuteNode
+    CExecuteNode* ReturnFromSubFlow(SFlowStep& Step, uint64_t State);
+
 protected:
+    /// Makes Step the one the node's hooks (Execute, ExecuteAsync, OnSubFlowEnd) see on this thread
+    class MACRO_API CStepScope {
+    public:
+        explicit CStepScope(SFlowStep& Step) noexcept;
+        ~CStepScope();
+
+        CStepScope(const CStepScope&) = delete;
+        CStepScope& operator=(const CStepScope&) = delete;
+
+    private:
+        SFlowStep* m_Previous;
+    };
+
     void AddInputOutputFlowPin();
 
+    /// Flow pin lists stay in step with the pins, transactions or not
+    void OnPinsChanged() noexcept override;
+
+    /// Step currently running on this thread, an empty one outside any flow
+    [[nodiscard]] static SFlowStep& GetStep() noexcept;
+
+    /// Inputs of the running step, pulled under its epoch
+    void PrepareInputPin() noexcept override;
+
     virtual void Execute() { PrepareInputPin(); }
 
-    CExecutionManager* m_Manager { };
+    /// Only called for nodes with m_IsSuspendable set
+    virtual CFlowTask ExecuteAsync();
+
+    [[nodiscard]] SFlowAwaiter Sleep(const std::chrono::steady_clock::duration Duration) { return SleepUntil(std::chrono::steady_clock::now() + Duration); }
+    [[nodiscard]] SFlowAwaiter SleepUntil(const std::chrono::steady_clock::time_point Deadline) { return { this, &GetStep(), Deadline, nullptr }; }
+    [[nodiscard]] SFlowAwaiter WaitFor(std::shared_ptr<CFlowEvent> Event, std::chrono::steady_clock::duration Timeout = std::chrono::steady_clock::duration::max());
+
+    /// Resumes once Pin's value from CDataPin::SetAsync is produced, right away for any other value
+    [[nodiscard]] SFlowAwaiter WaitForData(const CDataPin& Pin);
+
+    /// Announce when the whole wait ends, the manager prefetches the next node's inputs to be ready by then
+    void ExpectWakeAt(const std::chrono::steady_clock::time_point Time) noexcept { GetStep().ExpectedWakeTime = Time; }
+
+    /// Run the flow behind output pin Pin to its end, then OnSubFlowEnd continues with State.
+    /// The manager keeps the frame instead of the native stack, only valid with m_HasCustomFlow set
+    void CallSubFlow(const size_t Pin, const uint64_t State = 0) noexcept
+    {
+        auto& Step = GetStep();
+        Step.SubFlowPin = Pin;
+        Step.SubFlowState = State;
+    }
+
+    /// Either calls the next sub-flow or sets the output pin where the flow continues
+    virtual void OnSubFlowEnd(uint64_t State) { }
+
+    /// Output pin the running step continues from, NoPin ends the flow
+    static void SetDesiredOutputPin(const size_t Pin) noexcept { GetStep().DesiredOutputPin = Pin; }
+
+    void BeginStep(SFlowStep& Step) noexcept;
+    CExecuteNode* FinishStep(const SFlowStep& Step) noexcept;
+
+    /// Long running nodes should poll this and return early, covers both manager shutdown and flow cancellation
+    [[nodiscard]] bool IsStopRequested() const noexcept;
+    /// Stop token of the running step, for work handed to other threads
+    [[nodiscard]] static const std::stop_token& GetStopToken() noexcept { return GetStep().StopToken; }
+
+    static constexpr size_t NoPin = static_cast<size_t>(-1);
+
     std::vector<CPin*> m_InFlowingPin;
-    size_t m_DesiredOutputPin = 0;
     std::vector<CPin*> m_OutFlowingPin;
+
+    /// Serializes flows through the node from assigning its input pins until Execute returns, the pins themselves are shared
+    std::mutex m_StepMutex;
+
+    /// The execution plan hands such nodes back instead of inlining them.
+    /// Deduced from overriding ExecuteNode or OnSubFlowEnd for plugin nodes, set by hand for custom input handling or nodes built outside a plugin
+    bool m_HasCustomFlow = false;
+
+    std::optional<EFlowPriority> m_FlowPriority;
+
+    /// Set if ExecuteAsync is overridden (deduced like m_HasCustomFlow), waits then park the flow instead of holding a worker
+    bool m_IsSuspendable = false;
+
+    /// How long the last prefetch of our inputs took, in steady clock ticks
+    std::atomic<std::chrono::steady_clock::rep> m_PrefetchCost { 0 };
+
+    friend class CExecutionManager;
+    friend class CExecutionPlan;
 };
+
+template <std::derived_from<CExecuteNode> NodeTy>
+void DeduceNodeTraits(NodeTy* Node) noexcept
+{
+    Node->template DeduceFlowTraits<NodeTy>();
+}
@@ -4,55 +4,671 @@
 
 #include "ExecutionManager.hxx"
 
+#include "DataPin.hxx"
 #include "ExecuteNode.hxx"
+#include "ExecutionPlan.hxx"
 
-CExecutionManager::~CExecutionManager()
+#include <algorithm>
+#include <ranges>
+#include <string>
+#include <typeindex>
+#include <unordered_set>
+#include <utility>
+
+namespace {
+size_t CombineHash(const size_t Seed, const size_t Value) noexcept
 {
-    m_TerminationFlag.test_and_set();
-    if (m_AsyncThread)
-        if (m_AsyncThread->joinable())
-            m_AsyncThread->join();
+    return Seed ^ (Value + 0x9e3779b9 + (Seed << 6) + (Seed >> 2));
+}
+
+/// Owner of the output pin feeding Input with duplicates replaced by what they share, and the pin's index
+std::pair<const CBaseNode*, size_t> CanonicalSource(const CPin& Input)
+{
+    const auto* Source = Input.GetTheOnlyConnected();
+    const auto* Owner = Source->GetOwner();
+    const auto Index = std::ranges::find(Owner->GetOutputPins(), Source, &std::unique_ptr<CPin>::get) - Owner->GetOutputPins().begin();
+
+    const auto* Shared = Owner->GetSharedWith();
+    return { Shared != nullptr ? Shared : Owner, Index };
+}
+
+size_t HashStructure(const CBaseNode& Node, const std::string& Ext)
+{
+    auto Hash = CombineHash(std::type_index(typeid(Node)).hash_code(), std::hash<std::string> { }(Ext));
+    for (const auto& IPin : Node.GetInputPins()) {
+        if (*IPin != EPinType::Data)
+            continue;
+
+        if (*IPin) {
+            const auto [Owner, Index] = CanonicalSource(*IPin);
+            Hash = CombineHash(CombineHash(Hash, std::hash<const void*> { }(Owner)), Index);
+        } else {
+            Hash = CombineHash(Hash, IPin->As<CDataPin>()->HashValue());
+        }
+    }
+
+    return Hash;
 }
 
-bool CExecutionManager::StartExecuteAsync(CExecuteNode* Target, std::function<void()> OnComplete)
+bool IsSameStructure(const CBaseNode& Lhs, const CBaseNode& Rhs)
 {
-    // Bounded reentry: reject if an async execution is already in flight
-    if (m_AsyncRunning.test_and_set(std::memory_order_acq_rel)) {
+    if (typeid(Lhs) != typeid(Rhs) || Lhs.GetInputPins().size() != Rhs.GetInputPins().size() || Lhs.GetOutputPins().size() != Rhs.GetOutputPins().size())
         return false;
+
+    for (size_t Index = 0; Index < Lhs.GetInputPins().size(); ++Index) {
+        const auto& LPin = Lhs.GetInputPins()[Index];
+        const auto& RPin = Rhs.GetInputPins()[Index];
+        if (static_cast<EPinType>(*LPin) != static_cast<EPinType>(*RPin) || static_cast<bool>(*LPin) != static_cast<bool>(*RPin))
+            return false;
+        if (*LPin != EPinType::Data)
+            continue;
+
+        if (*LPin ? CanonicalSource(*LPin) != CanonicalSource(*RPin) : !LPin->As<CDataPin>()->HoldsSameValue(*RPin->As<CDataPin>()))
+            return false;
     }
 
-    // Join any previously completed async thread before launching a new one
-    if (m_AsyncThread && m_AsyncThread->joinable()) {
-        m_AsyncThread->join();
+    return true;
+}
+}
+
+CExecutionManager::CExecutionManager(const size_t MaxFlowWorkers)
+    : m_WorkerPool(std::make_unique<CWorkStealingPool>())
+    , m_TimerWheel(std::make_unique<CTimerWheel>())
+    , m_BaseFlowWorkers(std::clamp<size_t>(std::thread::hardware_concurrency(), 1, std::max<size_t>(MaxFlowWorkers, 1)))
+    , m_MaxFlowWorkers(std::max<size_t>(MaxFlowWorkers, 1))
+{
+}
+
+CExecutionManager::~CExecutionManager()
+{
+    {
+        std::lock_guard Lock { m_FlowMutex };
+        m_TerminationFlag.test_and_set();
     }
 
-    m_AsyncThread = std::make_unique<std::thread>([this, Target, Cb = std::move(OnComplete)]() {
-        Execute(Target);
-        m_AsyncRunning.clear(std::memory_order_release);
-        if (Cb) {
-            Cb();
+    StopAllFlows();
+    m_FlowQueued.notify_all();
+    m_InteractiveFlowQueued.notify_all();
+
+    for (auto& Worker : m_FlowWorkers)
+        if (Worker.joinable())
+            Worker.join();
+
+    /// Flows left parked never complete, their look-ahead must not outlive them
+    for (const auto& Flow : m_Flows | std::views::values)
+        CancelPrefetch(Flow.get());
+
+    /// Parked flows were woken by the stop above, nothing scheduled later reaches a flow anymore
+    m_TimerWheel.reset();
+}
+
+FlowId CExecutionManager::StartExecuteAsync(CExecuteNode* Target, std::function<void()> OnComplete)
+{
+    if (Target == nullptr || m_TerminationFlag.test()) [[unlikely]]
+        return InvalidFlowId;
+
+    std::unique_lock Lock { m_FlowMutex };
+
+    /// Bounded reentry per entry, repeated triggers don't pile up behind a running flow
+    if (std::ranges::any_of(m_Flows | std::views::values, [Target](const auto& Flow) { return Flow->Entry == Target; }))
+        return InvalidFlowId;
+
+    auto Flow = std::make_shared<SFlowContext>();
+    Flow->Id = m_NextFlowId++;
+    Flow->Entry = Flow->Next = Target;
+    Flow->OnComplete = std::move(OnComplete);
+    Flow->QueuedTime = std::chrono::steady_clock::now();
+    Flow->Priority.store(Target->GetFlowPriority().value_or(EFlowPriority::Normal), std::memory_order_relaxed);
+
+    m_Flows.emplace(Flow->Id, Flow);
+    EnqueueFlow(Flow);
+
+    return Flow->Id;
+}
+
+FlowId CExecutionManager::StartBranchAsync(CExecuteNode* Target, std::stop_token StopToken, const SFlowContext* Parent, std::function<void()> OnComplete)
+{
+    if (Target == nullptr || m_TerminationFlag.test()) [[unlikely]]
+        return InvalidFlowId;
+
+    auto Flow = std::make_shared<SFlowContext>();
+    Flow->Next = Target;
+    Flow->OnComplete = std::move(OnComplete);
+    Flow->QueuedTime = std::chrono::steady_clock::now();
+    Flow->Priority.store(Parent != nullptr ? Parent->Priority.load(std::memory_order_relaxed) : Target->GetFlowPriority().value_or(EFlowPriority::Normal), std::memory_order_relaxed);
+    Flow->ForwardStop.emplace(std::move(StopToken), [StopSource = Flow->StopSource]() mutable { StopSource.request_stop(); });
+
+    std::lock_guard Lock { m_FlowMutex };
+    if (m_TerminationFlag.test()) [[unlikely]]
+        return InvalidFlowId;
+
+    Flow->Id = m_NextFlowId++;
+    m_Flows.emplace(Flow->Id, Flow);
+    EnqueueFlow(Flow);
+
+    return Flow->Id;
+}
+
+void CExecutionManager::EnqueueFlow(std::shared_ptr<SFlowContext> Flow)
+{
+    const auto Priority = Flow->Priority.load(std::memory_order_relaxed);
+    Flow->EnqueueTime = std::chrono::steady_clock::now();
+    m_PendingFlows[std::to_underlying(Priority)].emplace_back(std::move(Flow));
+    ++m_PendingFlowCount;
+    m_FlowQueued.notify_one();
+
+    if (Priority == EFlowPriority::Interactive) {
+        /// Don't count on the shared workers, they may all be stuck in long running nodes
+        m_InteractiveFlowQueued.notify_one();
+        if (m_IdleReservedFlowWorkers >= m_PendingFlows[std::to_underlying(EFlowPriority::Interactive)].size())
+            return;
+
+        if (m_ReservedFlowWorkers < InteractiveFlowWorkers) {
+            ++m_ReservedFlowWorkers;
+            m_FlowWorkers.emplace_back(&CExecutionManager::FlowWorkerLoop, this, true);
+            return;
         }
-    });
+    }
+
+    if (m_IdleFlowWorkers >= m_PendingFlowCount)
+        return;
+
+    const auto SharedFlowWorkers = m_FlowWorkers.size() - m_ReservedFlowWorkers;
+    if (SharedFlowWorkers < m_BaseFlowWorkers) {
+        m_FlowWorkers.emplace_back(&CExecutionManager::FlowWorkerLoop, this, false);
+    } else if (SharedFlowWorkers < m_MaxFlowWorkers && !m_IsGrowthCheckPending) {
+        /// Suspended flows hand their worker back almost immediately, only grow when blocking nodes keep the queue starved
+        m_IsGrowthCheckPending = true;
+        m_TimerWheel->Schedule(FlowStarvationDelay, [this] { GrowIfStarved(); });
+    }
+}
+
+void CExecutionManager::GrowIfStarved()
+{
+    std::lock_guard Lock { m_FlowMutex };
+    m_IsGrowthCheckPending = false;
+
+    if (m_TerminationFlag.test() || m_IdleFlowWorkers >= m_PendingFlowCount || m_FlowWorkers.size() - m_ReservedFlowWorkers >= m_MaxFlowWorkers)
+        return;
+
+    m_FlowWorkers.emplace_back(&CExecutionManager::FlowWorkerLoop, this, false);
+    if (m_FlowWorkers.size() - m_ReservedFlowWorkers < m_MaxFlowWorkers) {
+        m_IsGrowthCheckPending = true;
+        m_TimerWheel->Schedule(FlowStarvationDelay, [this] { GrowIfStarved(); });
+    }
+}
+
+void CExecutionManager::StopFlow(const FlowId Flow) noexcept
+{
+    std::stop_source StopSource { std::nostopstate };
+    {
+        std::lock_guard Lock { m_FlowMutex };
+        if (const auto It = m_Flows.find(Flow); It != m_Flows.end())
+            StopSource = It->second->StopSource;
+    }
+
+    /// Stop callbacks wake parked flows, which takes the flow lock again
+    StopSource.request_stop();
+}
+
+void CExecutionManager::StopAllFlows() noexcept
+{
+    std::vector<std::stop_source> StopSources;
+    {
+        std::lock_guard Lock { m_FlowMutex };
+        for (const auto& Flow : m_Flows | std::views::values)
+            StopSources.emplace_back(Flow->StopSource);
+    }
+
+    for (auto& StopSource : StopSources)
+        StopSource.request_stop();
+}
+
+size_t CExecutionManager::GetRunningFlowCount() const noexcept
+{
+    std::lock_guard Lock { m_FlowMutex };
+    return m_Flows.size();
+}
+
+std::vector<FlowId> CExecutionManager::GetRunningFlows() const
+{
+    std::lock_guard Lock { m_FlowMutex };
+    return m_Flows | std::views::keys | std::ranges::to<std::vector>();
+}
+
+std::optional<SFlowStats> CExecutionManager::GetFlowStats(const FlowId Flow) const
+{
+    std::lock_guard Lock { m_FlowMutex };
+
+    const auto It = m_Flows.find(Flow);
+    if (It == m_Flows.end())
+        return std::nullopt;
+
+    const auto& Context = *It->second;
+    const auto Now = std::chrono::steady_clock::now();
+    const bool HasStarted = Context.StartTime != std::chrono::steady_clock::time_point { };
+
+    return SFlowStats {
+        .QueueLatency = (HasStarted ? Context.StartTime : Now) - Context.QueuedTime,
+        .RunTime = HasStarted ? Now - Context.StartTime : std::chrono::steady_clock::duration::zero(),
+        .ExecutedNodes = Context.ExecutedNodes.load(std::memory_order_relaxed),
+    };
+}
+
+std::shared_ptr<SFlowContext> CExecutionManager::PopPendingFlow(const bool IsReserved)
+{
+    /// Oldest head once every class is pushed back by its aging delay, ties go to the more urgent class
+    size_t Best = m_PendingFlows.size();
+    auto BestTime = std::chrono::steady_clock::time_point::max();
+    for (size_t Class = 0; Class < (IsReserved ? 1 : m_PendingFlows.size()); ++Class) {
+        if (m_PendingFlows[Class].empty())
+            continue;
+
+        if (const auto Time = m_PendingFlows[Class].front()->EnqueueTime + FlowAgingDelay * Class; Time < BestTime) {
+            Best = Class;
+            BestTime = Time;
+        }
+    }
+
+    auto Flow = std::move(m_PendingFlows[Best].front());
+    m_PendingFlows[Best].pop_front();
+    --m_PendingFlowCount;
+    return Flow;
+}
+
+void CExecutionManager::FlowWorkerLoop(const bool IsReserved)
+{
+    auto& IdleWorkers = IsReserved ? m_IdleReservedFlowWorkers : m_IdleFlowWorkers;
+    auto& FlowQueued = IsReserved ? m_InteractiveFlowQueued : m_FlowQueued;
+    const auto& Interactive = m_PendingFlows[std::to_underlying(EFlowPriority::Interactive)];
+
+    std::unique_lock Lock { m_FlowMutex };
+    while (true) {
+        ++IdleWorkers;
+        FlowQueued.wait(Lock, [&] { return m_TerminationFlag.test() || (IsReserved ? !Interactive.empty() : m_PendingFlowCount != 0); });
+        --IdleWorkers;
+
+        if (m_TerminationFlag.test())
+            return;
+
+        auto Flow = PopPendingFlow(IsReserved);
+        if (Flow->StartTime == std::chrono::steady_clock::time_point { })
+            Flow->StartTime = std::chrono::steady_clock::now();
+
+        Lock.unlock();
+        const bool IsFinished = RunFlow(Flow);
+        Lock.lock();
+
+        if (IsFinished)
+            m_Flows.erase(Flow->Id);
+    }
+}
+
+bool CExecutionManager::RunFlow(const std::shared_ptr<SFlowContext>& Flow)
+{
+    const auto StopToken = Flow->StopSource.get_token();
+
+    if (auto* Node = std::exchange(Flow->Suspended, nullptr)) {
+        Flow->ParkRendezvous.store(0, std::memory_order_relaxed);
+        if (!Node->ResumeAsync(Flow->SuspendedStep)) {
+            Flow->Suspended = Node;
+            SchedulePrefetch(Flow.get(), Node);
+            CheckInParked(Flow.get());
+            return false;
+        }
+
+        Flow->Next = Advance(Node, Node->FinishAsync(Flow->SuspendedStep), Flow->SuspendedStep, Flow->Frames);
+    }
+
+    if (Flow->Next != nullptr || !Flow->Frames.empty()) {
+        if (auto* Node = Step(Flow->Next, StopToken, Flow.get(), true)) {
+            Flow->Suspended = Node;
+            SchedulePrefetch(Flow.get(), Node);
+            CheckInParked(Flow.get());
+            return false;
+        }
+    }
 
+    Flow->Frames.clear();
+    CancelPrefetch(Flow.get());
+    Flow->SetActiveNode(nullptr);
+    if (Flow->OnComplete)
+        Flow->OnComplete();
     return true;
 }
 
-void CExecutionManager::Execute(CExecuteNode* Target)
+void CExecutionManager::CheckInParked(SFlowContext* Flow)
+{
+    if (Flow->ParkRendezvous.fetch_add(1, std::memory_order_acq_rel) == 0)
+        return;
+
+    std::lock_guard Lock { m_FlowMutex };
+    if (const auto It = m_Flows.find(Flow->Id); It != m_Flows.end() && !m_TerminationFlag.test())
+        EnqueueFlow(It->second);
+}
+
+void CExecutionManager::SchedulePrefetch(SFlowContext* Flow, const CExecuteNode* Waiting)
+{
+    /// Slices of the same wait park again, the first one already looked ahead
+    if (Flow->HasPrefetch.load(std::memory_order_relaxed))
+        if (const auto Current = Flow->Prefetch.load(std::memory_order_relaxed); Current != nullptr && Current->Waiting == Waiting)
+            return;
+
+    const auto& OutFlows = Waiting->GetFlowOutputPins();
+    if (OutFlows.empty() || !*OutFlows.front())
+        return;
+
+    /// The taken output is only known once the wait ends, the first one is the likely successor
+    auto* Next = static_cast<CExecuteNode*>(OutFlows.front()->GetTheOnlyConnected()->GetOwner());
+    const auto WakeTime = Flow->SuspendedStep.ExpectedWakeTime;
+    const bool IsWakeTimeKnown = WakeTime != std::chrono::steady_clock::time_point { };
+
+    auto Prefetch = std::make_shared<SFlowPrefetch>();
+    Prefetch->Waiting = Waiting;
+    Prefetch->Node = Next;
+    Prefetch->Epoch = AdvanceEpoch();
+    Prefetch->IsAdoptable = IsWakeTimeKnown;
+
+    CancelPrefetch(Flow);
+    Flow->Prefetch.store(Prefetch, std::memory_order_relaxed);
+    Flow->HasPrefetch.store(true, std::memory_order_release);
+
+    auto Launch = [Pool = m_WorkerPool.get(), Prefetch = std::move(Prefetch)] {
+        Pool->Detach([Prefetch] { RunPrefetch(*Prefetch); });
+    };
+
+    if (!IsWakeTimeKnown) {
+        Launch();
+        return;
+    }
+
+    const auto Cost = std::chrono::steady_clock::duration(Next->m_PrefetchCost.load(std::memory_order_relaxed));
+    m_TimerWheel->Schedule(WakeTime - Cost - PrefetchSlack, std::move(Launch));
+}
+
+void CExecutionManager::RunPrefetch(SFlowPrefetch& Prefetch) noexcept
+{
+    auto Expected = SFlowPrefetch::Scheduled;
+    if (!Prefetch.State.compare_exchange_strong(Expected, SFlowPrefetch::Running, std::memory_order_acq_rel))
+        return;
+
+    const auto StartTime = std::chrono::steady_clock::now();
+    const bool IsSelfContained = Prefetch.Node->PrefetchUpstream(Prefetch.Epoch, Prefetch.IsAdoptable);
+    Prefetch.IsAdoptable &= IsSelfContained;
+    Prefetch.FinishTime = std::chrono::steady_clock::now();
+
+    if (Prefetch.IsAdoptable)
+        Prefetch.Node->m_PrefetchCost.store((Prefetch.FinishTime - StartTime).count(), std::memory_order_relaxed);
+
+    Prefetch.State.store(SFlowPrefetch::Done, std::memory_order_release);
+    Prefetch.State.notify_all();
+}
+
+void CExecutionManager::CancelPrefetch(SFlowContext* Flow) noexcept
+{
+    if (!Flow->HasPrefetch.exchange(false, std::memory_order_acq_rel))
+        return;
+
+    /// Waits for a running one, nodes it touches may go away once the flow is gone
+    if (const auto Prefetch = Flow->Prefetch.exchange(nullptr))
+        Prefetch->Settle();
+}
+
+uint64_t CExecutionManager::AcquireStepEpoch(SFlowContext* Flow, const CExecuteNode* Node) noexcept
+{
+    /// Whichever step comes first after a wait settles its prefetch, meant for this node or not
+    if (Flow == nullptr || !Flow->HasPrefetch.load(std::memory_order_acquire) || !Flow->HasPrefetch.exchange(false, std::memory_order_acq_rel))
+        return AdvanceEpoch();
+
+    const auto Prefetch = Flow->Prefetch.exchange(nullptr);
+    if (Prefetch == nullptr)
+        return AdvanceEpoch();
+
+    /// Nodes refreshed under the epoch are skipped by the step, anything marked dirty since has forgotten it
+    const bool IsFinished = Prefetch->Settle();
+    if (IsFinished && Prefetch->Node == Node && Prefetch->IsAdoptable && std::chrono::steady_clock::now() - Prefetch->FinishTime <= PrefetchMaxAge)
+        return Prefetch->Epoch;
+
+    return AdvanceEpoch();
+}
+
+void CExecutionManager::Execute(CExecuteNode* Target, std::stop_token StopToken, SFlowContext* Flow)
+{
+    Step(Target, StopToken, Flow, false);
+}
+
+CExecuteNode* CExecutionManager::Step(CExecuteNode* Target, const std::stop_token& StopToken, SFlowContext* Flow, const bool CanPark)
+{
+    /// Branches forked from one flow step run concurrently, only the flow's own driver may keep frames across a park
+    std::vector<SFlowFrame> LocalFrames;
+    auto& Frames = CanPark ? Flow->Frames : LocalFrames;
+
+    std::shared_ptr<CExecutionPlan> Plan;
+    while (!m_TerminationFlag.test() && !StopToken.stop_requested()) {
+
+        /// The sub-flow ended, returning to its caller is a step of its own and may call the next one right away
+        if (Target == nullptr) {
+            if (Frames.empty())
+                break;
+
+            const auto Frame = Frames.back();
+            Frames.pop_back();
+
+            if (Flow != nullptr)
+                Flow->SetActiveNode(Frame.Node);
+            CExecuteNode::SFlowStep Step { Flow, StopToken };
+            Target = Advance(Frame.Node, Frame.Node->ReturnFromSubFlow(Step, Frame.State), Step, Frames);
+            continue;
+        }
+
+        if (Plan == nullptr)
+            Plan = GetPlan(Target);
+
+        /// Plan hands back custom flow and suspendable nodes, or everything once it goes stale
+        if ((Target = Plan->Run(*this, Target, StopToken, Flow)) == nullptr || StopToken.stop_requested())
+            continue;
+
+        if (Flow != nullptr) {
+            Flow->AdoptPriority(Target->GetFlowPriority());
+            Flow->SetActiveNode(Target);
+        }
+
+        if (!CanPark || !Target->IsSuspendable()) {
+            CExecuteNode::SFlowStep Step { Flow, StopToken };
+            Target = Advance(Target, Target->ExecuteNode(Step), Step, Frames);
+            continue;
+        }
+
+        /// Outlives this call if the node parks, RunFlow resumes it from the flow
+        auto& Step = Flow->SuspendedStep;
+        Step = { Flow, StopToken };
+        Flow->ParkRendezvous.store(0, std::memory_order_relaxed);
+        if (!Target->StartAsync(Step, [this, Flow] { CheckInParked(Flow); }))
+            return Target;
+
+        Target = Advance(Target, Target->FinishAsync(Step), Step, Frames);
+    }
+
+    Frames.clear();
+    if (Flow != nullptr)
+        Flow->SetActiveNode(nullptr);
+    return nullptr;
+}
+
+CExecuteNode* CExecutionManager::Advance(CExecuteNode* Node, CExecuteNode* Successor, CExecuteNode::SFlowStep& Step, std::vector<SFlowFrame>& Frames)
 {
-    while (Target != nullptr && !m_TerminationFlag.test()) {
-        SetActiveNode(Target);
-        Target = Target->ExecuteNode();
+    CExecuteNode* Start = nullptr;
+    if (SFlowFrame Frame { Node }; Node->TakeSubFlowCall(Step, Start, Frame.State)) {
+        Frames.emplace_back(Frame);
+        return Start;
     }
-    SetActiveNode(nullptr);
+
+    return Successor;
 }
 
-void CExecutionManager::SetActiveNode(CExecuteNode* Node) noexcept
+CExecuteNode* CExecutionManager::GetActiveNode(const FlowId Flow) const noexcept
 {
-    m_ActiveNode = Node;
+    std::lock_guard Lock { m_FlowMutex };
+    if (const auto It = m_Flows.find(Flow); It != m_Flows.end())
+        return It->second->ActiveNode.load(std::memory_order_relaxed);
+    return nullptr;
+}
+
+std::vector<CExecuteNode*> CExecutionManager::GetActiveNodes() const
+{
+    std::lock_guard Lock { m_FlowMutex };
+
+    std::vector<CExecuteNode*> Result;
+    for (const auto& Flow : m_Flows | std::views::values)
+        if (auto* Node = Flow->ActiveNode.load(std::memory_order_relaxed))
+            Result.emplace_back(Node);
+
+    return Result;
+}
+
+void CExecutionManager::RegisterNode(CBaseNode* Node)
+{
+    Node->SetManager(this);
+
+    const auto WatchPin = [this](CPin* Pin) {
+        Pin->AddOnConnectionChanges([this](CPin*, CPin*, bool) { OnGraphChanged(); });
+    };
+
+    for (const auto& Pin : Node->GetInputPins())
+        WatchPin(Pin.get());
+    for (const auto& Pin : Node->GetOutputPins())
+        WatchPin(Pin.get());
+
+    Node->AddOnPinChanges([this, WatchPin](CPin* Pin, const bool NewPin) {
+        if (NewPin)
+            WatchPin(Pin);
+        OnGraphChanged();
+    });
+
+    OnGraphChanged();
 }
 
 void CExecutionManager::UnRegisterNode(CExecuteNode* Node) noexcept
 {
-    if (m_ActiveNode == Node)
-        m_ActiveNode = nullptr;
+    {
+        std::lock_guard Lock { m_FlowMutex };
+        for (const auto& Flow : m_Flows | std::views::values) {
+            auto* Expected = Node;
+            Flow->ActiveNode.compare_exchange_strong(Expected, nullptr, std::memory_order_relaxed);
+
+            /// Left in place so the flow's next step still drops it
+            if (const auto Prefetch = Flow->Prefetch.load(); Prefetch != nullptr && Prefetch->Node == Node)
+                Prefetch->Settle();
+        }
+    }
+
+    /// Plans hold raw node pointers
+    OnGraphChanged();
+}
+
+void CExecutionManager::OnGraphChanged() noexcept
+{
+    m_GraphRevision.fetch_add(1, std::memory_order_relaxed);
+    InvalidatePlans();
+}
+
+void CExecutionManager::InvalidatePlans() noexcept
+{
+    std::lock_guard Lock { m_PlanMutex };
+    for (const auto& Plan : m_Plans | std::views::values)
+        Plan->Invalidate();
+    m_Plans.clear();
+}
+
+SGraphOptimization CExecutionManager::OptimizeGraph(const std::span<CBaseNode* const> Nodes)
+{
+    /// Live data nodes are the upstream closure of every execute node's data inputs
+    std::unordered_set<const CBaseNode*> Live;
+    std::vector<CBaseNode*> Stack;
+
+    const auto PushUpstream = [&](const CBaseNode* Node) {
+        for (const auto& IPin : Node->GetInputPins()) {
+            if (*IPin == EPinType::Data && *IPin) {
+                if (auto* Upstream = IPin->GetTheOnlyConnected()->GetOwner(); *Upstream == ENodeType::Data && Live.insert(Upstream).second)
+                    Stack.push_back(Upstream);
+            }
+        }
+    };
+
+    for (const auto* Node : Nodes)
+        if (*Node == ENodeType::Execution)
+            PushUpstream(Node);
+    while (!Stack.empty()) {
+        const auto* Node = Stack.back();
+        Stack.pop_back();
+        PushUpstream(Node);
+    }
+
+    /// Producers come first in the topological order, so their verdict is known once a consumer is reached
+    auto DataNodes = Nodes | std::views::filter([](const CBaseNode* Node) { return *Node == ENodeType::Data; }) | std::ranges::to<std::vector>();
+    std::ranges::sort(DataNodes, { }, &CBaseNode::GetTopologicalOrder);
+
+    struct SStructure {
+        CBaseNode* Node;
+        std::string Ext;
+    };
+    std::unordered_map<size_t, std::vector<SStructure>> Structures;
+
+    SGraphOptimization Result;
+    bool IsChanged = false;
+    for (auto* Node : DataNodes) {
+        const bool IsDead = !Live.contains(Node);
+
+        /// Unconnected inputs hold constants set by the node itself
+        bool IsFolded = !IsDead && Node->m_IsPure && !Node->m_IsVolatile;
+        for (const auto& IPin : Node->GetInputPins()) {
+            if (IsFolded && *IPin == EPinType::Data && *IPin) {
+                const auto* Upstream = IPin->GetTheOnlyConnected()->GetOwner();
+                IsFolded = *Upstream == ENodeType::Data && Upstream->IsFolded();
+            }
+        }
+
+        /// Upstream duplicates are already resolved, so copies of whole chains collapse onto the first one
+        CBaseNode* SharedWith = nullptr;
+        if (!IsDead && Node->IsShareable()) {
+            std::string Ext;
+            Node->WriteExtraContext(Ext);
+
+            auto& Bucket = Structures[HashStructure(*Node, Ext)];
+            if (const auto It = std::ranges::find_if(Bucket, [&](const SStructure& Other) { return Other.Ext == Ext && IsSameStructure(*Node, *Other.Node); }); It != Bucket.end())
+                SharedWith = It->Node;
+            else
+                Bucket.emplace_back(Node, std::move(Ext));
+        }
+
+        IsChanged |= Node->IsFolded() != IsFolded || Node->IsDead() != IsDead || Node->GetSharedWith() != SharedWith;
+        {
+            /// Flows keep running, one refreshing the node right now finishes with the verdict it started with
+            std::lock_guard Lock { Node->m_RefreshMutex };
+            Node->m_IsFolded.store(IsFolded, std::memory_order_relaxed);
+            Node->m_IsDead.store(IsDead, std::memory_order_relaxed);
+            Node->m_SharedWith.store(SharedWith, std::memory_order_release);
+        }
+
+        Result.Folded += IsFolded;
+        Result.Dead += IsDead;
+        Result.Shared += SharedWith != nullptr;
+    }
+
+    /// Plans collapse folded subgraphs when compiled
+    if (IsChanged)
+        InvalidatePlans();
+
+    return Result;
+}
+
+std::shared_ptr<CExecutionPlan> CExecutionManager::GetPlan(CExecuteNode* Entry)
+{
+    std::lock_guard Lock { m_PlanMutex };
+
+    auto& Plan = m_Plans[Entry];
+    if (Plan == nullptr || Plan->IsStale())
+        Plan = CExecutionPlan::Compile(Entry);
+
+    return Plan;
 }
\ No newline at end of file
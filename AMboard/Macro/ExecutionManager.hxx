@@ -4,38 +4,268 @@
 
 #pragma once
 
+#include "ExecuteNode.hxx"
+#include "FlowTask.hxx"
 #include "MacroDefines.hxx"
+#include "Profiler.hxx"
+#include "TimerWheel.hxx"
+#include "WorkStealingPool.hxx"
 
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
 #include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <stop_token>
 #include <thread>
+#include <unordered_map>
+#include <vector>
+
+class CBaseNode;
+class CExecutionPlan;
+class CGraphTransaction;
+
+using FlowId = uint64_t;
+static constexpr FlowId InvalidFlowId = 0;
+
+struct SFlowStats {
+    std::chrono::steady_clock::duration QueueLatency { };
+    std::chrono::steady_clock::duration RunTime { };
+    uint64_t ExecutedNodes = 0;
+};
+
+/// A node waiting for the sub-flow it called to end, State is handed back to it untouched
+struct SFlowFrame {
+    CExecuteNode* Node = nullptr;
+    uint64_t State = 0;
+};
+
+/// Inputs of the node following a wait, refreshed on the worker pool while the flow is parked
+struct SFlowPrefetch {
+    enum EState : uint8_t {
+        Scheduled,
+        Running,
+        Done,
+        Cancelled
+    };
+
+    const CExecuteNode* Waiting = nullptr;
+    CExecuteNode* Node = nullptr;
+    uint64_t Epoch = 0;
+    /// The step may take over Epoch, only when the wait end was known so volatile nodes ran just before it
+    bool IsAdoptable = false;
+    std::chrono::steady_clock::time_point FinishTime;
+    std::atomic<EState> State { Scheduled };
+
+    /// Keep it from starting, or wait for it if it already did. True if it ran to completion
+    bool Settle() noexcept
+    {
+        auto Current = Scheduled;
+        if (State.compare_exchange_strong(Current, Cancelled, std::memory_order_acq_rel))
+            return false;
+
+        for (; Current == Running; Current = State.load(std::memory_order_acquire))
+            State.wait(Running, std::memory_order_acquire);
+        return Current == Done;
+    }
+};
+
+struct SGraphOptimization {
+    size_t Folded = 0;
+    size_t Dead = 0;
+    size_t Shared = 0;
+};
+
+/// Everything owned by one running flow, shared by all branches it forks
+struct SFlowContext {
+    FlowId Id = InvalidFlowId;
+    CExecuteNode* Entry = nullptr;
+    std::function<void()> OnComplete;
+
+    std::stop_source StopSource;
+    /// Branches forked by StartBranchAsync stop along with whatever forked them
+    std::optional<std::stop_callback<std::function<void()>>> ForwardStop;
+    std::atomic<CExecuteNode*> ActiveNode { };
+    std::atomic<uint64_t> ExecutedNodes { 0 };
+
+    std::chrono::steady_clock::time_point QueuedTime;
+    std::chrono::steady_clock::time_point StartTime;
+
+    /// Inherited from the entry node, changed by nodes with a class of their own. Read whenever the flow is queued
+    std::atomic<EFlowPriority> Priority { EFlowPriority::Normal };
+    /// When the flow last entered the queue, requires the manager's flow lock
+    std::chrono::steady_clock::time_point EnqueueTime;
+
+    /// Where a parked flow continues, Suspended is resumed first with the step that owns its coroutine
+    CExecuteNode* Next = nullptr;
+    CExecuteNode* Suspended = nullptr;
+    CExecuteNode::SFlowStep SuspendedStep;
+    /// Sub-flow callers still to return to, innermost last
+    std::vector<SFlowFrame> Frames;
+    /// Set while parked, settled by whichever step comes next
+    std::atomic<std::shared_ptr<SFlowPrefetch>> Prefetch;
+    std::atomic<bool> HasPrefetch { false };
+    /// The suspending worker and the wake source both check in, the second one requeues the flow
+    std::atomic<uint32_t> ParkRendezvous { 0 };
+
+    void AdoptPriority(const std::optional<EFlowPriority> NodePriority) noexcept
+    {
+        if (NodePriority.has_value())
+            Priority.store(*NodePriority, std::memory_order_relaxed);
+    }
+
+    void SetActiveNode(CExecuteNode* Node) noexcept
+    {
+        ActiveNode.store(Node, std::memory_order_relaxed);
+        if (Node != nullptr)
+            ExecutedNodes.fetch_add(1, std::memory_order_relaxed);
+    }
+};
 
-class CExecuteNode;
 class MACRO_API CExecutionManager {
 
 public:
+    /// Flow workers are persistent, one per core is spawned on demand and more only while queued flows starve.
+    /// On top of those InteractiveFlowWorkers only ever pick up Interactive flows, so triggers start even when every other worker is busy
+    explicit CExecutionManager(size_t MaxFlowWorkers = 64);
     ~CExecutionManager();
 
-    // Starts execution on a dedicated async thread, returning immediately.
-    // Returns false if an async execution is already in flight (bounded reentry).
-    // The optional callback is invoked on the async thread after execution completes.
-    bool StartExecuteAsync(CExecuteNode* Target, std::function<void()> OnComplete = nullptr);
+    /// Queue a flow on the persistent workers and return immediately.
+    /// Returns InvalidFlowId if a flow started from the same entry is still in flight.
+    /// The flow is scheduled in the class of Target's GetFlowPriority.
+    /// The optional callback is invoked on the worker after the flow completes.
+    FlowId StartExecuteAsync(CExecuteNode* Target, std::function<void()> OnComplete = nullptr);
+
+    /// Fork a branch of Parent as a flow of its own, in Parent's class and without the reentry check.
+    /// The branch stops once StopToken does, nothing waits for it unless OnComplete is used to join.
+    /// Returns InvalidFlowId and never calls OnComplete once the manager is shutting down
+    FlowId StartBranchAsync(CExecuteNode* Target, std::stop_token StopToken, const SFlowContext* Parent, std::function<void()> OnComplete);
+
+    /// Request the flow to stop at its next node, long running nodes observe it through IsStopRequested
+    void StopFlow(FlowId Flow) noexcept;
+    void StopAllFlows() noexcept;
 
-    // Returns true if an async trigger execution is currently in flight.
-    [[nodiscard]] bool IsAsyncRunning() const noexcept { return m_AsyncRunning.test(std::memory_order_acquire); }
+    [[nodiscard]] size_t GetRunningFlowCount() const noexcept;
+    [[nodiscard]] std::vector<FlowId> GetRunningFlows() const;
+    [[nodiscard]] std::optional<SFlowStats> GetFlowStats(FlowId Flow) const;
 
-    void Execute(CExecuteNode* Target);
+    /// Run the flow starting at Target on the calling thread, until it ends or StopToken is triggered
+    void Execute(CExecuteNode* Target, std::stop_token StopToken = { }, SFlowContext* Flow = nullptr);
 
-    [[nodiscard]] CExecuteNode* GetActiveNode() const noexcept { return const_cast<CExecuteNode*>(m_ActiveNode); }
-    void SetActiveNode(CExecuteNode* Node) noexcept;
+    [[nodiscard]] CExecuteNode* GetActiveNode(FlowId Flow) const noexcept;
+    /// Active node of every running flow, for highlighting
+    [[nodiscard]] std::vector<CExecuteNode*> GetActiveNodes() const;
 
+    /// Attach the node to this manager, any later pin or connection change invalidates compiled plans
+    void RegisterNode(CBaseNode* Node);
     void UnRegisterNode(CExecuteNode* Node) noexcept;
 
+    /// Drop all compiled plans, flows currently running one fall back to the generic path
+    void InvalidatePlans() noexcept;
+
+    /// Fold pure data nodes fed only by constants and mark data nodes no execute node pulls from as dead.
+    /// Shareable nodes with the same type, Ext and sources are hashed together, duplicates evaluate through the first one.
+    /// Run after loading, whenever GetGraphRevision moved and after a node's Ext changed, Nodes should be the whole board
+    SGraphOptimization OptimizeGraph(std::span<CBaseNode* const> Nodes);
+    /// Bumped on every pin or connection change of a registered node
+    [[nodiscard]] uint64_t GetGraphRevision() const noexcept { return m_GraphRevision.load(std::memory_order_relaxed); }
+
+    /// Pool used to evaluate independent data dependencies concurrently
+    [[nodiscard]] CWorkStealingPool* GetWorkerPool() const noexcept { return m_WorkerPool.get(); }
+    /// Wakes suspended nodes
+    [[nodiscard]] CTimerWheel* GetTimerWheel() const noexcept { return m_TimerWheel.get(); }
+
+#ifdef AMB_ENABLE_PROFILER
+    [[nodiscard]] CProfiler* GetProfiler() const noexcept { return m_Profiler.get(); }
+#endif
+
+    /// Start a new evaluation epoch, never returns 0
+    uint64_t AdvanceEpoch() noexcept { return m_Epoch.fetch_add(1, std::memory_order_relaxed) + 1; }
+    /// Epoch for Node's step, the one its inputs were prefetched under while the flow waited if still fresh
+    uint64_t AcquireStepEpoch(SFlowContext* Flow, const CExecuteNode* Node) noexcept;
+
+    /// Newly registered nodes have no connections yet, so the end of the order is always valid
+    uint64_t AcquireTopologicalOrder() noexcept { return m_NextTopologicalOrder.fetch_add(1, std::memory_order_relaxed); }
+
+    /// Transaction connection changes are currently collected into, if any
+    [[nodiscard]] CGraphTransaction* GetTransaction() const noexcept { return m_Transaction; }
+
     operator bool() const noexcept { return !m_TerminationFlag.test(); }
 
 protected:
+    std::shared_ptr<CExecutionPlan> GetPlan(CExecuteNode* Entry);
+    void OnGraphChanged() noexcept;
+
+    /// Returns the suspended node if CanPark and a suspendable node started waiting.
+    /// Sub-flows run on an explicit frame stack, the flow's own when CanPark so it survives parking
+    CExecuteNode* Step(CExecuteNode* Target, const std::stop_token& StopToken, SFlowContext* Flow, bool CanPark);
+
+    /// Where the flow goes after Node's Step returned Successor, pushes a frame if the node called a sub-flow
+    static CExecuteNode* Advance(CExecuteNode* Node, CExecuteNode* Successor, CExecuteNode::SFlowStep& Step, std::vector<SFlowFrame>& Frames);
+
+    /// Reserved workers wait for Interactive flows only
+    void FlowWorkerLoop(bool IsReserved);
+    /// False if the flow got parked, it is requeued once its suspended node is ready
+    bool RunFlow(const std::shared_ptr<SFlowContext>& Flow);
+    void CheckInParked(SFlowContext* Flow);
+
+    /// Look ahead past the node Flow got parked on and refresh the next node's inputs on the worker pool.
+    /// Timed to finish right before an expected wait end, otherwise only the non-volatile part is refreshed at once
+    void SchedulePrefetch(SFlowContext* Flow, const CExecuteNode* Waiting);
+    static void RunPrefetch(SFlowPrefetch& Prefetch) noexcept;
+    static void CancelPrefetch(SFlowContext* Flow) noexcept;
+    /// Requires m_FlowMutex
+    void EnqueueFlow(std::shared_ptr<SFlowContext> Flow);
+    /// Requires m_FlowMutex and a queued flow the worker may take
+    std::shared_ptr<SFlowContext> PopPendingFlow(bool IsReserved);
+    void GrowIfStarved();
+
+    static constexpr auto FlowStarvationDelay = std::chrono::milliseconds(2);
+    /// Each class below Interactive queues as if it arrived this much later, so waiting low priority flows still get their turn
+    static constexpr auto FlowAgingDelay = std::chrono::milliseconds(50);
+    static constexpr size_t InteractiveFlowWorkers = 1;
+    /// Headroom on top of the measured prefetch cost, and how old a prefetch may get before the step re-evaluates
+    static constexpr auto PrefetchSlack = std::chrono::milliseconds(5);
+    static constexpr auto PrefetchMaxAge = std::chrono::milliseconds(25);
+
     std::atomic_flag m_TerminationFlag;
-    std::atomic_flag m_AsyncRunning {};
-    std::unique_ptr<std::thread> m_AsyncThread;
 
-    volatile CExecuteNode* m_ActiveNode = nullptr;
+    std::atomic<uint64_t> m_Epoch { 0 };
+    std::atomic<uint64_t> m_NextTopologicalOrder { 1 };
+    std::atomic<uint64_t> m_GraphRevision { 0 };
+    std::unique_ptr<CWorkStealingPool> m_WorkerPool;
+    std::unique_ptr<CTimerWheel> m_TimerWheel;
+#ifdef AMB_ENABLE_PROFILER
+    std::unique_ptr<CProfiler> m_Profiler = std::make_unique<CProfiler>();
+#endif
+
+    std::mutex m_PlanMutex;
+    std::unordered_map<const CExecuteNode*, std::shared_ptr<CExecutionPlan>> m_Plans;
+
+    /// Guards everything flow related below
+    mutable std::mutex m_FlowMutex;
+    std::condition_variable m_FlowQueued;
+    std::condition_variable m_InteractiveFlowQueued;
+    std::unordered_map<FlowId, std::shared_ptr<SFlowContext>> m_Flows;
+    /// One queue per EFlowPriority
+    std::array<std::deque<std::shared_ptr<SFlowContext>>, FlowPriorityNames.size()> m_PendingFlows;
+    size_t m_PendingFlowCount = 0;
+    std::vector<std::thread> m_FlowWorkers;
+    size_t m_IdleFlowWorkers = 0;
+    size_t m_ReservedFlowWorkers = 0;
+    size_t m_IdleReservedFlowWorkers = 0;
+    size_t m_BaseFlowWorkers;
+    size_t m_MaxFlowWorkers;
+    bool m_IsGrowthCheckPending = false;
+    FlowId m_NextFlowId = InvalidFlowId + 1;
+
+    /// Graph edits happen on the editor thread only
+    CGraphTransaction* m_Transaction = nullptr;
+
+    friend class CGraphTransaction;
 };
@@ -0,0 +1,199 @@
+#include "ExecutionPlan.hxx"
+
+#include "DataPin.hxx"
+#include "ExecuteNode.hxx"
+#include "ExecutionManager.hxx"
+
+#include <algorithm>
+#include <deque>
+#include <ranges>
+#include <unordered_set>
+
+std::shared_ptr<CExecutionPlan> CExecutionPlan::Compile(CExecuteNode* Entry)
+{
+    auto Plan = std::make_shared<CExecutionPlan>();
+    if (Entry == nullptr) [[unlikely]]
+        return Plan;
+
+    /// Breadth first over flow pins, assign dense indices
+    std::deque<CExecuteNode*> Pending { Entry };
+    std::vector<CExecuteNode*> Nodes;
+    Plan->m_NodeIndex.emplace(Entry, 0);
+
+    while (!Pending.empty()) {
+        auto* Node = Pending.front();
+        Pending.pop_front();
+        Nodes.emplace_back(Node);
+
+        for (const auto* Pin : Node->GetFlowOutputPins()) {
+            if (!*Pin)
+                continue;
+
+            auto* Next = static_cast<CExecuteNode*>(Pin->GetTheOnlyConnected()->GetOwner());
+            if (Plan->m_NodeIndex.emplace(Next, static_cast<uint32_t>(Plan->m_NodeIndex.size())).second)
+                Pending.emplace_back(Next);
+        }
+    }
+
+    Plan->m_Instructions.reserve(Nodes.size());
+    for (auto* Node : Nodes) {
+        SPlanInstruction Instruction { .Node = Node, .HasCustomFlow = Node->m_HasCustomFlow || Node->m_IsSuspendable };
+
+        Instruction.SuccessorBegin = static_cast<uint32_t>(Plan->m_Successors.size());
+        for (const auto* Pin : Node->GetFlowOutputPins())
+            Plan->m_Successors.emplace_back(*Pin ? Plan->m_NodeIndex.at(static_cast<CExecuteNode*>(Pin->GetTheOnlyConnected()->GetOwner())) : NPos);
+        Instruction.SuccessorEnd = static_cast<uint32_t>(Plan->m_Successors.size());
+
+        Instruction.DataBegin = static_cast<uint32_t>(Plan->m_DataSteps.size());
+        Instruction.DataEnd = Plan->AppendDataClosure(Node);
+
+        Instruction.SlotBegin = static_cast<uint32_t>(Plan->m_InputSlots.size());
+        Instruction.SlotEnd = Plan->AppendInputSlots(Node);
+
+        Instruction.HasParallelFanIn = std::ranges::count_if(Plan->m_InputSlots | std::views::drop(Instruction.SlotBegin), [](const auto& Slot) {
+            return *Slot.SourceOwner == ENodeType::Data;
+        }) > 1;
+
+        Plan->m_Instructions.emplace_back(Instruction);
+    }
+
+    return Plan;
+}
+
+uint32_t CExecutionPlan::AppendDataClosure(CBaseNode* Consumer)
+{
+    /// Iterative post-order over upstream data nodes, producers land before consumers
+    std::unordered_set<CBaseNode*> Visited;
+    std::vector<std::pair<CBaseNode*, bool>> Stack;
+
+    const auto PushUpstream = [&](const CBaseNode* Node) {
+        for (const auto& IPin : Node->GetInputPins()) {
+            if (*IPin == EPinType::Data && *IPin) {
+                auto* Upstream = IPin->GetTheOnlyConnected()->GetOwner();
+                if (*Upstream == ENodeType::Data && !Visited.contains(Upstream))
+                    Stack.emplace_back(Upstream, false);
+            }
+        }
+    };
+
+    PushUpstream(Consumer);
+    while (!Stack.empty()) {
+        auto [Node, Expanded] = Stack.back();
+        Stack.pop_back();
+
+        if (Expanded) {
+            const auto SlotBegin = static_cast<uint32_t>(m_InputSlots.size());
+            m_DataSteps.emplace_back(Node, SlotBegin, AppendInputSlots(Node));
+            continue;
+        }
+
+        /// Also guards against data cycles
+        if (!Visited.insert(Node).second)
+            continue;
+
+        if (Node->IsFolded()) {
+            const auto SlotBegin = static_cast<uint32_t>(m_InputSlots.size());
+            m_DataSteps.emplace_back(Node, SlotBegin, SlotBegin, true);
+            continue;
+        }
+
+        Stack.emplace_back(Node, true);
+        PushUpstream(Node);
+    }
+
+    return static_cast<uint32_t>(m_DataSteps.size());
+}
+
+uint32_t CExecutionPlan::AppendInputSlots(CBaseNode* Node)
+{
+    for (const auto& IPin : Node->GetInputPins()) {
+        if (*IPin == EPinType::Data && *IPin) {
+            const auto* Source = IPin->GetTheOnlyConnected()->As<CDataPin>();
+            m_InputSlots.emplace_back(IPin->As<CDataPin>(), Source, Source->GetOwner());
+        }
+    }
+
+    return static_cast<uint32_t>(m_InputSlots.size());
+}
+
+CExecuteNode* CExecutionPlan::Run(CExecutionManager& Manager, CExecuteNode* Start, const std::stop_token& StopToken, SFlowContext* Flow) const
+{
+    const auto StartIt = m_NodeIndex.find(Start);
+    if (StartIt == m_NodeIndex.end())
+        return Start;
+
+    const auto AssignSlots = [this](const uint32_t Begin, const uint32_t End) {
+        for (auto Index = Begin; Index < End; ++Index)
+            m_InputSlots[Index].Target->Assign(m_InputSlots[Index].Source);
+    };
+
+    uint32_t Index = StartIt->second;
+    while (Index != NPos) {
+        const auto& Instruction = m_Instructions[Index];
+        if (Instruction.HasCustomFlow || IsStale() || !Manager || StopToken.stop_requested())
+            return Instruction.Node;
+
+        auto* Node = Instruction.Node;
+        if (Flow != nullptr) {
+            Flow->AdoptPriority(Node->m_FlowPriority);
+            Flow->SetActiveNode(Node);
+        }
+
+        CExecuteNode::SFlowStep Step { Flow, StopToken };
+        const auto Epoch = Step.Epoch = Manager.AcquireStepEpoch(Flow, Node);
+
+        {
+            AMB_PROFILE_NODE(*Node, PrepareInput);
+
+            /// Independent producers go through the pooled refresh instead of the flat sequence
+            const bool IsParallel = Instruction.HasParallelFanIn && Manager.GetWorkerPool() != nullptr;
+            if (IsParallel)
+                Node->RefreshUpstream(Epoch);
+
+            for (auto DataIndex = IsParallel ? Instruction.DataEnd : Instruction.DataBegin; DataIndex < Instruction.DataEnd; ++DataIndex) {
+                const auto& DataStep = m_DataSteps[DataIndex];
+                auto* DataNode = DataStep.Node;
+
+                if (DataStep.IsFolded) {
+                    if (DataNode->IsDirty())
+                        DataNode->Refresh(Epoch);
+                    continue;
+                }
+
+                /// Concurrent flows may share producers
+                std::lock_guard Lock { DataNode->m_RefreshMutex };
+                /// Shared producer already handled this step
+                if (DataNode->m_RefreshEpoch.load(std::memory_order_relaxed) == Epoch)
+                    continue;
+                DataNode->m_RefreshEpoch.store(Epoch, std::memory_order_relaxed);
+
+                bool NeedsEvaluation = DataNode->IsDirty() || DataNode->m_IsVolatile;
+                for (auto SlotIndex = DataStep.SlotBegin; !NeedsEvaluation && SlotIndex < DataStep.SlotEnd; ++SlotIndex)
+                    NeedsEvaluation = m_InputSlots[SlotIndex].Target->GetSourceVersion() != m_InputSlots[SlotIndex].SourceOwner->GetVersion();
+
+                if (NeedsEvaluation) {
+                    AssignSlots(DataStep.SlotBegin, DataStep.SlotEnd);
+                    DataNode->EvaluatePrepared();
+                }
+            }
+        }
+
+        {
+            /// The node's own input pins are shared with other flows passing through it
+            std::lock_guard Lock { Node->m_StepMutex };
+            AssignSlots(Instruction.SlotBegin, Instruction.SlotEnd);
+
+            Step.IsInputPrepared = true;
+            const CExecuteNode::CStepScope Scope { Step };
+            AMB_PROFILE_NODE(*Node, Execute);
+            Node->Execute();
+        }
+        ++Node->m_Version;
+
+        /// Compared as a count so NoPin can't wrap around into a valid successor
+        const auto Desired = Step.DesiredOutputPin;
+        Index = Desired < Instruction.SuccessorEnd - Instruction.SuccessorBegin ? m_Successors[Instruction.SuccessorBegin + Desired] : NPos;
+    }
+
+    return nullptr;
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include "MacroDefines.hxx"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <stop_token>
+#include <unordered_map>
+#include <vector>
+
+class CBaseNode;
+class CDataPin;
+class CExecuteNode;
+class CExecutionManager;
+struct SFlowContext;
+
+struct SPlanInputSlot {
+    CDataPin* Target;
+    const CDataPin* Source;
+    const CBaseNode* SourceOwner;
+};
+
+struct SPlanDataStep {
+    CBaseNode* Node;
+    uint32_t SlotBegin, SlotEnd;
+    /// Root of a folded subgraph, only refreshed while dirty and its upstream is left out of the plan
+    bool IsFolded = false;
+};
+
+struct SPlanInstruction {
+    CExecuteNode* Node;
+    /// Node decides its own successor or may suspend, handed back to the caller
+    bool HasCustomFlow;
+    /// More than one data producer feeds the node, worth refreshing on the worker pool
+    bool HasParallelFanIn;
+
+    uint32_t SuccessorBegin, SuccessorEnd;
+    uint32_t SlotBegin, SlotEnd;
+    /// Upstream data nodes in evaluation order
+    uint32_t DataBegin, DataEnd;
+};
+
+/// A board lowered into dense arrays, so the hot loop never walks the pin graph
+class MACRO_API CExecutionPlan {
+
+public:
+    static constexpr uint32_t NPos = static_cast<uint32_t>(-1);
+
+    /// Lower every node reachable from Entry
+    static std::shared_ptr<CExecutionPlan> Compile(CExecuteNode* Entry);
+
+    /// Run from Start until the flow ends, a custom flow node is reached, the plan goes stale or the flow is stopped.
+    /// Returns the node the caller should continue from with the generic path
+    CExecuteNode* Run(CExecutionManager& Manager, CExecuteNode* Start, const std::stop_token& StopToken, SFlowContext* Flow) const;
+
+    [[nodiscard]] bool Contains(const CExecuteNode* Node) const noexcept { return m_NodeIndex.contains(Node); }
+
+    void Invalidate() noexcept { m_Stale.test_and_set(std::memory_order_release); }
+    [[nodiscard]] bool IsStale() const noexcept { return m_Stale.test(std::memory_order_acquire); }
+
+protected:
+    uint32_t AppendDataClosure(CBaseNode* Consumer);
+    uint32_t AppendInputSlots(CBaseNode* Node);
+
+    std::vector<SPlanInstruction> m_Instructions;
+    std::vector<uint32_t> m_Successors;
+    std::vector<SPlanInputSlot> m_InputSlots;
+    std::vector<SPlanDataStep> m_DataSteps;
+
+    /// Only used to enter the plan, never on the hot path
+    std::unordered_map<const CExecuteNode*, uint32_t> m_NodeIndex;
+
+    std::atomic_flag m_Stale;
+};
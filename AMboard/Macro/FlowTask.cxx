@@ -0,0 +1,64 @@
+#include "FlowTask.hxx"
+
+bool CFlowTask::Resume()
+{
+    if (IsDone())
+        return true;
+
+    m_Handle.resume();
+    if (!m_Handle.done())
+        return false;
+
+    if (auto Exception = std::exchange(m_Handle.promise().Exception, nullptr))
+        std::rethrow_exception(Exception);
+
+    return true;
+}
+
+void CFlowTask::Reset() noexcept
+{
+    if (m_Handle)
+        std::exchange(m_Handle, nullptr).destroy();
+}
+
+void CFlowEvent::Set()
+{
+    std::vector<std::function<void()>> Waiters;
+    {
+        std::lock_guard Lock { m_Mutex };
+        if (m_IsSet)
+            return;
+
+        m_IsSet = true;
+        Waiters.swap(m_Waiters);
+    }
+    m_SetSignal.notify_all();
+
+    for (auto& Func : Waiters)
+        Func();
+}
+
+bool CFlowEvent::IsSet() const noexcept
+{
+    std::lock_guard Lock { m_Mutex };
+    return m_IsSet;
+}
+
+void CFlowEvent::Wait() const
+{
+    std::unique_lock Lock { m_Mutex };
+    m_SetSignal.wait(Lock, [this] { return m_IsSet; });
+}
+
+void CFlowEvent::OnSet(std::function<void()> Func)
+{
+    {
+        std::lock_guard Lock { m_Mutex };
+        if (!m_IsSet) {
+            m_Waiters.emplace_back(std::move(Func));
+            return;
+        }
+    }
+
+    Func();
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include "MacroDefines.hxx"
+
+#include <condition_variable>
+#include <coroutine>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+/// Coroutine returned by CExecuteNode::ExecuteAsync.
+/// Starts suspended, the flow driving it decides on which thread it resumes
+class MACRO_API CFlowTask {
+
+public:
+    struct promise_type {
+        CFlowTask get_return_object() noexcept { return CFlowTask { std::coroutine_handle<promise_type>::from_promise(*this) }; }
+        std::suspend_always initial_suspend() noexcept { return { }; }
+        std::suspend_always final_suspend() noexcept { return { }; }
+        void return_void() noexcept { }
+        void unhandled_exception() noexcept { Exception = std::current_exception(); }
+
+        std::exception_ptr Exception;
+    };
+
+    CFlowTask() = default;
+    CFlowTask(CFlowTask&& Other) noexcept
+        : m_Handle(std::exchange(Other.m_Handle, nullptr))
+    {
+    }
+    CFlowTask& operator=(CFlowTask&& Other) noexcept
+    {
+        if (this != &Other) {
+            Reset();
+            m_Handle = std::exchange(Other.m_Handle, nullptr);
+        }
+        return *this;
+    }
+    ~CFlowTask() { Reset(); }
+
+    /// Run until the next suspension point, true once the coroutine finished. Rethrows what the body threw
+    bool Resume();
+
+    [[nodiscard]] bool IsDone() const noexcept { return !m_Handle || m_Handle.done(); }
+
+    void Reset() noexcept;
+
+protected:
+    explicit CFlowTask(const std::coroutine_handle<promise_type> Handle) noexcept
+        : m_Handle(Handle)
+    {
+    }
+
+    std::coroutine_handle<promise_type> m_Handle;
+};
+
+/// One shot, thread safe event suspended nodes can wait on
+class MACRO_API CFlowEvent {
+
+public:
+    void Set();
+    [[nodiscard]] bool IsSet() const noexcept;
+
+    /// Block the calling thread until set
+    void Wait() const;
+
+    /// Invoke Func once set, immediately if already set
+    void OnSet(std::function<void()> Func);
+
+protected:
+    mutable std::mutex m_Mutex;
+    mutable std::condition_variable m_SetSignal;
+    bool m_IsSet = false;
+    std::vector<std::function<void()>> m_Waiters;
+};
@@ -0,0 +1,104 @@
+#include "GraphTransaction.hxx"
+#include "ExecutionManager.hxx"
+
+#include <algorithm>
+#include <utility>
+
+CGraphTransaction::CGraphTransaction(CExecutionManager& Manager) noexcept
+    : m_Manager(Manager)
+{
+    if (m_Manager.m_Transaction == nullptr) {
+        m_Manager.m_Transaction = this;
+        m_IsOwner = true;
+    }
+}
+
+CGraphTransaction::~CGraphTransaction()
+{
+    Commit();
+}
+
+CGraphTransaction* CGraphTransaction::Find(const CExecutionManager* Manager) noexcept
+{
+    return Manager != nullptr ? Manager->m_Transaction : nullptr;
+}
+
+void CGraphTransaction::Commit() noexcept
+{
+    if (!m_IsOwner)
+        return;
+
+    /// Detach first, listeners making further changes get them delivered directly
+    m_Manager.m_Transaction = nullptr;
+    m_IsOwner = false;
+
+    const auto Changes = std::exchange(m_Changes, { });
+    m_PendingByPin.clear();
+    m_FirstPending = 0;
+
+    for (const auto& Change : Changes) {
+        if (!Change.IsSettled)
+            Change.Dispatch(Change.Pin, Change.Other, Change.IsAdded);
+    }
+}
+
+bool CGraphTransaction::Defer(CPin* Pin, CPin* Other, const bool IsAdded, const DispatchFunc Dispatch)
+{
+    if (!m_IsOwner)
+        return false;
+
+    if (const auto It = m_PendingByPin.find(Pin); Other != nullptr && It != m_PendingByPin.end()) {
+        for (const auto Index : It->second) {
+            if (auto& Change = m_Changes[Index]; Change.Other != nullptr && (Change.Pin == Other || Change.Other == Other)) {
+                /// Connect then disconnect (or the reverse) nets out to nothing
+                if (Change.IsAdded != IsAdded)
+                    Settle(Index);
+                return true;
+            }
+        }
+    }
+
+    const auto Index = m_Changes.size();
+    m_Changes.push_back({ .Pin = Pin, .Other = Other, .IsAdded = IsAdded, .Dispatch = Dispatch });
+    m_PendingByPin[Pin].push_back(Index);
+    if (Other != nullptr)
+        m_PendingByPin[Other].push_back(Index);
+    return true;
+}
+
+void CGraphTransaction::Flush(CPin* Pin) noexcept
+{
+    const auto It = m_PendingByPin.find(Pin);
+    if (It == m_PendingByPin.end())
+        return;
+
+    /// Earlier changes go first, listeners may not know the other side of a connection before its pin was added
+    for (const auto Last = std::ranges::max(It->second); m_FirstPending <= Last;) {
+        /// Advanced first, a listener destroying a pin flushes again from here
+        const auto Index = m_FirstPending++;
+        if (m_Changes[Index].IsSettled)
+            continue;
+
+        /// Copied, listeners may add changes of their own
+        const auto Change = m_Changes[Index];
+        Settle(Index);
+        Change.Dispatch(Change.Pin, Change.Other, Change.IsAdded);
+    }
+}
+
+void CGraphTransaction::Settle(const size_t Index) noexcept
+{
+    auto& Change = m_Changes[Index];
+    Change.IsSettled = true;
+
+    for (auto* Side : { Change.Pin, Change.Other }) {
+        if (Side == nullptr)
+            continue;
+
+        if (const auto It = m_PendingByPin.find(Side); It != m_PendingByPin.end()) {
+            std::erase(It->second, Index);
+            if (It->second.empty())
+                m_PendingByPin.erase(It);
+        }
+    }
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include "MacroDefines.hxx"
+
+#include <unordered_map>
+#include <vector>
+
+class CPin;
+class CExecutionManager;
+
+/// Collects connection changes and pin additions or removals made on a board and delivers them coalesced on commit,
+/// a transaction opened while another one is active simply joins it
+class MACRO_API CGraphTransaction {
+
+public:
+    /// Hands one change to its listeners, Other is null for a pin being added or removed
+    using DispatchFunc = void (*)(CPin* Pin, CPin* Other, bool IsAdded) noexcept;
+
+    explicit CGraphTransaction(CExecutionManager& Manager) noexcept;
+    ~CGraphTransaction();
+
+    CGraphTransaction(const CGraphTransaction&) = delete;
+    CGraphTransaction(CGraphTransaction&&) = delete;
+    CGraphTransaction& operator=(const CGraphTransaction&) = delete;
+    CGraphTransaction& operator=(CGraphTransaction&&) = delete;
+
+    /// Transaction currently open on Manager, if any
+    [[nodiscard]] static CGraphTransaction* Find(const CExecutionManager* Manager) noexcept;
+
+    /// Deliver the net changes, anything after this is delivered right away
+    void Commit() noexcept;
+
+    /// False if the caller has to deliver the change itself.
+    /// IsAdded is a connection being made, or with Other null a pin being added
+    bool Defer(CPin* Pin, CPin* Other, bool IsAdded, DispatchFunc Dispatch);
+
+    /// Deliver everything pending up to the last change involving this pin, in order, it is about to lose its connections or die
+    void Flush(CPin* Pin) noexcept;
+
+protected:
+    struct SChange {
+        CPin* Pin;
+        CPin* Other;
+        bool IsAdded;
+        DispatchFunc Dispatch;
+        bool IsSettled = false;
+    };
+
+    void Settle(size_t Index) noexcept;
+
+    CExecutionManager& m_Manager;
+    bool m_IsOwner = false;
+
+    std::vector<SChange> m_Changes;
+    /// Everything before it is settled
+    size_t m_FirstPending = 0;
+
+    /// Unsettled changes by either of their pins, degrees are small so a linear scan per pin is enough
+    std::unordered_map<CPin*, std::vector<size_t>> m_PendingByPin;
+};
@@ -50,14 +50,17 @@
 // ─────────────────────────────────────────────────────────────────────────────
 // Per-plugin: generate create/destroy functions
 // ─────────────────────────────────────────────────────────────────────────────
-#define MACRO_FACTORY(Name)                           \
-    NODE_EXT_EXPORT CBaseNode* create_##Name()        \
-    {                                                 \
-        return new Name();                            \
-    }                                                 \
-    NODE_EXT_EXPORT void destroy_##Name(CBaseNode* p) \
-    {                                                 \
-        delete p;                                     \
+#define MACRO_FACTORY(Name)                                \
+    NODE_EXT_EXPORT void destroy_##Name(CBaseNode* p)      \
+    {                                                      \
+        delete p;                                          \
+    }                                                      \
+    NODE_EXT_EXPORT CBaseNode* create_##Name()             \
+    {                                                      \
+        auto* Node = new Name();                           \
+        DeduceNodeTraits(Node);                            \
+        Node->SetFactory(&create_##Name, &destroy_##Name); \
+        return Node;                                       \
     }
 
 #define MACRO_NAME_ENTRY(Name) STRINGIFY(Name)
@@ -70,10 +73,17 @@
 //   - create_Bar / destroy_Bar
 //   - create_Baz / destroy_Baz
 //   - get_macro_names() -> { "Foo", "Bar", "Baz", nullptr }
+//   - set_type_registry(), points MacroSharedLib at the host's type registry
 // ─────────────────────────────────────────────────────────────────────────────
-#define REGISTER_MACROS(...)                              \
-    FOR_EACH(MACRO_FACTORY, __VA_ARGS__)                  \
-                                                          \
+#define REGISTER_MACROS(...)                                    \
+    FOR_EACH(MACRO_FACTORY, __VA_ARGS__)                        \
+                                                                \
+    MACRO_API void SetTypeRegistry(class CTypeRegistry*) noexcept; \
+    NODE_EXT_EXPORT void set_type_registry(void* Registry)      \
+    {                                                           \
+        SetTypeRegistry(static_cast<CTypeRegistry*>(Registry)); \
+    }                                                           \
+                                                                \
     NODE_EXT_EXPORT const char** get_macro_names()        \
     {                                                     \
         static const char* names[] = {                    \
@@ -83,6 +93,15 @@
         return names;                                     \
     }
 
+// Collections generic nodes such as Map may walk, called by the host once the type registry is shared
+// REGISTER_COLLECTIONS(MakeVectorTraits<cv::Mat>(MakeDataType("vector<cv::Mat>"), MakeDataType("cv::Mat")))
+#define REGISTER_COLLECTIONS(...)                               \
+    NODE_EXT_EXPORT void register_collections()                 \
+    {                                                           \
+        for (const SCollectionTraits& Traits : { __VA_ARGS__ }) \
+            CTypeRegistry::Get().RegisterCollection(Traits);    \
+    }
+
 #define ENABLE_IMGUI()                                             \
     NODE_EXT_EXPORT void set_imgui_context(void* ctx)                              \
     {                                                              \
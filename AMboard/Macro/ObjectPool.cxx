@@ -0,0 +1,59 @@
+#include "ObjectPool.hxx"
+
+#include <new>
+
+namespace {
+constexpr size_t SizeClassOf(const size_t Size) noexcept
+{
+    return (Size + CObjectPool::Granularity - 1) / CObjectPool::Granularity - 1;
+}
+}
+
+CObjectPool& CObjectPool::Get() noexcept
+{
+    /// Never destroyed, plugins may still release nodes during static teardown
+    static auto* Pool = new CObjectPool;
+    return *Pool;
+}
+
+void* CObjectPool::Allocate(const size_t Size)
+{
+    if (Size == 0 || Size > MaxPooledSize)
+        return ::operator new(Size);
+
+    const auto Class = SizeClassOf(Size);
+    const auto BlockSize = (Class + 1) * Granularity;
+
+    std::lock_guard Lock { m_Mutex };
+    if (auto* Block = m_FreeLists[Class]) {
+        m_FreeLists[Class] = Block->Next;
+        return Block;
+    }
+
+    if (m_ChunkCursor == nullptr || m_ChunkEnd - m_ChunkCursor < static_cast<std::ptrdiff_t>(BlockSize)) {
+        /// Tail of the old chunk is abandoned, it is smaller than the block we need
+        auto& Chunk = m_Chunks.emplace_back(std::make_unique_for_overwrite<std::byte[]>(ChunkSize));
+        m_ChunkCursor = Chunk.get();
+        m_ChunkEnd = m_ChunkCursor + ChunkSize;
+    }
+
+    auto* Result = m_ChunkCursor;
+    m_ChunkCursor += BlockSize;
+    return Result;
+}
+
+void CObjectPool::Deallocate(void* Ptr, const size_t Size) noexcept
+{
+    if (Ptr == nullptr)
+        return;
+
+    if (Size == 0 || Size > MaxPooledSize) {
+        ::operator delete(Ptr);
+        return;
+    }
+
+    const auto Class = SizeClassOf(Size);
+
+    std::lock_guard Lock { m_Mutex };
+    m_FreeLists[Class] = new (Ptr) SFreeBlock { m_FreeLists[Class] };
+}
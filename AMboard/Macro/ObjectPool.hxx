@@ -0,0 +1,43 @@
+#pragma once
+
+#include "MacroDefines.hxx"
+
+#include <array>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+/// Size class free lists carved out of large chunks, nodes and pins of a board end up packed next to each other
+class MACRO_API CObjectPool {
+
+public:
+    static constexpr size_t Granularity = alignof(std::max_align_t);
+    static constexpr size_t MaxPooledSize = 1024;
+    static constexpr size_t ChunkSize = 64 * 1024;
+
+    /// Pool of this module, objects always return to the module that created them through their deleting destructor
+    static CObjectPool& Get() noexcept;
+
+    void* Allocate(size_t Size);
+    void Deallocate(void* Ptr, size_t Size) noexcept;
+
+protected:
+    struct SFreeBlock {
+        SFreeBlock* Next;
+    };
+
+    std::mutex m_Mutex;
+    std::array<SFreeBlock*, MaxPooledSize / Granularity> m_FreeLists { };
+
+    std::vector<std::unique_ptr<std::byte[]>> m_Chunks;
+    std::byte* m_ChunkCursor = nullptr;
+    std::byte* m_ChunkEnd = nullptr;
+};
+
+/// Routes a class hierarchy's new/delete through CObjectPool
+#define POOLED_ALLOCATION()                                                                                                        \
+    static void* operator new(const size_t Size) { return CObjectPool::Get().Allocate(Size); }                                     \
+    static void operator delete(void* Ptr, const size_t Size) noexcept { CObjectPool::Get().Deallocate(Ptr, Size); }               \
+    static void* operator new(const size_t Size, const std::align_val_t Align) { return ::operator new(Size, Align); }             \
+    static void operator delete(void* Ptr, const size_t Size, const std::align_val_t Align) noexcept { ::operator delete(Ptr, Size, Align); }
@@ -3,9 +3,12 @@
 //
 
 #include "Pin.hxx"
+#include "BaseNode.hxx"
+#include "GraphTransaction.hxx"
 
 #include <Util/Assertions.hxx>
 
+#include <algorithm>
 #include <stdexcept>
 #include <utility>
 
@@ -13,8 +16,8 @@
 
 void CPin::AddPin(CPin* NewPin) noexcept
 {
-    if (const auto It = m_ConnectedPins.find(NewPin); It == m_ConnectedPins.end()) {
-        m_ConnectedPins.insert(It, NewPin);
+    if (!m_ConnectedPins.contains(NewPin)) {
+        m_ConnectedPins.push_back(NewPin);
     }
 }
 
@@ -40,25 +43,21 @@ bool CPin::ConnectPin(CPin* NewPin) noexcept
     AddPin(NewPin);
     NewPin->AddPin(this);
 
-    for (const auto& Func : m_OnConnectionChanges)
-        Func(this, NewPin, true);
-    for (const auto& Func : NewPin->m_OnConnectionChanges)
-        Func(NewPin, this, true);
-
+    NotifyConnectionChange(this, NewPin, true);
     return true;
 }
 
 bool CPin::DisconnectPin(CPin* TargetPin) noexcept
 {
-    if (const auto It = m_ConnectedPins.find(TargetPin); It != m_ConnectedPins.end()) {
+    if (const auto It = std::ranges::find(m_ConnectedPins, TargetPin); It != m_ConnectedPins.end()) {
         m_ConnectedPins.erase(It);
-        TargetPin->DisconnectPin(this); /// Make sure to do it second to avoid infinite looping
 
-        for (const auto& Func : m_OnConnectionChanges)
-            Func(this, TargetPin, false);
-        for (const auto& Func : TargetPin->m_OnConnectionChanges)
-            Func(TargetPin, this, false);
+        /// Only the side that started the disconnection notifies, the nested call sees itself already gone
+        const bool IsInitiator = TargetPin->IsConnected(this);
+        TargetPin->DisconnectPin(this); /// Make sure to do it second to avoid infinite looping
 
+        if (IsInitiator)
+            NotifyConnectionChange(this, TargetPin, false);
         return true;
     }
 
@@ -67,16 +66,21 @@ bool CPin::DisconnectPin(CPin* TargetPin) noexcept
 
 void CPin::DisconnectPins() noexcept
 {
-    /// FIXME: This is O(n log n), not good
-    while (!m_ConnectedPins.empty()) {
-        CPin::DisconnectPin(*m_ConnectedPins.begin());
+    /// Take the whole list at once, each other side then only scans its own connections
+    for (auto* Other : std::exchange(m_ConnectedPins, { })) {
+        Other->DisconnectPin(this);
+        NotifyConnectionChange(this, Other, false);
     }
+
+    /// Callers tear down their view of the pin right after, what did not net out is delivered now
+    if (auto* Transaction = CGraphTransaction::Find(m_Owner->GetManager()))
+        Transaction->Flush(this);
 }
 
 CPin* CPin::GetTheOnlyConnected() const
 {
     MAKE_SURE(m_ConnectedPins.size() == 1)
-    return *m_ConnectedPins.begin();
+    return m_ConnectedPins.front();
 }
 
 bool CPin::IsConnected(CPin* TargetPin) const noexcept
@@ -87,4 +91,20 @@ bool CPin::IsConnected(CPin* TargetPin) const noexcept
 bool CPin::Compatible(CPin* NewPin) noexcept
 {
     return NewPin != nullptr && NewPin->m_PinType == m_PinType && NewPin->m_IsInputPin != m_IsInputPin && !IsConnected(NewPin);
+}
+
+void CPin::NotifyConnectionChange(CPin* Pin, CPin* Other, const bool IsConnect) noexcept
+{
+    if (auto* Transaction = CGraphTransaction::Find(Pin->m_Owner->GetManager()); Transaction != nullptr && Transaction->Defer(Pin, Other, IsConnect, &DispatchConnectionChange))
+        return;
+
+    DispatchConnectionChange(Pin, Other, IsConnect);
+}
+
+void CPin::DispatchConnectionChange(CPin* Pin, CPin* Other, const bool IsConnect) noexcept
+{
+    for (const auto& Func : Pin->m_OnConnectionChanges)
+        Func(Pin, Other, IsConnect);
+    for (const auto& Func : Other->m_OnConnectionChanges)
+        Func(Other, Pin, IsConnect);
 }
\ No newline at end of file
@@ -5,12 +5,13 @@
 #pragma once
 
 #include <functional>
-#include <list>
 #include <type_traits>
-
-#include <unordered_set>
+#include <utility>
+#include <vector>
 
 #include "MacroDefines.hxx"
+#include "ObjectPool.hxx"
+#include "SmallVector.hxx"
 
 #include <string_view>
 
@@ -27,7 +28,13 @@ protected:
     virtual void AddPin(CPin* NewPin) noexcept;
     virtual void PreConnectPin(CPin* NewPin) noexcept { }
 
+    /// Fire both sides' callbacks, or leave them to the board's open transaction
+    static void NotifyConnectionChange(CPin* Pin, CPin* Other, bool IsConnect) noexcept;
+    static void DispatchConnectionChange(CPin* Pin, CPin* Other, bool IsConnect) noexcept;
+
 public:
+    POOLED_ALLOCATION()
+
     CPin(CBaseNode* Owner, bool IsInputPin) noexcept;
 
     CPin(const CPin&) = delete;
@@ -42,6 +49,7 @@ public:
 
     virtual bool ConnectPin(CPin* NewPin) noexcept;
     virtual bool DisconnectPin(CPin* TargetPin) noexcept;
+    /// Changes still pending in the board's transaction are delivered before returning
     void DisconnectPins() noexcept;
 
     [[nodiscard]] CPin* GetTheOnlyConnected() const;
@@ -57,7 +65,7 @@ public:
     template <typename Self>
     decltype(auto) GetConnections(this Self&& s) noexcept
     {
-        return static_cast<std::add_const_t<decltype(s.m_ConnectedPins)>>(s.m_ConnectedPins);
+        return std::as_const(s.m_ConnectedPins);
     }
 
     auto AddOnConnectionChanges(auto&& Func)
@@ -79,7 +87,8 @@ protected:
 
     CBaseNode* m_Owner = nullptr;
 
-    std::unordered_set<CPin*> m_ConnectedPins;
+    /// Data inputs and flow outputs never hold more than one
+    CSmallVector<CPin*, 1> m_ConnectedPins;
 
-    std::list<std::function<void(CPin* This, CPin* Other, bool IsConnect)>> m_OnConnectionChanges;
+    std::vector<std::function<void(CPin* This, CPin* Other, bool IsConnect)>> m_OnConnectionChanges;
 };
\ No newline at end of file
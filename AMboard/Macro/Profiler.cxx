@@ -0,0 +1,187 @@
+#include "Profiler.hxx"
+
+/// Nodes only carry a profile when instrumentation is compiled in
+#ifdef AMB_ENABLE_PROFILER
+
+#include "BaseNode.hxx"
+
+#include <algorithm>
+#include <format>
+#include <fstream>
+
+namespace {
+std::atomic<uint64_t> GNextProfilerId { 1 };
+
+struct SThreadBufferCache {
+    uint64_t ProfilerId = 0;
+    void* Buffer = nullptr;
+};
+thread_local SThreadBufferCache GThreadBufferCache;
+
+constexpr std::string_view SlotName(const EProfileSlot Slot) noexcept
+{
+    switch (Slot) {
+    case EProfileSlot::Execute:
+        return "Execute";
+    case EProfileSlot::Evaluate:
+        return "Evaluate";
+    case EProfileSlot::PrepareInput:
+        return "PrepareInput";
+    case EProfileSlot::Resume:
+        return "Resume";
+    }
+
+    return "Unknown";
+}
+
+void AppendJsonEscaped(std::string& Out, const std::string_view Text)
+{
+    for (const char Char : Text) {
+        if (Char == '"' || Char == '\\')
+            Out += '\\';
+        if (static_cast<unsigned char>(Char) < 0x20)
+            Out += std::format("\\u{:04x}", Char);
+        else
+            Out += Char;
+    }
+}
+}
+
+CProfiler::CProfiler()
+    : m_Id(GNextProfilerId.fetch_add(1, std::memory_order_relaxed))
+    , m_Origin(Clock::now())
+{
+}
+
+CProfiler::~CProfiler() = default;
+
+void CProfiler::Record(CBaseNode& Node, const EProfileSlot Slot, const Clock::time_point Start, const Clock::time_point End) noexcept
+{
+    const auto Duration = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(End - Start).count());
+
+    auto& Profile = Node.m_Profile;
+    switch (Slot) {
+    case EProfileSlot::Execute:
+        if (Node != ENodeType::Data)
+            Profile.Calls.fetch_add(1, std::memory_order_relaxed);
+        Profile.ExecuteNs.fetch_add(Duration, std::memory_order_relaxed);
+        break;
+    case EProfileSlot::Evaluate:
+        /// Execute nodes chaining into CBaseNode::Evaluate are already counted by their Execute
+        if (Node == ENodeType::Data)
+            Profile.Calls.fetch_add(1, std::memory_order_relaxed);
+        Profile.EvaluateNs.fetch_add(Duration, std::memory_order_relaxed);
+        break;
+    case EProfileSlot::Resume:
+        Profile.ExecuteNs.fetch_add(Duration, std::memory_order_relaxed);
+        break;
+    case EProfileSlot::PrepareInput:
+        Profile.PrepareInputNs.fetch_add(Duration, std::memory_order_relaxed);
+        break;
+    }
+
+    if (!IsCapturing()) [[likely]]
+        return;
+
+    try {
+        auto& Buffer = GetThreadBuffer();
+        std::lock_guard Lock { Buffer.Mutex };
+        Buffer.Events.push_back({
+            .Node = &Node,
+            .Slot = Slot,
+            .StartNs = std::chrono::duration_cast<std::chrono::nanoseconds>(Start - m_Origin).count(),
+            .DurationNs = static_cast<int64_t>(Duration),
+        });
+    } catch (...) {
+        /// Losing a trace event is better than losing the flow
+    }
+}
+
+void CProfiler::RecordOutputBytes(CBaseNode& Node, const uint64_t Bytes) noexcept
+{
+    Node.m_Profile.OutputBytes.fetch_add(Bytes, std::memory_order_relaxed);
+}
+
+void CProfiler::BeginCapture()
+{
+    {
+        std::lock_guard Lock { m_BufferMutex };
+        for (const auto& Buffer : m_Buffers) {
+            std::lock_guard BufferLock { Buffer->Mutex };
+            Buffer->Events.clear();
+        }
+    }
+
+    m_IsCapturing.store(true, std::memory_order_relaxed);
+}
+
+void CProfiler::EndCapture() noexcept
+{
+    m_IsCapturing.store(false, std::memory_order_relaxed);
+}
+
+size_t CProfiler::GetCapturedEventCount() const
+{
+    std::lock_guard Lock { m_BufferMutex };
+
+    size_t Count = 0;
+    for (const auto& Buffer : m_Buffers) {
+        std::lock_guard BufferLock { Buffer->Mutex };
+        Count += Buffer->Events.size();
+    }
+
+    return Count;
+}
+
+CProfiler::SThreadBuffer& CProfiler::GetThreadBuffer()
+{
+    if (GThreadBufferCache.ProfilerId == m_Id) [[likely]]
+        return *static_cast<SThreadBuffer*>(GThreadBufferCache.Buffer);
+
+    /// Threads alternating between profilers come back to the buffer they already own here
+    const auto Thread = std::this_thread::get_id();
+
+    std::lock_guard Lock { m_BufferMutex };
+    auto It = std::ranges::find(m_Buffers, Thread, [](const auto& Buffer) { return Buffer->Thread; });
+    if (It == m_Buffers.end()) {
+        It = m_Buffers.emplace(m_Buffers.end(), std::make_unique<SThreadBuffer>());
+        (*It)->Thread = Thread;
+        (*It)->ThreadIndex = static_cast<uint32_t>(m_Buffers.size());
+    }
+
+    GThreadBufferCache = { m_Id, It->get() };
+    return **It;
+}
+
+bool CProfiler::WriteChromeTrace(const std::filesystem::path& Path, const std::function<std::string(const CBaseNode*)>& NameOf) const
+{
+    std::ofstream File { Path, std::ios::binary };
+    if (!File)
+        return false;
+
+    std::string Json = R"({"displayTimeUnit":"ns","traceEvents":[)";
+    bool IsFirst = true;
+
+    std::lock_guard Lock { m_BufferMutex };
+    for (const auto& Buffer : m_Buffers) {
+        std::lock_guard BufferLock { Buffer->Mutex };
+
+        Json += std::format(R"({}{{"name":"thread_name","ph":"M","pid":1,"tid":{},"args":{{"name":"Worker {}"}}}})", IsFirst ? "" : ",", Buffer->ThreadIndex, Buffer->ThreadIndex);
+        IsFirst = false;
+
+        for (const auto& Event : Buffer->Events) {
+            Json += R"(,{"name":")";
+            AppendJsonEscaped(Json, NameOf ? NameOf(Event.Node) : std::format("{}", static_cast<const void*>(Event.Node)));
+
+            /// Chrome expects microseconds, fractions keep the nanosecond resolution
+            Json += std::format(R"(","cat":"{}","ph":"X","pid":1,"tid":{},"ts":{:.3f},"dur":{:.3f}}})",
+                SlotName(Event.Slot), Buffer->ThreadIndex, static_cast<double>(Event.StartNs) / 1000.0, static_cast<double>(Event.DurationNs) / 1000.0);
+        }
+    }
+
+    Json += "]}";
+    File.write(Json.data(), static_cast<std::streamsize>(Json.size()));
+    return File.good();
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,126 @@
+#pragma once
+
+#include "MacroDefines.hxx"
+
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+class CBaseNode;
+
+enum class EProfileSlot : uint8_t {
+    Execute,
+    Evaluate,
+    PrepareInput,
+    /// Later slices of a suspended Execute, timed but not counted as another call
+    Resume
+};
+
+/// Running totals kept inside every node, updated with relaxed atomics only
+struct SNodeProfile {
+    /// Runs of the node's own entry point, Execute for execute nodes and Evaluate for data nodes
+    std::atomic<uint64_t> Calls { 0 };
+    std::atomic<uint64_t> ExecuteNs { 0 };
+    std::atomic<uint64_t> EvaluateNs { 0 };
+    std::atomic<uint64_t> PrepareInputNs { 0 };
+    std::atomic<uint64_t> OutputBytes { 0 };
+
+    void Reset() noexcept
+    {
+        for (auto* Counter : { &Calls, &ExecuteNs, &EvaluateNs, &PrepareInputNs, &OutputBytes })
+            Counter->store(0, std::memory_order_relaxed);
+    }
+};
+
+/// Collects per-node timings, and while a capture is running a Chrome trace of every scope
+class MACRO_API CProfiler {
+
+public:
+    using Clock = std::chrono::steady_clock;
+
+    CProfiler();
+    ~CProfiler();
+
+    CProfiler(const CProfiler&) = delete;
+    CProfiler& operator=(const CProfiler&) = delete;
+
+    void Record(CBaseNode& Node, EProfileSlot Slot, Clock::time_point Start, Clock::time_point End) noexcept;
+    static void RecordOutputBytes(CBaseNode& Node, uint64_t Bytes) noexcept;
+
+    /// Starting a capture drops the previous one
+    void BeginCapture();
+    void EndCapture() noexcept;
+    [[nodiscard]] bool IsCapturing() const noexcept { return m_IsCapturing.load(std::memory_order_relaxed); }
+    [[nodiscard]] size_t GetCapturedEventCount() const;
+
+    /// Nodes may be gone by the time of export, so their names come from the caller
+    bool WriteChromeTrace(const std::filesystem::path& Path, const std::function<std::string(const CBaseNode*)>& NameOf = nullptr) const;
+
+protected:
+    struct STraceEvent {
+        const CBaseNode* Node;
+        EProfileSlot Slot;
+        int64_t StartNs;
+        int64_t DurationNs;
+    };
+
+    struct SThreadBuffer {
+        std::thread::id Thread;
+        uint32_t ThreadIndex;
+        /// Only contended by export and capture restart
+        std::mutex Mutex;
+        std::vector<STraceEvent> Events;
+    };
+
+    SThreadBuffer& GetThreadBuffer();
+
+    /// Distinguishes profilers for the per-thread buffer cache even if one is reallocated at the same address
+    const uint64_t m_Id;
+    Clock::time_point m_Origin;
+    std::atomic<bool> m_IsCapturing { false };
+
+    mutable std::mutex m_BufferMutex;
+    std::vector<std::unique_ptr<SThreadBuffer>> m_Buffers;
+};
+
+/// Times the enclosing scope into the node's profile
+class CProfileScope {
+
+public:
+    CProfileScope(CProfiler* Profiler, CBaseNode& Node, const EProfileSlot Slot) noexcept
+        : m_Profiler(Profiler)
+        , m_Node(Node)
+        , m_Slot(Slot)
+        , m_Start(Profiler != nullptr ? CProfiler::Clock::now() : CProfiler::Clock::time_point { })
+    {
+    }
+
+    ~CProfileScope()
+    {
+        if (m_Profiler != nullptr)
+            m_Profiler->Record(m_Node, m_Slot, m_Start, CProfiler::Clock::now());
+    }
+
+    CProfileScope(const CProfileScope&) = delete;
+    CProfileScope& operator=(const CProfileScope&) = delete;
+
+private:
+    CProfiler* m_Profiler;
+    CBaseNode& m_Node;
+    EProfileSlot m_Slot;
+    CProfiler::Clock::time_point m_Start;
+};
+
+#ifdef AMB_ENABLE_PROFILER
+#define AMB_PROFILE_CONCAT_INNER(A, B) A##B
+#define AMB_PROFILE_CONCAT(A, B) AMB_PROFILE_CONCAT_INNER(A, B)
+#define AMB_PROFILE_NODE(Node, Slot) const CProfileScope AMB_PROFILE_CONCAT(ProfileScope, __LINE__) { (Node).GetProfiler(), (Node), EProfileSlot::Slot }
+#else
+#define AMB_PROFILE_NODE(Node, Slot)
+#endif
\ No newline at end of file
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+/// Vector of trivially copyable elements, the first N live inside the object itself
+template <typename Ty, size_t N>
+    requires(std::is_trivially_copyable_v<Ty> && N > 0)
+class CSmallVector {
+
+public:
+    CSmallVector() noexcept = default;
+    CSmallVector(const CSmallVector& Other) { *this = Other; }
+    CSmallVector& operator=(const CSmallVector& Other)
+    {
+        if (this != &Other) {
+            clear();
+            reserve(Other.m_Size);
+            std::memcpy(data(), Other.data(), Other.m_Size * sizeof(Ty));
+            m_Size = Other.m_Size;
+        }
+        return *this;
+    }
+
+    CSmallVector(CSmallVector&& Other) noexcept { *this = std::move(Other); }
+    CSmallVector& operator=(CSmallVector&& Other) noexcept
+    {
+        if (this != &Other) {
+            if (Other.m_Heap) {
+                m_Heap = std::move(Other.m_Heap);
+                m_Capacity = Other.m_Capacity;
+            } else {
+                m_Heap.reset();
+                m_Capacity = N;
+                std::memcpy(m_Inline, Other.m_Inline, Other.m_Size * sizeof(Ty));
+            }
+
+            m_Size = std::exchange(Other.m_Size, 0);
+            Other.m_Capacity = N;
+        }
+        return *this;
+    }
+
+    [[nodiscard]] Ty* data() noexcept { return m_Heap ? m_Heap.get() : m_Inline; }
+    [[nodiscard]] const Ty* data() const noexcept { return m_Heap ? m_Heap.get() : m_Inline; }
+
+    [[nodiscard]] Ty* begin() noexcept { return data(); }
+    [[nodiscard]] Ty* end() noexcept { return data() + m_Size; }
+    [[nodiscard]] const Ty* begin() const noexcept { return data(); }
+    [[nodiscard]] const Ty* end() const noexcept { return data() + m_Size; }
+
+    [[nodiscard]] size_t size() const noexcept { return m_Size; }
+    [[nodiscard]] bool empty() const noexcept { return m_Size == 0; }
+
+    [[nodiscard]] Ty& operator[](const size_t Index) noexcept { return data()[Index]; }
+    [[nodiscard]] const Ty& operator[](const size_t Index) const noexcept { return data()[Index]; }
+    [[nodiscard]] const Ty& front() const noexcept { return data()[0]; }
+    [[nodiscard]] const Ty& back() const noexcept { return data()[m_Size - 1]; }
+
+    [[nodiscard]] bool contains(const Ty& Value) const noexcept { return std::find(begin(), end(), Value) != end(); }
+
+    void reserve(const size_t Capacity)
+    {
+        if (Capacity <= m_Capacity)
+            return;
+
+        auto NewHeap = std::make_unique_for_overwrite<Ty[]>(Capacity);
+        std::memcpy(NewHeap.get(), data(), m_Size * sizeof(Ty));
+        m_Heap = std::move(NewHeap);
+        m_Capacity = Capacity;
+    }
+
+    void push_back(const Ty& Value)
+    {
+        if (m_Size == m_Capacity)
+            reserve(m_Capacity * 2);
+        data()[m_Size++] = Value;
+    }
+
+    void pop_back() noexcept { --m_Size; }
+
+    /// Keeps the order of the remaining elements
+    Ty* erase(const Ty* Position) noexcept
+    {
+        auto* Target = begin() + (Position - begin());
+        std::memmove(Target, Target + 1, (end() - Target - 1) * sizeof(Ty));
+        --m_Size;
+        return Target;
+    }
+
+    void clear() noexcept { m_Size = 0; }
+
+private:
+    Ty m_Inline[N] { };
+    std::unique_ptr<Ty[]> m_Heap;
+    size_t m_Size = 0;
+    size_t m_Capacity = N;
+};
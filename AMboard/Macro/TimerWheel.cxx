@@ -0,0 +1,142 @@
+#include "TimerWheel.hxx"
+
+CTimerWheel::CTimerWheel()
+    : m_StartTime(Clock::now())
+{
+    m_TimerThread = std::thread(&CTimerWheel::TimerLoop, this);
+}
+
+CTimerWheel::~CTimerWheel()
+{
+    {
+        std::lock_guard Lock { m_Mutex };
+        m_Stopping = true;
+    }
+    m_Changed.notify_all();
+
+    if (m_TimerThread.joinable())
+        m_TimerThread.join();
+}
+
+void CTimerWheel::Schedule(const Clock::time_point Deadline, Callback Func)
+{
+    bool IsEarlier;
+    {
+        std::lock_guard Lock { m_Mutex };
+
+        /// The timer thread stops ticking while the wheel is empty, catch up here so the timer is measured from now.
+        /// Nothing is in the slots to skip over, and the thread does not have to advance through the whole idle time
+        if (m_PendingCount == 0)
+            m_CurrentTick = std::max(m_CurrentTick, ToTick(Clock::now()));
+
+        /// Round up, a timer never fires before its deadline
+        const auto Expiry = std::max(ToTick(Deadline + TickDuration - Clock::duration { 1 }), m_CurrentTick + 1);
+        Insert({ Expiry, std::move(Func) });
+        ++m_PendingCount;
+
+        IsEarlier = m_PendingCount == 1 || Expiry < m_PlannedWakeTick;
+        m_Rescheduled |= IsEarlier;
+    }
+
+    if (IsEarlier)
+        m_Changed.notify_one();
+}
+
+size_t CTimerWheel::GetPendingCount() const noexcept
+{
+    std::lock_guard Lock { m_Mutex };
+    return m_PendingCount;
+}
+
+uint64_t CTimerWheel::ToTick(const Clock::time_point Time) const noexcept
+{
+    if (Time <= m_StartTime)
+        return 0;
+    return static_cast<uint64_t>((Time - m_StartTime) / TickDuration);
+}
+
+CTimerWheel::Clock::time_point CTimerWheel::ToTime(const uint64_t Tick) const noexcept
+{
+    return m_StartTime + Tick * TickDuration;
+}
+
+void CTimerWheel::Insert(STimer&& Timer)
+{
+    const auto Delta = Timer.Expiry - m_CurrentTick;
+
+    size_t Level = 0;
+    while (Level < LevelCount && Delta >= uint64_t { 1 } << SlotBits * (Level + 1))
+        ++Level;
+
+    if (Level == LevelCount) {
+        m_Overflow.emplace_back(std::move(Timer));
+        return;
+    }
+
+    m_Slots[Level][Timer.Expiry >> SlotBits * Level & SlotMask].emplace_back(std::move(Timer));
+}
+
+void CTimerWheel::Advance(std::vector<Callback>& Expired)
+{
+    ++m_CurrentTick;
+
+    /// Whenever a level wraps, spread the next slot of the level above over the lower ones.
+    /// Top down, so timers moving several levels still land in a slot that is processed this tick
+    size_t Wrapped = 0;
+    while (Wrapped < LevelCount && (m_CurrentTick >> SlotBits * Wrapped & SlotMask) == 0)
+        ++Wrapped;
+
+    for (auto Level = Wrapped; Level >= 1; --Level) {
+        auto Cascade = std::move(Level == LevelCount ? m_Overflow : m_Slots[Level][m_CurrentTick >> SlotBits * Level & SlotMask]);
+        for (auto& Timer : Cascade)
+            Insert(std::move(Timer));
+    }
+
+    auto& Slot = m_Slots[0][m_CurrentTick & SlotMask];
+    for (auto& Timer : Slot)
+        Expired.emplace_back(std::move(Timer.Func));
+    m_PendingCount -= Slot.size();
+    Slot.clear();
+}
+
+uint64_t CTimerWheel::GetNextWakeTick() const noexcept
+{
+    const auto NextCascade = (m_CurrentTick | SlotMask) + 1;
+    for (auto Tick = m_CurrentTick + 1; Tick < NextCascade; ++Tick)
+        if (!m_Slots[0][Tick & SlotMask].empty())
+            return Tick;
+
+    return NextCascade;
+}
+
+void CTimerWheel::TimerLoop()
+{
+    std::vector<Callback> Expired;
+
+    std::unique_lock Lock { m_Mutex };
+    while (!m_Stopping) {
+        if (m_PendingCount == 0) {
+            /// Schedule catches up on the idle time once a timer arrives
+            m_Changed.wait(Lock, [this] { return m_Stopping || m_PendingCount != 0; });
+            continue;
+        }
+
+        m_PlannedWakeTick = GetNextWakeTick();
+        if (m_Changed.wait_until(Lock, ToTime(m_PlannedWakeTick), [this] { return m_Stopping || m_Rescheduled || ToTick(Clock::now()) >= m_PlannedWakeTick; }); m_Stopping)
+            break;
+        m_Rescheduled = false;
+
+        const auto NowTick = ToTick(Clock::now());
+        while (m_CurrentTick < NowTick && m_PendingCount != 0)
+            Advance(Expired);
+
+        if (Expired.empty())
+            continue;
+
+        Lock.unlock();
+        for (auto& Func : Expired)
+            Func();
+        Expired.clear();
+        Lock.lock();
+    }
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include "MacroDefines.hxx"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/// Hierarchical timing wheel driven by its own thread.
+/// Scheduling and expiry are O(1), callbacks run on the timer thread and should only signal or enqueue work
+class MACRO_API CTimerWheel {
+
+public:
+    using Clock = std::chrono::steady_clock;
+    using Callback = std::function<void()>;
+
+    static constexpr auto TickDuration = std::chrono::milliseconds(1);
+
+    CTimerWheel();
+    ~CTimerWheel();
+
+    CTimerWheel(const CTimerWheel&) = delete;
+    CTimerWheel& operator=(const CTimerWheel&) = delete;
+
+    void Schedule(Clock::time_point Deadline, Callback Func);
+    void Schedule(const Clock::duration Delay, Callback Func) { Schedule(Clock::now() + Delay, std::move(Func)); }
+
+    [[nodiscard]] size_t GetPendingCount() const noexcept;
+
+protected:
+    static constexpr size_t SlotBits = 6;
+    static constexpr size_t SlotCount = 1 << SlotBits;
+    static constexpr size_t SlotMask = SlotCount - 1;
+    static constexpr size_t LevelCount = 4;
+
+    struct STimer {
+        uint64_t Expiry;
+        Callback Func;
+    };
+
+    [[nodiscard]] uint64_t ToTick(Clock::time_point Time) const noexcept;
+    [[nodiscard]] Clock::time_point ToTime(uint64_t Tick) const noexcept;
+
+    void Insert(STimer&& Timer);
+    /// Move one tick forward, cascading upper levels and collecting what expired
+    void Advance(std::vector<Callback>& Expired);
+    /// Earliest tick worth waking up for, either a populated level 0 slot or the next cascade
+    [[nodiscard]] uint64_t GetNextWakeTick() const noexcept;
+
+    void TimerLoop();
+
+    mutable std::mutex m_Mutex;
+    std::condition_variable m_Changed;
+    bool m_Stopping = false;
+    /// An earlier timer arrived while sleeping
+    bool m_Rescheduled = false;
+
+    Clock::time_point m_StartTime;
+    uint64_t m_CurrentTick = 0;
+    uint64_t m_PlannedWakeTick = 0;
+    size_t m_PendingCount = 0;
+
+    std::array<std::array<std::vector<STimer>, SlotCount>, LevelCount> m_Slots;
+    /// Further out than the wheel can express, re-inserted whenever the top level wraps
+    std::vector<STimer> m_Overflow;
+
+    std::thread m_TimerThread;
+};
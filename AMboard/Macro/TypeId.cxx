@@ -0,0 +1,79 @@
+#include "TypeId.hxx"
+
+#include "Util/Assertions.hxx"
+
+#include <format>
+#include <mutex>
+
+namespace {
+CTypeRegistry* GTypeRegistry = nullptr;
+}
+
+CTypeRegistry::CTypeRegistry()
+{
+    for (const auto Builtin : { "void", "bool", "int8_t", "uint8_t", "int16_t", "uint16_t", "int32_t", "uint32_t", "int64_t", "uint64_t", "float", "double", "string" })
+        m_Names.emplace(HashTypeName(Builtin), Builtin);
+
+    RegisterCollection(MakeVectorTraits<std::string>(MakeDataType("vector<string>"), MakeDataType("string")));
+}
+
+CTypeRegistry& CTypeRegistry::Get() noexcept
+{
+    static CTypeRegistry Local;
+    return GTypeRegistry != nullptr ? *GTypeRegistry : Local;
+}
+
+SDataType CTypeRegistry::Intern(const std::string_view TypeName)
+{
+    const auto Id = HashTypeName(TypeName);
+    {
+        std::shared_lock Lock { m_Mutex };
+        if (const auto It = m_Names.find(Id); It != m_Names.end()) {
+            MAKE_SURE(It->second == TypeName, std::format("Type id collision between {} and {}", It->second, TypeName))
+            return { Id, It->second };
+        }
+    }
+
+    std::unique_lock Lock { m_Mutex };
+    const auto& [It, Inserted] = m_Names.try_emplace(Id, TypeName);
+    MAKE_SURE(It->second == TypeName, std::format("Type id collision between {} and {}", It->second, TypeName))
+    return { Id, It->second };
+}
+
+std::string_view CTypeRegistry::GetName(const DataTypeId Id) const
+{
+    std::shared_lock Lock { m_Mutex };
+    if (const auto It = m_Names.find(Id); It != m_Names.end())
+        return It->second;
+    return "unknown";
+}
+
+void CTypeRegistry::RegisterCollection(const SCollectionTraits& Traits)
+{
+    auto Interned = Traits;
+    Interned.CollectionType = Intern(Traits.CollectionType.Name);
+    Interned.ElementType = Intern(Traits.ElementType.Name);
+
+    std::unique_lock Lock { m_Mutex };
+    m_Collections.insert_or_assign(Interned.CollectionType.Id, Interned);
+    m_CollectionOf.try_emplace(Interned.ElementType.Id, Interned.CollectionType.Id);
+}
+
+const SCollectionTraits* CTypeRegistry::FindCollection(const DataTypeId CollectionId) const
+{
+    std::shared_lock Lock { m_Mutex };
+    const auto It = m_Collections.find(CollectionId);
+    return It != m_Collections.end() ? &It->second : nullptr;
+}
+
+const SCollectionTraits* CTypeRegistry::FindCollectionOf(const DataTypeId ElementId) const
+{
+    std::shared_lock Lock { m_Mutex };
+    const auto It = m_CollectionOf.find(ElementId);
+    return It != m_CollectionOf.end() ? &m_Collections.at(It->second) : nullptr;
+}
+
+void SetTypeRegistry(CTypeRegistry* Registry) noexcept
+{
+    GTypeRegistry = Registry;
+}
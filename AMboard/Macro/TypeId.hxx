@@ -0,0 +1,117 @@
+#pragma once
+
+#include "MacroDefines.hxx"
+
+#include <cstdint>
+#include <memory>
+#include <shared_mutex>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+using DataTypeId = uint32_t;
+
+/// FNV-1a over the type name, the same name yields the same id in every module without any coordination
+constexpr DataTypeId HashTypeName(const std::string_view Name) noexcept
+{
+    DataTypeId Hash = 2166136261u;
+    for (const auto Char : Name) {
+        Hash ^= static_cast<uint8_t>(Char);
+        Hash *= 16777619u;
+    }
+    return Hash;
+}
+
+/// Type of the value a data pin holds, compared by id only
+struct SDataType {
+    DataTypeId Id;
+    std::string_view Name;
+
+    constexpr SDataType(const std::string_view TypeName) noexcept // NOLINT
+        : Id(HashTypeName(TypeName))
+        , Name(TypeName)
+    {
+    }
+    constexpr SDataType(const char* TypeName) noexcept // NOLINT
+        : SDataType(std::string_view { TypeName })
+    {
+    }
+    constexpr SDataType(const DataTypeId TypeId, const std::string_view TypeName) noexcept
+        : Id(TypeId)
+        , Name(TypeName)
+    {
+    }
+
+    friend constexpr bool operator==(const SDataType& Lhs, const SDataType& Rhs) noexcept { return Lhs.Id == Rhs.Id; }
+};
+
+/// Forces the hash to happen at compile time
+consteval SDataType MakeDataType(const std::string_view TypeName) noexcept
+{
+    return SDataType { TypeName };
+}
+
+inline constexpr SDataType VoidDataType = MakeDataType("void");
+
+/// Element access for a collection type, lets nodes such as Map walk values of types they were not built with
+struct SCollectionTraits {
+    SDataType CollectionType;
+    SDataType ElementType;
+    size_t (*Size)(const void* Collection) noexcept;
+    /// Element Index, sharing ownership with the collection instead of copying it
+    std::shared_ptr<void> (*At)(const std::shared_ptr<void>& Collection, size_t Index) noexcept;
+    /// New collection holding copies of Elements, all of ElementType
+    std::shared_ptr<void> (*Gather)(std::span<const std::shared_ptr<void>> Elements);
+};
+
+template <typename Ty>
+SCollectionTraits MakeVectorTraits(const SDataType CollectionType, const SDataType ElementType) noexcept
+{
+    return {
+        .CollectionType = CollectionType,
+        .ElementType = ElementType,
+        .Size = [](const void* Collection) noexcept { return static_cast<const std::vector<Ty>*>(Collection)->size(); },
+        .At = [](const std::shared_ptr<void>& Collection, const size_t Index) noexcept {
+            return std::shared_ptr<void> { Collection, static_cast<std::vector<Ty>*>(Collection.get())->data() + Index };
+        },
+        .Gather = [](const std::span<const std::shared_ptr<void>> Elements) -> std::shared_ptr<void> {
+            auto Result = std::make_shared<std::vector<Ty>>();
+            Result->reserve(Elements.size());
+            for (const auto& Element : Elements)
+                Result->push_back(Element != nullptr ? *static_cast<const Ty*>(Element.get()) : Ty { });
+            return Result;
+        },
+    };
+}
+
+/// Owns the names behind every id seen so far, and catches hash collisions
+class MACRO_API CTypeRegistry {
+
+public:
+    CTypeRegistry();
+
+    /// Registry of this module, plugins are pointed at the host's through SetTypeRegistry
+    static CTypeRegistry& Get() noexcept;
+
+    /// Register the name, the returned type refers to registry owned storage
+    SDataType Intern(std::string_view TypeName);
+    [[nodiscard]] std::string_view GetName(DataTypeId Id) const;
+
+    /// Both names are interned, the functions must stay loaded as long as the registry is used
+    void RegisterCollection(const SCollectionTraits& Traits);
+    /// Null unless registered
+    [[nodiscard]] const SCollectionTraits* FindCollection(DataTypeId CollectionId) const;
+    /// Collection registered with this element type, null if none
+    [[nodiscard]] const SCollectionTraits* FindCollectionOf(DataTypeId ElementId) const;
+
+protected:
+    mutable std::shared_mutex m_Mutex;
+    std::unordered_map<DataTypeId, std::string> m_Names;
+    /// Never erased, so handed out pointers stay valid
+    std::unordered_map<DataTypeId, SCollectionTraits> m_Collections;
+    std::unordered_map<DataTypeId, DataTypeId> m_CollectionOf;
+};
+
+MACRO_API void SetTypeRegistry(CTypeRegistry* Registry) noexcept;
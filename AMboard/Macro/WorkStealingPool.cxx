@@ -0,0 +1,165 @@
+#include "WorkStealingPool.hxx"
+
+#include <algorithm>
+
+bool CWorkStealingPool::SGroupState::RunOne()
+{
+    std::function<void()> Task;
+    {
+        std::lock_guard Lock { Mutex };
+        if (Tasks.empty())
+            return false;
+
+        Task = std::move(Tasks.front());
+        Tasks.pop_front();
+    }
+
+    Task();
+
+    std::lock_guard Lock { Mutex };
+    if (--Outstanding == 0)
+        Finished.notify_all();
+
+    return true;
+}
+
+CWorkStealingPool::CTaskGroup::CTaskGroup(CWorkStealingPool& Pool)
+    : m_Pool(Pool)
+    , m_State(std::make_shared<SGroupState>())
+{
+}
+
+CWorkStealingPool::CTaskGroup::~CTaskGroup()
+{
+    Wait();
+}
+
+void CWorkStealingPool::CTaskGroup::Run(std::function<void()> Task)
+{
+    {
+        std::lock_guard Lock { m_State->Mutex };
+        m_State->Tasks.emplace_back(std::move(Task));
+        ++m_State->Outstanding;
+    }
+
+    m_Pool.Push(m_State);
+}
+
+void CWorkStealingPool::CTaskGroup::Wait()
+{
+    /// Help with our own tasks first, then wait for the ones already stolen
+    while (m_State->RunOne()) { }
+
+    std::unique_lock Lock { m_State->Mutex };
+    m_State->Finished.wait(Lock, [this] { return m_State->Outstanding == 0; });
+}
+
+CWorkStealingPool::CWorkStealingPool(const size_t WorkerCount)
+{
+    const auto Count = std::max<size_t>(WorkerCount, 1);
+
+    for (size_t Index = 0; Index < Count; ++Index)
+        m_Queues.emplace_back(std::make_unique<SWorkerQueue>());
+
+    m_WorkerIds.resize(Count);
+    for (size_t Index = 0; Index < Count; ++Index) {
+        m_Workers.emplace_back(&CWorkStealingPool::WorkerLoop, this, Index);
+        m_WorkerIds[Index] = m_Workers.back().get_id();
+    }
+
+    m_Started.count_down();
+}
+
+CWorkStealingPool::~CWorkStealingPool()
+{
+    {
+        std::lock_guard Lock { m_SleepMutex };
+        m_Stopping = true;
+    }
+    m_WakeUp.notify_all();
+
+    for (auto& Worker : m_Workers)
+        Worker.join();
+}
+
+void CWorkStealingPool::Detach(std::function<void()> Task)
+{
+    auto Group = std::make_shared<SGroupState>();
+    Group->Tasks.emplace_back(std::move(Task));
+    Group->Outstanding = 1;
+
+    Push(std::move(Group));
+}
+
+void CWorkStealingPool::Push(std::shared_ptr<SGroupState> Group)
+{
+    /// Workers push onto their own queue (LIFO for locality), foreign threads spread round-robin
+    auto QueueIndex = FindWorkerIndex();
+    if (QueueIndex == m_Queues.size())
+        QueueIndex = m_NextQueue.fetch_add(1, std::memory_order_relaxed) % m_Queues.size();
+
+    {
+        std::lock_guard Lock { m_Queues[QueueIndex]->Mutex };
+        m_Queues[QueueIndex]->Tokens.emplace_back(std::move(Group));
+    }
+
+    {
+        std::lock_guard Lock { m_SleepMutex };
+        m_PendingTokens.fetch_add(1, std::memory_order_relaxed);
+    }
+    m_WakeUp.notify_one();
+}
+
+std::shared_ptr<CWorkStealingPool::SGroupState> CWorkStealingPool::Pop(const size_t WorkerIndex)
+{
+    std::shared_ptr<SGroupState> Result;
+
+    /// Own queue from the back
+    {
+        auto& Queue = *m_Queues[WorkerIndex];
+        std::lock_guard Lock { Queue.Mutex };
+        if (!Queue.Tokens.empty()) {
+            Result = std::move(Queue.Tokens.back());
+            Queue.Tokens.pop_back();
+        }
+    }
+
+    /// Steal from the front of everyone else
+    for (size_t Offset = 1; Result == nullptr && Offset < m_Queues.size(); ++Offset) {
+        auto& Queue = *m_Queues[(WorkerIndex + Offset) % m_Queues.size()];
+        std::lock_guard Lock { Queue.Mutex };
+        if (!Queue.Tokens.empty()) {
+            Result = std::move(Queue.Tokens.front());
+            Queue.Tokens.pop_front();
+        }
+    }
+
+    if (Result != nullptr)
+        m_PendingTokens.fetch_sub(1, std::memory_order_relaxed);
+
+    return Result;
+}
+
+size_t CWorkStealingPool::FindWorkerIndex() const noexcept
+{
+    const auto Id = std::this_thread::get_id();
+    return std::distance(m_WorkerIds.begin(), std::ranges::find(m_WorkerIds, Id));
+}
+
+void CWorkStealingPool::WorkerLoop(const size_t WorkerIndex)
+{
+    m_Started.wait();
+
+    while (true) {
+        if (const auto Group = Pop(WorkerIndex)) {
+            /// The joining thread might have run it already
+            Group->RunOne();
+            continue;
+        }
+
+        std::unique_lock Lock { m_SleepMutex };
+        m_WakeUp.wait(Lock, [this] { return m_Stopping || m_PendingTokens.load(std::memory_order_relaxed) != 0; });
+        if (m_Stopping)
+            return;
+    }
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include "MacroDefines.hxx"
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <latch>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class MACRO_API CWorkStealingPool {
+
+    struct SGroupState {
+        std::mutex Mutex;
+        std::condition_variable Finished;
+        std::deque<std::function<void()>> Tasks;
+        size_t Outstanding = 0;
+
+        /// Run one task that has not been picked up yet, false if none left
+        bool RunOne();
+    };
+
+    struct SWorkerQueue {
+        std::mutex Mutex;
+        std::deque<std::shared_ptr<SGroupState>> Tokens;
+    };
+
+public:
+    /// Tasks are joined as a group, a waiting thread only helps with tasks from its own group.
+    /// This keeps nested joins (a task spawning and joining its own group) deadlock free
+    class MACRO_API CTaskGroup {
+    public:
+        explicit CTaskGroup(CWorkStealingPool& Pool);
+        ~CTaskGroup();
+
+        CTaskGroup(const CTaskGroup&) = delete;
+        CTaskGroup& operator=(const CTaskGroup&) = delete;
+
+        void Run(std::function<void()> Task);
+        void Wait();
+
+    private:
+        CWorkStealingPool& m_Pool;
+        std::shared_ptr<SGroupState> m_State;
+    };
+
+    explicit CWorkStealingPool(size_t WorkerCount = std::max(std::thread::hardware_concurrency(), 2u) - 1);
+    ~CWorkStealingPool();
+
+    CWorkStealingPool(const CWorkStealingPool&) = delete;
+    CWorkStealingPool& operator=(const CWorkStealingPool&) = delete;
+
+    [[nodiscard]] size_t GetWorkerCount() const noexcept { return m_Workers.size(); }
+
+    /// Run Task without anyone joining it, dropped if the pool shuts down first
+    void Detach(std::function<void()> Task);
+
+protected:
+    void Push(std::shared_ptr<SGroupState> Group);
+    std::shared_ptr<SGroupState> Pop(size_t WorkerIndex);
+
+    /// Index of the calling worker, or worker count for foreign threads
+    [[nodiscard]] size_t FindWorkerIndex() const noexcept;
+
+    void WorkerLoop(size_t WorkerIndex);
+
+    std::vector<std::unique_ptr<SWorkerQueue>> m_Queues;
+    std::vector<std::thread::id> m_WorkerIds;
+    std::vector<std::thread> m_Workers;
+    /// Opened once every id is recorded, FindWorkerIndex reads them without a lock
+    std::latch m_Started { 1 };
+
+    std::atomic<size_t> m_NextQueue { 0 };
+    std::atomic<size_t> m_PendingTokens { 0 };
+
+    std::mutex m_SleepMutex;
+    std::condition_variable m_WakeUp;
+    bool m_Stopping = false;
+};
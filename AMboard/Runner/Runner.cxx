@@ -0,0 +1,151 @@
+#include <AMboard/Board/BoardLoader.hxx>
+#include <AMboard/CustomNodes/CustomNodeManager.hxx>
+#include <AMboard/Macro/ExecuteNode.hxx>
+#include <AMboard/Macro/ExecutionManager.hxx>
+#include <AMboard/Macro/GraphTransaction.hxx>
+
+#include <spdlog/spdlog.h>
+
+#include <atomic>
+#include <charconv>
+#include <chrono>
+#include <csignal>
+#include <optional>
+#include <ranges>
+#include <semaphore>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace {
+enum EExitCode : int {
+    Success = 0,
+    UsageError = 1,
+    LoadError = 2,
+    Interrupted = 3,
+    TimedOut = 4,
+};
+
+std::atomic<bool> GInterrupted { false };
+
+void PrintUsage()
+{
+    spdlog::info("usage: amb-run <board.yaml> [--ext <dir>] [--timeout <seconds>] [--quiet]");
+}
+
+struct SRunOptions {
+    std::filesystem::path Board;
+    std::filesystem::path ExtDir = "NodeExts";
+    std::optional<std::chrono::milliseconds> Timeout;
+    bool Quiet = false;
+};
+
+std::optional<SRunOptions> ParseArguments(const int Argc, char** Argv)
+{
+    SRunOptions Options;
+    for (int i = 1; i < Argc; ++i) {
+        const std::string_view Arg = Argv[i];
+        const bool HasValue = i + 1 < Argc;
+
+        if (Arg == "--ext" && HasValue) {
+            Options.ExtDir = Argv[++i];
+        } else if (Arg == "--timeout" && HasValue) {
+            const std::string_view Value = Argv[++i];
+            double Seconds = 0;
+            if (const auto [Ptr, Ec] = std::from_chars(Value.data(), Value.data() + Value.size(), Seconds); Ec != std::errc() || Seconds <= 0)
+                return std::nullopt;
+            Options.Timeout = std::chrono::milliseconds(static_cast<int64_t>(Seconds * 1000));
+        } else if (Arg == "--quiet") {
+            Options.Quiet = true;
+        } else if (Options.Board.empty() && !Arg.starts_with("--")) {
+            Options.Board = Arg;
+        } else {
+            return std::nullopt;
+        }
+    }
+
+    if (Options.Board.empty())
+        return std::nullopt;
+    return Options;
+}
+}
+
+int main(const int Argc, char** Argv)
+{
+    const auto Options = ParseArguments(Argc, Argv);
+    if (!Options) {
+        PrintUsage();
+        return UsageError;
+    }
+
+    if (Options->Quiet)
+        spdlog::set_level(spdlog::level::warn);
+
+    const auto StartTime = std::chrono::steady_clock::now();
+
+    /// Destroyed in reverse, nodes before the manager and everything before the plugins their code lives in
+    const CCustomNodeLoader Loader { Options->ExtDir, nullptr };
+    CExecutionManager Manager;
+    std::vector<std::unique_ptr<CBaseNode, void (*)(CBaseNode*)>> Nodes;
+
+    CExecuteNode* Entrance = nullptr;
+    {
+        CGraphTransaction Transaction { Manager };
+
+        const bool Loaded = LoadBoard(Options->Board, Loader, [&](SBoardNode&& Node) {
+            Manager.RegisterNode(Node.Node.get());
+            Node.Node->Begin();
+
+            if (Node.Name == EntranceNodeName && Entrance == nullptr)
+                Entrance = dynamic_cast<CExecuteNode*>(Node.Node.get());
+            Nodes.emplace_back(std::move(Node.Node));
+        });
+
+        if (!Loaded)
+            return LoadError;
+    }
+
+    if (Entrance == nullptr) {
+        spdlog::error("{} has no {}", Options->Board.string(), EntranceNodeName);
+        return LoadError;
+    }
+
+    const auto NodePointers = Nodes | std::views::transform([](const auto& Node) { return Node.get(); }) | std::ranges::to<std::vector>();
+    const auto Optimization = Manager.OptimizeGraph(NodePointers);
+
+    spdlog::info("Loaded {} node(s) in {}ms, {} folded, {} shared, {} dead", Nodes.size(), std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - StartTime).count(), Optimization.Folded, Optimization.Shared, Optimization.Dead);
+
+    std::signal(SIGINT, [](int) { GInterrupted.store(true, std::memory_order_relaxed); });
+    std::signal(SIGTERM, [](int) { GInterrupted.store(true, std::memory_order_relaxed); });
+
+    std::binary_semaphore Finished { 0 };
+    const auto Flow = Manager.StartExecuteAsync(Entrance, [&Finished] { Finished.release(); });
+    if (Flow == InvalidFlowId) {
+        spdlog::error("Failed to start the flow");
+        return LoadError;
+    }
+
+    /// Polled so a signal or the deadline can stop the flow, the flow itself runs on the manager's workers
+    constexpr auto PollInterval = std::chrono::milliseconds(50);
+    const auto Deadline = Options->Timeout ? std::chrono::steady_clock::now() + *Options->Timeout : std::chrono::steady_clock::time_point::max();
+
+    auto ExitCode = Success;
+    while (!Finished.try_acquire_for(PollInterval)) {
+        if (ExitCode == Success && GInterrupted.load(std::memory_order_relaxed))
+            ExitCode = Interrupted;
+        else if (ExitCode == Success && std::chrono::steady_clock::now() >= Deadline)
+            ExitCode = TimedOut;
+        else
+            continue;
+
+        spdlog::warn(ExitCode == Interrupted ? "Interrupted, stopping flow" : "Timed out, stopping flow");
+        Manager.StopFlow(Flow);
+    }
+
+    spdlog::info("Finished in {}ms", std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - StartTime).count());
+
+    for (const auto& Node : Nodes)
+        Node->End();
+
+    return ExitCode;
+}
\ No newline at end of file
@@ -0,0 +1,85 @@
+//
+// Generated by amb-aot from CompilerTestBoard.yaml, changes are lost on the next export
+//
+
+#include <AMboard/Compiler/CompiledNode.hxx>
+#include <AMboard/Macro/MacroDefines.hxx>
+
+extern "C" CBaseNode* create_CEntranceNode();
+extern "C" void destroy_CEntranceNode(CBaseNode* Node);
+extern "C" CBaseNode* create_CSequenceNode();
+extern "C" void destroy_CSequenceNode(CBaseNode* Node);
+extern "C" CBaseNode* create_CConstantNode();
+extern "C" void destroy_CConstantNode(CBaseNode* Node);
+extern "C" CBaseNode* create_CDivideNode();
+extern "C" void destroy_CDivideNode(CBaseNode* Node);
+extern "C" CBaseNode* create_CRecordingNode();
+extern "C" void destroy_CRecordingNode(CBaseNode* Node);
+extern "C" CBaseNode* create_CDelayNode();
+extern "C" void destroy_CDelayNode(CBaseNode* Node);
+
+class CCompilerTestNode : public CCompiledNode {
+public:
+    CCompilerTestNode()
+    {
+        Spawn(&create_CEntranceNode, &destroy_CEntranceNode);
+        Spawn(&create_CSequenceNode, &destroy_CSequenceNode, { "\002\000", 2 });
+        Spawn(&create_CConstantNode, &destroy_CConstantNode, { "2", 1 });
+        Spawn(&create_CConstantNode, &destroy_CConstantNode, { "10", 2 });
+        Spawn(&create_CDivideNode, &destroy_CDivideNode);
+        Spawn(&create_CRecordingNode, &destroy_CRecordingNode);
+        Spawn(&create_CDelayNode, &destroy_CDelayNode, { "0.050000", 8 });
+        Spawn(&create_CConstantNode, &destroy_CConstantNode, { "0", 1 });
+        Spawn(&create_CDivideNode, &destroy_CDivideNode);
+        Spawn(&create_CRecordingNode, &destroy_CRecordingNode);
+        Spawn(&create_CRecordingNode, &destroy_CRecordingNode);
+        Link(0, 0, 1, 0);
+        Link(1, 0, 5, 0);
+        Link(1, 1, 10, 0);
+        Link(2, 0, 4, 1);
+        Link(3, 0, 4, 0);
+        Link(3, 0, 8, 0);
+        Link(4, 0, 5, 1);
+        Link(4, 0, 10, 1);
+        Link(5, 0, 6, 0);
+        Link(6, 0, 9, 0);
+        Link(7, 0, 8, 1);
+        Link(8, 0, 9, 1);
+    }
+
+protected:
+    CFlowTask ExecuteAsync() override
+    {
+        auto Step0 = Prepare(0, { });
+        Run(Step0);
+        if (Step0.Pin != 0)
+            co_return;
+        auto Step1 = Prepare(1, { });
+        Run(Step1);
+        for (; Step1.Pin != NoPin; Continue(Step1)) {
+            switch (Step1.Pin) {
+            case 0: {
+                auto Step5 = Prepare(5, { 2, 3, 4 });
+                Run(Step5);
+                if (Step5.Pin != 0)
+                    break;
+                auto Step6 = Prepare(6, { });
+                for (auto IsDone = StartChild(Step6); !IsDone; IsDone = ResumeChild(Step6))
+                    co_await WaitFor(Step6.Ready->load());
+                if (Step6.Pin != 0)
+                    break;
+                auto Step9 = Prepare(9, { 7, 3, 8 });
+                Run(Step9);
+                break;
+            }
+            case 1: {
+                auto Step10 = Prepare(10, { 2, 3, 4 });
+                Run(Step10);
+                break;
+            }
+            }
+        }
+    }
+};
+
+REGISTER_MACROS(CCompilerTestNode)
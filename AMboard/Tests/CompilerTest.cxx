@@ -0,0 +1,189 @@
+#include "TestHarness.hxx"
+
+#include <AMboard/Compiler/BoardCompiler.hxx>
+#include <AMboard/Macro/DataPin.hxx>
+#include <AMboard/Macro/MacroDefines.hxx>
+
+#include <atomic>
+#include <bit>
+#include <format>
+#include <fstream>
+#include <mutex>
+#include <sstream>
+#include <string>
+
+/// Exported by the common node plugin, the same factories the compiled node goes through
+extern "C" CBaseNode* create_CEntranceNode();
+extern "C" void destroy_CEntranceNode(CBaseNode* Node);
+extern "C" CBaseNode* create_CSequenceNode();
+extern "C" void destroy_CSequenceNode(CBaseNode* Node);
+extern "C" CBaseNode* create_CDivideNode();
+extern "C" void destroy_CDivideNode(CBaseNode* Node);
+extern "C" CBaseNode* create_CDelayNode();
+extern "C" void destroy_CDelayNode(CBaseNode* Node);
+
+/// CompiledBoard.cxx, what CompileBoard produces for SCompilerBoard
+extern "C" CBaseNode* create_CCompilerTestNode();
+extern "C" void destroy_CCompilerTestNode(CBaseNode* Node);
+
+namespace {
+
+std::mutex GRecordMutex;
+std::vector<std::string> GRecords;
+
+/// int32_t read from Ext
+class CConstantNode : public CBaseNode {
+public:
+    CConstantNode()
+    {
+        m_IsPure = true;
+        EmplacePin<CDataPin>(false);
+    }
+
+    void ReadExtraContext(const std::string& ExtContext) override
+    {
+        GetOutputPins()[0]->As<CDataPin>()->PinSet(int32_t, std::stoi(ExtContext));
+    }
+};
+
+/// Logs the value it is fed, "none" if the source failed to produce one
+class CRecordingNode : public CExecuteNode {
+public:
+    CRecordingNode()
+    {
+        EmplacePin<CDataPin>(true)->SetIsUniversalPin();
+    }
+
+protected:
+    void Execute() override
+    {
+        CExecuteNode::Execute();
+
+        const auto& Value = *GetInputPins()[1]->As<CDataPin>();
+        std::lock_guard Lock { GRecordMutex };
+        GRecords.emplace_back(Value.GetValueType() == VoidDataType ? "none" : std::format("{} {}", Value.GetValueType().Name, std::bit_cast<uint64_t>(Value.AsDouble())));
+    }
+};
+}
+
+MACRO_FACTORY(CConstantNode)
+MACRO_FACTORY(CRecordingNode)
+
+namespace {
+
+/// Nodes made the way LoadBoard makes them, Ext first and links after
+struct SCompilerBoard {
+    STestGraph Graph;
+    std::vector<SBoardNode> Nodes;
+
+    CExecuteNode* Entrance = Add<CExecuteNode>(EntranceNodeName, &create_CEntranceNode, &destroy_CEntranceNode);
+    CExecuteNode* Sequence = Add<CExecuteNode>("Sequence Node", &create_CSequenceNode, &destroy_CSequenceNode, { static_cast<char>(2), 0 });
+    CBaseNode* Ten = Add<CBaseNode>("Constant Node", &create_CConstantNode, &destroy_CConstantNode, "10");
+    CBaseNode* Two = Add<CBaseNode>("Constant Node", &create_CConstantNode, &destroy_CConstantNode, "2");
+    CBaseNode* Zero = Add<CBaseNode>("Constant Node", &create_CConstantNode, &destroy_CConstantNode, "0");
+    CBaseNode* Quotient = Add<CBaseNode>("Divide Node", &create_CDivideNode, &destroy_CDivideNode);
+    CBaseNode* ByZero = Add<CBaseNode>("Divide Node", &create_CDivideNode, &destroy_CDivideNode);
+    CExecuteNode* First = Add<CExecuteNode>("Recording Node", &create_CRecordingNode, &destroy_CRecordingNode);
+    CExecuteNode* Delay = Add<CExecuteNode>("Delay Node", &create_CDelayNode, &destroy_CDelayNode, "0.050000");
+    CExecuteNode* Failed = Add<CExecuteNode>("Recording Node", &create_CRecordingNode, &destroy_CRecordingNode);
+    CExecuteNode* Second = Add<CExecuteNode>("Recording Node", &create_CRecordingNode, &destroy_CRecordingNode);
+
+    /// Sequence branch 0 records 10 / 2, waits, then records 10 / 0; branch 1 records 10 / 2 again
+    SCompilerBoard()
+    {
+        ConnectData(Ten, Quotient, 0, 0);
+        ConnectData(Two, Quotient, 0, 1);
+        ConnectData(Ten, ByZero, 0, 0);
+        ConnectData(Zero, ByZero, 0, 1);
+        ConnectData(Quotient, First, 0, 1);
+        ConnectData(ByZero, Failed, 0, 1);
+        ConnectData(Quotient, Second, 0, 1);
+
+        ConnectFlow(Entrance, Sequence);
+        ConnectFlow(Sequence, First, 0);
+        ConnectFlow(First, Delay);
+        ConnectFlow(Delay, Failed);
+        ConnectFlow(Sequence, Second, 1);
+    }
+
+    template <typename NodeTy>
+    NodeTy* Add(const std::string_view Name, const CBaseNode::CreateFunc Create, const CBaseNode::DestroyFunc Destroy, const std::string& Ext = { })
+    {
+        auto* Node = Create();
+        if (!Ext.empty())
+            Node->ReadExtraContext(Ext);
+
+        /// The graph owns the node, the board entry only describes it
+        Graph.Adopt(Node, Destroy);
+        Nodes.emplace_back(SBoardNode { .Name = std::string { Name }, .Ext = Ext, .Node = { Node, [](CBaseNode*) { } } });
+        return static_cast<NodeTy*>(Node);
+    }
+};
+
+/// Records left by running the flow from Entrance to its end
+std::vector<std::string> RunFlow(CExecutionManager& Manager, CExecuteNode* Entrance)
+{
+    GRecords.clear();
+
+    std::atomic<bool> Completed { false };
+    AMB_CHECK(Manager.StartExecuteAsync(Entrance, [&Completed] { Completed.store(true); }) != InvalidFlowId);
+    AMB_CHECK(WaitUntil([&Completed] { return Completed.load(); }));
+
+    std::lock_guard Lock { GRecordMutex };
+    return GRecords;
+}
+
+/// Any change to the generated code shows up here, regenerate CompiledBoard.cxx from the compiler's output after reviewing it
+void TestOutputMatchesCompiledBoard()
+{
+    const SCompilerBoard Board;
+    const auto Compiled = CompileBoard(Board.Nodes, "CompilerTest", "CompilerTestBoard.yaml");
+    AMB_CHECK(Compiled.Errors.empty());
+
+    std::ifstream File { AMB_COMPILED_BOARD_SOURCE, std::ios::binary };
+    std::stringstream Expected;
+    Expected << File.rdbuf();
+    AMB_CHECK(Compiled.Source == Expected.str());
+}
+
+/// The compiled node steps through the same plugin nodes, a failed division included
+void TestCompiledRunMatchesBoard()
+{
+    SCompilerBoard Board;
+    const auto Interpreted = RunFlow(*Board.Graph.Manager, Board.Entrance);
+    AMB_CHECK((Interpreted == std::vector<std::string> { "int32_t 5", "none", "int32_t 5" }));
+
+    STestGraph Graph;
+    auto* Entry = Graph.Spawn<CTestEntranceNode>();
+    auto* Node = create_CCompilerTestNode();
+    Graph.Adopt(Node, &destroy_CCompilerTestNode);
+
+    auto* Compiled = static_cast<CExecuteNode*>(Node);
+    AMB_CHECK(Compiled->IsSuspendable());
+    ConnectFlow(Entry, Compiled);
+
+    AMB_CHECK(RunFlow(*Graph.Manager, Entry) == Interpreted);
+    /// A second run goes through the nodes wired the first time
+    AMB_CHECK(RunFlow(*Graph.Manager, Entry) == Interpreted);
+}
+
+/// Flows meeting again have no straight-line order
+void TestJoinIsRejected()
+{
+    SCompilerBoard Board;
+    ConnectFlow(Board.Sequence, Board.First, 1);
+
+    const auto Compiled = CompileBoard(Board.Nodes, "CompilerTest");
+    AMB_CHECK(!Compiled.Errors.empty());
+    AMB_CHECK(Compiled.Source.empty());
+}
+}
+
+int main()
+{
+    return RunTests({
+        { "compiler/output_matches_compiled_board", TestOutputMatchesCompiledBoard },
+        { "compiler/compiled_run_matches_board", TestCompiledRunMatchesBoard },
+        { "compiler/join_is_rejected", TestJoinIsRejected },
+    });
+}
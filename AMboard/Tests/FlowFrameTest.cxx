@@ -0,0 +1,125 @@
+#include "TestHarness.hxx"
+
+#include <atomic>
+#include <map>
+#include <mutex>
+
+namespace {
+
+using namespace std::chrono_literals;
+
+/// Calls its body IterationCount times through the manager's frame stack, recording the state each return brings back per flow
+class CCountingLoopNode : public CExecuteNode {
+public:
+    static constexpr uint64_t IterationCount = 20;
+
+    CCountingLoopNode()
+    {
+        EmplacePin<CFlowPin>(false);
+    }
+
+    std::mutex Mutex;
+    std::map<FlowId, std::vector<uint64_t>> Returns;
+
+protected:
+    void Execute() override
+    {
+        CallSubFlow(1, 0);
+    }
+
+    void OnSubFlowEnd(const uint64_t State) override
+    {
+        {
+            std::lock_guard Lock { Mutex };
+            const auto* Flow = GetStep().Flow;
+            Returns[Flow != nullptr ? Flow->Id : InvalidFlowId].push_back(State);
+        }
+
+        if (State + 1 < IterationCount)
+            CallSubFlow(1, State + 1);
+        else
+            SetDesiredOutputPin(0);
+    }
+};
+
+/// Parks its flow for a moment so flows looping through the same node interleave
+class CYieldingNode : public CExecuteNode {
+protected:
+    CFlowTask ExecuteAsync() override
+    {
+        co_await Sleep(1ms);
+    }
+};
+
+class CCountingNode : public CExecuteNode {
+public:
+    std::atomic<int> Count { 0 };
+
+protected:
+    void Execute() override
+    {
+        Count.fetch_add(1, std::memory_order_relaxed);
+    }
+};
+
+/// Flows sharing one loop node each keep their own frames, a shared stack would mix up or drop their states
+void TestConcurrentFlowsKeepTheirFrames()
+{
+    constexpr size_t FlowCount = 6;
+
+    STestGraph Graph;
+    auto* Loop = Graph.Spawn<CCountingLoopNode>();
+    auto* Body = Graph.Spawn<CYieldingNode>();
+    auto* After = Graph.Spawn<CCountingNode>();
+    ConnectFlow(Loop, After, 0);
+    ConnectFlow(Loop, Body, 1);
+
+    std::atomic<size_t> Completed { 0 };
+    for (size_t Index = 0; Index < FlowCount; ++Index) {
+        auto* Entry = Graph.Spawn<CTestEntranceNode>();
+        ConnectFlow(Entry, Loop);
+        AMB_CHECK(Graph.Manager->StartExecuteAsync(Entry, [&Completed] { Completed.fetch_add(1); }) != InvalidFlowId);
+    }
+
+    AMB_CHECK(WaitUntil([&Completed] { return Completed.load() == FlowCount; }));
+    AMB_CHECK(After->Count.load() == static_cast<int>(FlowCount));
+
+    std::vector<uint64_t> Expected(CCountingLoopNode::IterationCount);
+    for (uint64_t Index = 0; Index < Expected.size(); ++Index)
+        Expected[Index] = Index;
+
+    std::lock_guard Lock { Loop->Mutex };
+    AMB_CHECK(Loop->Returns.size() == FlowCount);
+    for (const auto& States : Loop->Returns | std::views::values)
+        AMB_CHECK(States == Expected);
+}
+
+/// Nested loops unwind innermost first on the same flow
+void TestNestedCallsUnwindInOrder()
+{
+    STestGraph Graph;
+    auto* Entry = Graph.Spawn<CTestEntranceNode>();
+    auto* Outer = Graph.Spawn<CCountingLoopNode>();
+    auto* Inner = Graph.Spawn<CCountingLoopNode>();
+    auto* Body = Graph.Spawn<CCountingNode>();
+    auto* After = Graph.Spawn<CCountingNode>();
+    ConnectFlow(Entry, Outer);
+    ConnectFlow(Outer, Inner, 1);
+    ConnectFlow(Inner, Body, 1);
+    ConnectFlow(Outer, After, 0);
+
+    Graph.Manager->Execute(Entry);
+
+    constexpr auto Iterations = static_cast<int>(CCountingLoopNode::IterationCount);
+    AMB_CHECK(Body->Count.load() == Iterations * Iterations);
+    AMB_CHECK(After->Count.load() == 1);
+}
+}
+
+int main()
+{
+    return RunTests({
+        { "frames/concurrent_flows_keep_their_frames", TestConcurrentFlowsKeepTheirFrames },
+        { "frames/nested_calls_unwind_in_order", TestNestedCallsUnwindInOrder },
+    });
+}
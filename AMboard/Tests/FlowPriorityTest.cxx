@@ -0,0 +1,132 @@
+#include "TestHarness.hxx"
+
+#include <atomic>
+#include <mutex>
+#include <semaphore>
+
+namespace {
+
+using namespace std::chrono_literals;
+
+/// Blocks its flow worker until the test lets go
+class CBlockingNode : public CExecuteNode {
+public:
+    std::atomic<bool> IsBlocking { false };
+    std::binary_semaphore Release { 0 };
+
+protected:
+    void Execute() override
+    {
+        IsBlocking.store(true);
+        Release.acquire();
+    }
+};
+
+/// Appends Tag to the shared log once its flow runs
+class CRecordingNode : public CExecuteNode {
+public:
+    CRecordingNode(std::mutex& Mutex, std::vector<int>& Log, const int Tag)
+        : m_Mutex(Mutex)
+        , m_Log(Log)
+        , m_Tag(Tag)
+    {
+    }
+
+protected:
+    void Execute() override
+    {
+        std::lock_guard Lock { m_Mutex };
+        m_Log.push_back(m_Tag);
+    }
+
+    std::mutex& m_Mutex;
+    std::vector<int>& m_Log;
+    int m_Tag;
+};
+
+/// One flow worker, busy with a blocking flow while the flows under test queue up behind it
+struct SQueueGraph {
+    STestGraph Graph { 1 };
+    std::mutex Mutex;
+    std::vector<int> Log;
+    CBlockingNode* Blocker = nullptr;
+    size_t Started = 0;
+
+    SQueueGraph()
+    {
+        auto* Entry = Graph.Spawn<CTestEntranceNode>();
+        Blocker = Graph.Spawn<CBlockingNode>();
+        ConnectFlow(Entry, Blocker);
+        AMB_CHECK(Graph.Manager->StartExecuteAsync(Entry) != InvalidFlowId);
+        AMB_CHECK(WaitUntil([this] { return Blocker->IsBlocking.load(); }));
+    }
+
+    void Queue(const int Tag, const EFlowPriority Priority)
+    {
+        auto* Entry = Graph.Spawn<CTestEntranceNode>();
+        auto* Recorder = Graph.Spawn<CRecordingNode>(Mutex, Log, Tag);
+        Entry->SetFlowPriority(Priority);
+        ConnectFlow(Entry, Recorder);
+        AMB_CHECK(Graph.Manager->StartExecuteAsync(Entry) != InvalidFlowId);
+        ++Started;
+    }
+
+    std::vector<int> Drain()
+    {
+        Blocker->Release.release();
+        AMB_CHECK(WaitUntil([this] {
+            std::lock_guard Lock { Mutex };
+            return Log.size() == Started;
+        }));
+
+        std::lock_guard Lock { Mutex };
+        return Log;
+    }
+};
+
+/// Queued at about the same time, the more urgent class goes first
+void TestUrgentClassGoesFirst()
+{
+    SQueueGraph Queue;
+    Queue.Queue(0, EFlowPriority::Background);
+    Queue.Queue(1, EFlowPriority::Normal);
+    Queue.Queue(2, EFlowPriority::Normal);
+
+    AMB_CHECK((Queue.Drain() == std::vector { 1, 2, 0 }));
+}
+
+/// A background flow that waited longer than its aging delay overtakes normal flows queued after that
+void TestAgedFlowOvertakes()
+{
+    SQueueGraph Queue;
+    Queue.Queue(0, EFlowPriority::Background);
+    std::this_thread::sleep_for(120ms);
+    Queue.Queue(1, EFlowPriority::Normal);
+    Queue.Queue(2, EFlowPriority::Normal);
+
+    AMB_CHECK((Queue.Drain() == std::vector { 0, 1, 2 }));
+}
+
+/// Interactive flows have a worker of their own and start even while every other worker is busy
+void TestInteractiveSkipsBusyWorkers()
+{
+    SQueueGraph Queue;
+    Queue.Queue(0, EFlowPriority::Normal);
+    Queue.Queue(1, EFlowPriority::Interactive);
+
+    AMB_CHECK(WaitUntil([&Queue] {
+        std::lock_guard Lock { Queue.Mutex };
+        return Queue.Log == std::vector { 1 };
+    }, 1s));
+    AMB_CHECK((Queue.Drain() == std::vector { 1, 0 }));
+}
+}
+
+int main()
+{
+    return RunTests({
+        { "priority/urgent_class_goes_first", TestUrgentClassGoesFirst },
+        { "priority/aged_flow_overtakes", TestAgedFlowOvertakes },
+        { "priority/interactive_skips_busy_workers", TestInteractiveSkipsBusyWorkers },
+    });
+}
@@ -0,0 +1,128 @@
+#include "TestHarness.hxx"
+
+#include <AMboard/Macro/DataPin.hxx>
+
+#include <atomic>
+
+namespace {
+
+/// Produces its value, counting evaluations
+class CCountingSourceNode : public CBaseNode {
+public:
+    CCountingSourceNode()
+    {
+        EmplacePin<CDataPin>(false)->SetValueType("int");
+    }
+
+    std::atomic<int> Evaluated { 0 };
+    int Value = 1;
+
+    bool Evaluate() noexcept override
+    {
+        Evaluated.fetch_add(1, std::memory_order_relaxed);
+        GetOutputPins()[0]->As<CDataPin>()->PinSet(int, Value);
+        return true;
+    }
+};
+
+/// Adds one to its input, counting evaluations
+class CCountingIncrementNode : public CBaseNode {
+public:
+    CCountingIncrementNode()
+    {
+        EmplacePin<CDataPin>(true)->SetValueType("int");
+        EmplacePin<CDataPin>(false)->SetValueType("int");
+    }
+
+    std::atomic<int> Evaluated { 0 };
+
+    bool Evaluate() noexcept override
+    {
+        CBaseNode::Evaluate();
+        Evaluated.fetch_add(1, std::memory_order_relaxed);
+        const int Input = GetInputPins()[0]->As<CDataPin>()->PinGetTrivial(int);
+        GetOutputPins()[0]->As<CDataPin>()->PinSet(int, Input + 1);
+        return true;
+    }
+
+    [[nodiscard]] int GetResult() const noexcept { return GetOutputPins()[0]->As<CDataPin>()->PinGetTrivial(int); }
+};
+
+/// Source -> Middle -> Sink, registered in order
+struct SChainGraph {
+    STestGraph Graph;
+    CCountingSourceNode* Source = Graph.Spawn<CCountingSourceNode>();
+    CCountingIncrementNode* Middle = Graph.Spawn<CCountingIncrementNode>();
+    CCountingIncrementNode* Sink = Graph.Spawn<CCountingIncrementNode>();
+
+    SChainGraph()
+    {
+        ConnectData(Source, Middle);
+        ConnectData(Middle, Sink);
+    }
+
+    [[nodiscard]] bool Counts(const int SourceCount, const int MiddleCount, const int SinkCount) const
+    {
+        return Source->Evaluated.load() == SourceCount && Middle->Evaluated.load() == MiddleCount && Sink->Evaluated.load() == SinkCount;
+    }
+};
+
+/// A node is checked once per epoch, and nothing clean is evaluated again in a later one
+void TestSameEpochSkipsEvaluate()
+{
+    SChainGraph Chain;
+
+    Chain.Sink->Refresh(1);
+    AMB_CHECK(Chain.Counts(1, 1, 1));
+    AMB_CHECK(Chain.Sink->GetResult() == 3);
+
+    Chain.Sink->Refresh(1);
+    AMB_CHECK(Chain.Counts(1, 1, 1));
+
+    Chain.Sink->Refresh(2);
+    AMB_CHECK(Chain.Counts(1, 1, 1));
+    AMB_CHECK(!Chain.Sink->IsDirty());
+}
+
+/// Dirtiness spreads to every downstream node, the next refresh redoes all of them
+void TestMarkDirtyReevaluatesDownstream()
+{
+    SChainGraph Chain;
+    Chain.Sink->Refresh(1);
+    const auto SinkVersion = Chain.Sink->GetVersion();
+
+    Chain.Source->Value = 10;
+    Chain.Source->MarkDirty();
+    AMB_CHECK(Chain.Middle->IsDirty());
+    AMB_CHECK(Chain.Sink->IsDirty());
+
+    /// Same epoch as before, MarkDirty forgets it
+    Chain.Sink->Refresh(1);
+    AMB_CHECK(Chain.Counts(2, 2, 2));
+    AMB_CHECK(Chain.Sink->GetResult() == 12);
+    AMB_CHECK(Chain.Sink->GetVersion() > SinkVersion);
+}
+
+/// Only the dirty node and what follows it are redone, its clean upstream is reused
+void TestCleanUpstreamNotRerun()
+{
+    SChainGraph Chain;
+    Chain.Sink->Refresh(1);
+
+    Chain.Middle->MarkDirty();
+    AMB_CHECK(!Chain.Source->IsDirty());
+
+    Chain.Sink->Refresh(2);
+    AMB_CHECK(Chain.Counts(1, 2, 2));
+    AMB_CHECK(Chain.Sink->GetResult() == 3);
+}
+}
+
+int main()
+{
+    return RunTests({
+        { "memo/same_epoch_skips_evaluate", TestSameEpochSkipsEvaluate },
+        { "memo/mark_dirty_reevaluates_downstream", TestMarkDirtyReevaluatesDownstream },
+        { "memo/clean_upstream_not_rerun", TestCleanUpstreamNotRerun },
+    });
+}
@@ -0,0 +1,168 @@
+#include "TestHarness.hxx"
+
+#include <AMboard/Macro/DataPin.hxx>
+
+#include <atomic>
+
+namespace {
+
+/// Pure constant, counting evaluations
+class CConstantNode : public CBaseNode {
+public:
+    CConstantNode()
+    {
+        m_IsPure = true;
+        EmplacePin<CDataPin>(false)->SetValueType("int");
+    }
+
+    std::atomic<int> Evaluated { 0 };
+    int Value = 1;
+
+    bool Evaluate() noexcept override
+    {
+        Evaluated.fetch_add(1, std::memory_order_relaxed);
+        GetOutputPins()[0]->As<CDataPin>()->PinSet(int, Value);
+        return true;
+    }
+};
+
+/// Changes on every read, like a screen capture
+class CVolatileSourceNode : public CBaseNode {
+public:
+    CVolatileSourceNode()
+    {
+        m_IsVolatile = true;
+        EmplacePin<CDataPin>(false)->SetValueType("int");
+    }
+
+    std::atomic<int> Evaluated { 0 };
+
+    bool Evaluate() noexcept override
+    {
+        const int Count = Evaluated.fetch_add(1, std::memory_order_relaxed) + 1;
+        GetOutputPins()[0]->As<CDataPin>()->PinSet(int, Count);
+        return true;
+    }
+};
+
+/// Pure, adds one to its input
+class CIncrementNode : public CBaseNode {
+public:
+    CIncrementNode()
+    {
+        m_IsPure = true;
+        EmplacePin<CDataPin>(true)->SetValueType("int");
+        EmplacePin<CDataPin>(false)->SetValueType("int");
+    }
+
+    std::atomic<int> Evaluated { 0 };
+
+    bool Evaluate() noexcept override
+    {
+        CBaseNode::Evaluate();
+        Evaluated.fetch_add(1, std::memory_order_relaxed);
+        const int Input = GetInputPins()[0]->As<CDataPin>()->PinGetTrivial(int);
+        GetOutputPins()[0]->As<CDataPin>()->PinSet(int, Input + 1);
+        return true;
+    }
+};
+
+/// Pulls one int on every step
+class CReadingNode : public CExecuteNode {
+public:
+    CReadingNode()
+    {
+        EmplacePin<CDataPin>(true)->SetValueType("int");
+    }
+
+    std::atomic<int> Value { 0 };
+
+protected:
+    void Execute() override
+    {
+        PrepareInputPin();
+        Value.store(GetInputPins()[1]->As<CDataPin>()->PinGetTrivial(int));
+    }
+};
+
+/// Constants fold along the chain, a branch no execute node pulls from is dead and never evaluated
+void TestFoldsConstantChain()
+{
+    STestGraph Graph;
+    auto* Entry = Graph.Spawn<CTestEntranceNode>();
+    auto* Constant = Graph.Spawn<CConstantNode>();
+    auto* Increment = Graph.Spawn<CIncrementNode>();
+    auto* Unused = Graph.Spawn<CIncrementNode>();
+    auto* Reader = Graph.Spawn<CReadingNode>();
+    ConnectFlow(Entry, Reader);
+    ConnectData(Constant, Increment);
+    ConnectData(Constant, Unused);
+    ConnectData(Increment, Reader, 0, 1);
+
+    const auto Optimization = Graph.Optimize();
+    AMB_CHECK(Optimization.Folded == 2);
+    AMB_CHECK(Optimization.Dead == 1);
+    AMB_CHECK(Constant->IsFolded() && Increment->IsFolded());
+    AMB_CHECK(Unused->IsDead() && !Unused->IsFolded());
+
+    Graph.Manager->Execute(Entry);
+    Graph.Manager->Execute(Entry);
+    AMB_CHECK(Reader->Value.load() == 2);
+    AMB_CHECK(Constant->Evaluated.load() == 1 && Increment->Evaluated.load() == 1);
+    AMB_CHECK(Unused->Evaluated.load() == 0);
+}
+
+/// An edit marks the folded chain dirty, the next step picks up the new constant
+void TestFoldedChainFollowsEdits()
+{
+    STestGraph Graph;
+    auto* Entry = Graph.Spawn<CTestEntranceNode>();
+    auto* Constant = Graph.Spawn<CConstantNode>();
+    auto* Increment = Graph.Spawn<CIncrementNode>();
+    auto* Reader = Graph.Spawn<CReadingNode>();
+    ConnectFlow(Entry, Reader);
+    ConnectData(Constant, Increment);
+    ConnectData(Increment, Reader, 0, 1);
+
+    Graph.Optimize();
+    Graph.Manager->Execute(Entry);
+    AMB_CHECK(Reader->Value.load() == 2);
+
+    Constant->Value = 5;
+    Constant->MarkDirty();
+    Graph.Manager->Execute(Entry);
+    AMB_CHECK(Reader->Value.load() == 6);
+    AMB_CHECK(Constant->Evaluated.load() == 2 && Increment->Evaluated.load() == 2);
+}
+
+/// Anything fed by a volatile node is not folded and evaluated on every step
+void TestVolatileSourceNotFolded()
+{
+    STestGraph Graph;
+    auto* Entry = Graph.Spawn<CTestEntranceNode>();
+    auto* Source = Graph.Spawn<CVolatileSourceNode>();
+    auto* Increment = Graph.Spawn<CIncrementNode>();
+    auto* Reader = Graph.Spawn<CReadingNode>();
+    ConnectFlow(Entry, Reader);
+    ConnectData(Source, Increment);
+    ConnectData(Increment, Reader, 0, 1);
+
+    const auto Optimization = Graph.Optimize();
+    AMB_CHECK(Optimization.Folded == 0);
+    AMB_CHECK(Optimization.Dead == 0);
+
+    Graph.Manager->Execute(Entry);
+    Graph.Manager->Execute(Entry);
+    AMB_CHECK(Reader->Value.load() == 3);
+    AMB_CHECK(Source->Evaluated.load() == 2 && Increment->Evaluated.load() == 2);
+}
+}
+
+int main()
+{
+    return RunTests({
+        { "optimizer/folds_constant_chain", TestFoldsConstantChain },
+        { "optimizer/folded_chain_follows_edits", TestFoldedChainFollowsEdits },
+        { "optimizer/volatile_source_not_folded", TestVolatileSourceNotFolded },
+    });
+}
@@ -0,0 +1,146 @@
+#include "TestHarness.hxx"
+
+#include <AMboard/Macro/DataPin.hxx>
+
+#include <atomic>
+#include <semaphore>
+#include <stdexcept>
+#include <string>
+
+namespace {
+
+using namespace std::chrono_literals;
+
+/// Hands out a value produced on the worker pool, the producer holds until the test opens the gate
+class CGatedProducerNode : public CBaseNode {
+public:
+    CGatedProducerNode()
+    {
+        EmplacePin<CDataPin>(false)->SetValueType("string");
+    }
+
+    ~CGatedProducerNode() override
+    {
+        Gate->release(64);
+    }
+
+    std::shared_ptr<std::counting_semaphore<>> Gate = std::make_shared<std::counting_semaphore<>>(0);
+
+    bool Evaluate() noexcept override
+    {
+        CBaseNode::Evaluate();
+        GetOutputPins()[0]->As<CDataPin>()->SetAsync<std::string>(MakeDataType("string"), GetWorkerPool(), [Gate = Gate] {
+            Gate->acquire();
+            return std::make_shared<std::string>("produced");
+        });
+        return true;
+    }
+};
+
+class CWaitingNode : public CExecuteNode {
+public:
+    CWaitingNode()
+    {
+        EmplacePin<CDataPin>(true)->SetValueType("string");
+    }
+
+    std::atomic<bool> IsWaiting { false };
+    std::atomic<int> WokeNormally { -1 };
+    std::string Value;
+
+protected:
+    CFlowTask ExecuteAsync() override
+    {
+        PrepareInputPin();
+        const auto& Input = *GetInputPins()[1]->As<CDataPin>();
+
+        IsWaiting.store(Input.IsPending());
+        const bool Woke = co_await WaitForData(Input);
+        if (Woke)
+            Value = Input.Get<std::string>(MakeDataType("string"));
+        WokeNormally.store(Woke);
+    }
+};
+
+class CCountingNode : public CExecuteNode {
+public:
+    std::atomic<int> Count { 0 };
+
+protected:
+    void Execute() override
+    {
+        Count.fetch_add(1, std::memory_order_relaxed);
+    }
+};
+
+struct SPendingGraph {
+    /// A single flow worker, a flow blocking it would hold up every other flow
+    STestGraph Graph { 1 };
+    CTestEntranceNode* Entry = Graph.Spawn<CTestEntranceNode>();
+    CGatedProducerNode* Producer = Graph.Spawn<CGatedProducerNode>();
+    CWaitingNode* Waiter = Graph.Spawn<CWaitingNode>();
+
+    SPendingGraph()
+    {
+        ConnectFlow(Entry, Waiter);
+        Producer->GetOutputPins()[0]->ConnectPin(Waiter->GetInputPins()[1].get());
+    }
+};
+
+/// The waiting flow parks instead of holding its worker, and reads the value once it is produced
+void TestWaitParksUntilProduced()
+{
+    SPendingGraph Pending;
+
+    std::atomic<bool> Completed { false };
+    AMB_CHECK(Pending.Graph.Manager->StartExecuteAsync(Pending.Entry, [&Completed] { Completed.store(true); }) != InvalidFlowId);
+    AMB_CHECK(WaitUntil([&Pending] { return Pending.Waiter->IsWaiting.load(); }));
+
+    auto* OtherEntry = Pending.Graph.Spawn<CTestEntranceNode>();
+    auto* Counter = Pending.Graph.Spawn<CCountingNode>();
+    ConnectFlow(OtherEntry, Counter);
+    AMB_CHECK(Pending.Graph.Manager->StartExecuteAsync(OtherEntry) != InvalidFlowId);
+    AMB_CHECK(WaitUntil([Counter] { return Counter->Count.load() == 1; }, 1s));
+    AMB_CHECK(!Completed.load());
+
+    Pending.Producer->Gate->release();
+    AMB_CHECK(WaitUntil([&Completed] { return Completed.load(); }));
+    AMB_CHECK(Pending.Waiter->WokeNormally.load() == 1);
+    AMB_CHECK(Pending.Waiter->Value == "produced");
+}
+
+/// Stopping the flow ends the wait while the producer is still running
+void TestStopCancelsWait()
+{
+    SPendingGraph Pending;
+
+    std::atomic<bool> Completed { false };
+    const auto Flow = Pending.Graph.Manager->StartExecuteAsync(Pending.Entry, [&Completed] { Completed.store(true); });
+    AMB_CHECK(WaitUntil([&Pending] { return Pending.Waiter->IsWaiting.load(); }));
+
+    Pending.Graph.Manager->StopFlow(Flow);
+    AMB_CHECK(WaitUntil([&Completed] { return Completed.load(); }, 1s));
+    AMB_CHECK(Pending.Waiter->WokeNormally.load() == 0);
+    AMB_CHECK(Pending.Producer->GetOutputPins()[0]->As<CDataPin>()->IsPending());
+}
+
+/// A throwing producer leaves no value, TryGet reports that instead of Get handing out a null reference
+void TestFailedProducerLeavesNoValue()
+{
+    CBaseNode Owner;
+    auto* Pin = Owner.EmplacePin<CDataPin>(false);
+    Pin->SetAsync<std::string>(MakeDataType("string"), nullptr, []() -> std::shared_ptr<std::string> { throw std::runtime_error("capture failed"); });
+
+    AMB_CHECK(Pin->TryGet<std::string>(MakeDataType("string")) == nullptr);
+    AMB_CHECK(!Pin->IsPending());
+}
+}
+
+int main()
+{
+    return RunTests({
+        { "pending/wait_parks_until_produced", TestWaitParksUntilProduced },
+        { "pending/stop_cancels_wait", TestStopCancelsWait },
+        { "pending/failed_producer_leaves_no_value", TestFailedProducerLeavesNoValue },
+    });
+}
@@ -0,0 +1,115 @@
+#include "TestHarness.hxx"
+
+#include <atomic>
+#include <string>
+
+/// Exported by the common node plugin, the same factory the editor goes through
+extern "C" CBaseNode* create_CSequenceNode();
+extern "C" void destroy_CSequenceNode(CBaseNode* Node);
+
+namespace {
+
+using namespace std::chrono_literals;
+using Clock = std::chrono::steady_clock;
+
+/// Sleeps for its duration unless stopped first
+class CTimedBranchNode : public CExecuteNode {
+public:
+    explicit CTimedBranchNode(const Clock::duration Duration)
+        : m_Duration(Duration)
+    {
+    }
+
+    std::atomic<bool> IsFinished { false };
+    std::atomic<bool> IsStopped { false };
+
+protected:
+    CFlowTask ExecuteAsync() override
+    {
+        const bool Woke = co_await Sleep(m_Duration);
+        (Woke ? IsFinished : IsStopped).store(true);
+    }
+
+    Clock::duration m_Duration;
+};
+
+/// Mode values follow ESequenceMode in the plugin
+constexpr char SequentialMode = 0;
+constexpr char ParallelMode = 1;
+constexpr char RaceMode = 2;
+
+struct SSequenceGraph {
+    STestGraph Graph;
+    CTestEntranceNode* Entry = Graph.Spawn<CTestEntranceNode>();
+    CExecuteNode* Sequence = nullptr;
+    CTimedBranchNode* Fast = Graph.Spawn<CTimedBranchNode>(10ms);
+    CTimedBranchNode* Slow = Graph.Spawn<CTimedBranchNode>(400ms);
+
+    explicit SSequenceGraph(const char Mode)
+    {
+        /// Two flow output pins in the given mode, the way a board file stores it
+        auto* Node = create_CSequenceNode();
+        Node->ReadExtraContext(std::string { static_cast<char>(2), Mode });
+        Graph.Adopt(Node, &destroy_CSequenceNode);
+        Sequence = static_cast<CExecuteNode*>(Node);
+
+        ConnectFlow(Entry, Sequence);
+        ConnectFlow(Sequence, Fast, 0);
+        ConnectFlow(Sequence, Slow, 1);
+    }
+
+    /// Time until the flow through the sequence completed
+    Clock::duration Run()
+    {
+        std::atomic<bool> Completed { false };
+        const auto Start = Clock::now();
+        AMB_CHECK(Graph.Manager->StartExecuteAsync(Entry, [&Completed] { Completed.store(true); }) != InvalidFlowId);
+        AMB_CHECK(WaitUntil([&Completed] { return Completed.load(); }));
+        return Clock::now() - Start;
+    }
+};
+
+/// The first branch to finish continues the flow, the loser is stopped instead of joined
+void TestRaceContinuesAfterWinner()
+{
+    SSequenceGraph Race { RaceMode };
+
+    AMB_CHECK(Race.Run() < 200ms);
+    AMB_CHECK(Race.Fast->IsFinished.load());
+    AMB_CHECK(WaitUntil([&Race] { return Race.Slow->IsStopped.load(); }, 200ms));
+    AMB_CHECK(!Race.Slow->IsFinished.load());
+}
+
+/// Parallel mode joins every branch
+void TestParallelJoinsAllBranches()
+{
+    SSequenceGraph Parallel { ParallelMode };
+
+    AMB_CHECK(Parallel.Run() >= 400ms);
+    AMB_CHECK(Parallel.Fast->IsFinished.load());
+    AMB_CHECK(Parallel.Slow->IsFinished.load());
+}
+
+/// Sequential branches run one after another as sub-flows, the node itself never suspends
+void TestSequentialRunsWithoutSuspending()
+{
+    SSequenceGraph Sequential { SequentialMode };
+    AMB_CHECK(!Sequential.Sequence->IsSuspendable());
+
+    AMB_CHECK(Sequential.Run() >= 410ms);
+    AMB_CHECK(Sequential.Fast->IsFinished.load());
+    AMB_CHECK(Sequential.Slow->IsFinished.load());
+
+    Sequential.Sequence->ReadExtraContext(std::string { static_cast<char>(1), RaceMode });
+    AMB_CHECK(Sequential.Sequence->IsSuspendable());
+}
+}
+
+int main()
+{
+    return RunTests({
+        { "sequence/race_continues_after_winner", TestRaceContinuesAfterWinner },
+        { "sequence/parallel_joins_all_branches", TestParallelJoinsAllBranches },
+        { "sequence/sequential_runs_without_suspending", TestSequentialRunsWithoutSuspending },
+    });
+}
@@ -0,0 +1,156 @@
+#include "TestHarness.hxx"
+
+#include <AMboard/Macro/DataPin.hxx>
+
+#include <atomic>
+
+namespace {
+
+/// Changes on every read, keeps everything downstream from being folded
+class CVolatileSourceNode : public CBaseNode {
+public:
+    CVolatileSourceNode()
+    {
+        m_IsVolatile = true;
+        EmplacePin<CDataPin>(false)->SetValueType("int");
+    }
+
+    bool Evaluate() noexcept override
+    {
+        GetOutputPins()[0]->As<CDataPin>()->PinSet(int, ++m_Count);
+        return true;
+    }
+
+protected:
+    int m_Count = 0;
+};
+
+/// Pure, adds one to its input
+class CIncrementNode : public CBaseNode {
+public:
+    CIncrementNode()
+    {
+        m_IsPure = true;
+        EmplacePin<CDataPin>(true)->SetValueType("int");
+        EmplacePin<CDataPin>(false)->SetValueType("int");
+    }
+
+    std::atomic<int> Evaluated { 0 };
+
+    bool Evaluate() noexcept override
+    {
+        CBaseNode::Evaluate();
+        Evaluated.fetch_add(1, std::memory_order_relaxed);
+        const int Input = GetInputPins()[0]->As<CDataPin>()->PinGetTrivial(int);
+        GetOutputPins()[0]->As<CDataPin>()->PinSet(int, Input + 1);
+        return true;
+    }
+};
+
+/// Pulls two ints on every step
+class CPairReadingNode : public CExecuteNode {
+public:
+    CPairReadingNode()
+    {
+        EmplacePin<CDataPin>(true)->SetValueType("int");
+        EmplacePin<CDataPin>(true)->SetValueType("int");
+    }
+
+    std::atomic<int> First { 0 };
+    std::atomic<int> Second { 0 };
+
+protected:
+    void Execute() override
+    {
+        PrepareInputPin();
+        First.store(GetInputPins()[1]->As<CDataPin>()->PinGetTrivial(int));
+        Second.store(GetInputPins()[2]->As<CDataPin>()->PinGetTrivial(int));
+    }
+};
+
+struct SPairGraph {
+    STestGraph Graph;
+    CTestEntranceNode* Entry = Graph.Spawn<CTestEntranceNode>();
+    CVolatileSourceNode* Source = Graph.Spawn<CVolatileSourceNode>();
+    CPairReadingNode* Reader = Graph.Spawn<CPairReadingNode>();
+
+    SPairGraph()
+    {
+        ConnectFlow(Entry, Reader);
+    }
+};
+
+/// Two identical nodes on the same source, the second one takes over the first one's outputs
+void TestDuplicateEvaluatesOnce()
+{
+    SPairGraph Pair;
+    auto* Original = Pair.Graph.Spawn<CIncrementNode>();
+    auto* Duplicate = Pair.Graph.Spawn<CIncrementNode>();
+    ConnectData(Pair.Source, Original);
+    ConnectData(Pair.Source, Duplicate);
+    ConnectData(Original, Pair.Reader, 0, 1);
+    ConnectData(Duplicate, Pair.Reader, 0, 2);
+
+    AMB_CHECK(Pair.Graph.Optimize().Shared == 1);
+    AMB_CHECK(Duplicate->GetSharedWith() == Original);
+
+    for (int Step = 1; Step <= 3; ++Step) {
+        Pair.Graph.Manager->Execute(Pair.Entry);
+        AMB_CHECK(Pair.Reader->First.load() == Step + 1);
+        AMB_CHECK(Pair.Reader->Second.load() == Step + 1);
+    }
+    AMB_CHECK(Original->Evaluated.load() == 3);
+    AMB_CHECK(Duplicate->Evaluated.load() == 0);
+}
+
+/// Upstream duplicates resolve first, so a copied chain collapses onto the original as a whole
+void TestDuplicateChainsCollapse()
+{
+    SPairGraph Pair;
+    auto* First = Pair.Graph.Spawn<CIncrementNode>();
+    auto* Second = Pair.Graph.Spawn<CIncrementNode>();
+    auto* FirstCopy = Pair.Graph.Spawn<CIncrementNode>();
+    auto* SecondCopy = Pair.Graph.Spawn<CIncrementNode>();
+    ConnectData(Pair.Source, First);
+    ConnectData(First, Second);
+    ConnectData(Pair.Source, FirstCopy);
+    ConnectData(FirstCopy, SecondCopy);
+    ConnectData(Second, Pair.Reader, 0, 1);
+    ConnectData(SecondCopy, Pair.Reader, 0, 2);
+
+    AMB_CHECK(Pair.Graph.Optimize().Shared == 2);
+    AMB_CHECK(FirstCopy->GetSharedWith() == First);
+    AMB_CHECK(SecondCopy->GetSharedWith() == Second);
+
+    Pair.Graph.Manager->Execute(Pair.Entry);
+    AMB_CHECK(Pair.Reader->First.load() == 3 && Pair.Reader->Second.load() == 3);
+    AMB_CHECK(FirstCopy->Evaluated.load() == 0 && SecondCopy->Evaluated.load() == 0);
+}
+
+/// Same type and source but a different constant input, nothing to share
+void TestDifferentInputsNotShared()
+{
+    SPairGraph Pair;
+    auto* One = Pair.Graph.Spawn<CIncrementNode>();
+    auto* Two = Pair.Graph.Spawn<CIncrementNode>();
+    One->GetInputPins()[0]->As<CDataPin>()->PinSet(int, 1);
+    Two->GetInputPins()[0]->As<CDataPin>()->PinSet(int, 2);
+    ConnectData(One, Pair.Reader, 0, 1);
+    ConnectData(Two, Pair.Reader, 0, 2);
+
+    AMB_CHECK(Pair.Graph.Optimize().Shared == 0);
+    AMB_CHECK(One->GetSharedWith() == nullptr && Two->GetSharedWith() == nullptr);
+
+    Pair.Graph.Manager->Execute(Pair.Entry);
+    AMB_CHECK(Pair.Reader->First.load() == 2 && Pair.Reader->Second.load() == 3);
+}
+}
+
+int main()
+{
+    return RunTests({
+        { "shared/duplicate_evaluates_once", TestDuplicateEvaluatesOnce },
+        { "shared/duplicate_chains_collapse", TestDuplicateChainsCollapse },
+        { "shared/different_inputs_not_shared", TestDifferentInputsNotShared },
+    });
+}
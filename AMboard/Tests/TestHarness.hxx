@@ -0,0 +1,113 @@
+#pragma once
+
+#include <AMboard/Macro/ExecuteNode.hxx>
+#include <AMboard/Macro/ExecutionManager.hxx>
+
+#include <chrono>
+#include <cstdio>
+#include <functional>
+#include <memory>
+#include <ranges>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+/// Failed checks are counted and reported, the test keeps going so one run shows every failure
+inline int GFailedChecks = 0;
+
+#define AMB_CHECK(Expr)                                                            \
+    do {                                                                           \
+        if (!(Expr)) {                                                             \
+            ++GFailedChecks;                                                       \
+            std::fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #Expr); \
+        }                                                                          \
+    } while (false)
+
+/// Run every case in order, the exit code tells ctest whether any check failed
+inline int RunTests(const std::vector<std::pair<std::string_view, std::function<void()>>>& Cases)
+{
+    for (const auto& [Name, Case] : Cases) {
+        const int FailedBefore = GFailedChecks;
+        Case();
+        std::fprintf(stderr, "[%s] %.*s\n", GFailedChecks == FailedBefore ? "PASS" : "FAIL", static_cast<int>(Name.size()), Name.data());
+    }
+
+    return GFailedChecks == 0 ? 0 : 1;
+}
+
+/// Poll until Predicate holds or Timeout passes, false on timeout
+inline bool WaitUntil(const std::function<bool()>& Predicate, const std::chrono::milliseconds Timeout = std::chrono::seconds(5))
+{
+    const auto Deadline = std::chrono::steady_clock::now() + Timeout;
+    while (!Predicate()) {
+        if (std::chrono::steady_clock::now() >= Deadline)
+            return false;
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    return true;
+}
+
+/// Nodes of one test graph, released before the manager they are registered with
+struct STestGraph {
+    using NodeStorage = std::unique_ptr<CBaseNode, void (*)(CBaseNode*)>;
+
+    std::unique_ptr<CExecutionManager> Manager;
+    std::vector<NodeStorage> Nodes;
+
+    explicit STestGraph(const size_t MaxFlowWorkers = 64)
+        : Manager(std::make_unique<CExecutionManager>(MaxFlowWorkers))
+    {
+    }
+
+    ~STestGraph()
+    {
+        Manager->StopAllFlows();
+        WaitUntil([this] { return Manager->GetRunningFlowCount() == 0; });
+        Nodes.clear();
+        Manager.reset();
+    }
+
+    template <typename NodeTy, typename... Args>
+    NodeTy* Spawn(Args&&... Arguments)
+    {
+        auto* Node = new NodeTy(std::forward<Args>(Arguments)...);
+        if constexpr (std::derived_from<NodeTy, CExecuteNode>)
+            DeduceNodeTraits(Node);
+        Adopt(Node, [](CBaseNode* Owned) { delete Owned; });
+        return Node;
+    }
+
+    /// Optimize the whole graph, the way the editor does after loading a board
+    SGraphOptimization Optimize() const
+    {
+        const auto Pointers = Nodes | std::views::transform([](const NodeStorage& Node) { return Node.get(); }) | std::ranges::to<std::vector>();
+        return Manager->OptimizeGraph(Pointers);
+    }
+
+    /// Register a node made elsewhere, such as by a plugin, Destroy releases it
+    void Adopt(CBaseNode* Node, void (*Destroy)(CBaseNode*))
+    {
+        Nodes.emplace_back(Node, Destroy);
+        Manager->RegisterNode(Node);
+    }
+};
+
+/// Flow entry, an execute node without a flow input
+class CTestEntranceNode : public CExecuteNode {
+public:
+    CTestEntranceNode()
+    {
+        ErasePin(GetFlowInputPins()[0]);
+    }
+};
+
+inline void ConnectFlow(const CExecuteNode* From, const CExecuteNode* To, const size_t Pin = 0)
+{
+    From->GetFlowOutputPins()[Pin]->ConnectPin(To->GetFlowInputPins()[0]);
+}
+
+inline void ConnectData(const CBaseNode* From, const CBaseNode* To, const size_t OutputPin = 0, const size_t InputPin = 0)
+{
+    From->GetOutputPins()[OutputPin]->ConnectPin(To->GetInputPins()[InputPin].get());
+}
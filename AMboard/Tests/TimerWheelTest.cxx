@@ -0,0 +1,96 @@
+#include "TestHarness.hxx"
+
+#include <AMboard/Macro/TimerWheel.hxx>
+
+#include <atomic>
+#include <mutex>
+
+namespace {
+
+using namespace std::chrono_literals;
+using Clock = std::chrono::steady_clock;
+
+/// Deadlines spread over the first two levels and past a cascade, in a scrambled order
+void TestFiresInDeadlineOrder()
+{
+    CTimerWheel Wheel;
+    std::mutex Mutex;
+    std::vector<int> Order;
+    bool IsEarly = false;
+
+    const auto Start = Clock::now();
+    for (const int Delay : { 150, 5, 70, 40 }) {
+        Wheel.Schedule(Start + std::chrono::milliseconds(Delay), [&, Delay, Start] {
+            std::lock_guard Lock { Mutex };
+            IsEarly |= Clock::now() < Start + std::chrono::milliseconds(Delay);
+            Order.push_back(Delay);
+        });
+    }
+
+    AMB_CHECK(WaitUntil([&] { return Wheel.GetPendingCount() == 0; }));
+
+    std::lock_guard Lock { Mutex };
+    AMB_CHECK((Order == std::vector { 5, 40, 70, 150 }));
+    AMB_CHECK(!IsEarly);
+}
+
+/// The timer thread sleeps towards the far deadline and must be woken for the near one
+void TestEarlierTimerWakesSleepingWheel()
+{
+    CTimerWheel Wheel;
+    std::atomic<bool> Fired { false };
+
+    Wheel.Schedule(2s, [] { });
+    std::this_thread::sleep_for(5ms);
+
+    const auto Start = Clock::now();
+    Wheel.Schedule(10ms, [&Fired] { Fired.store(true); });
+
+    AMB_CHECK(WaitUntil([&Fired] { return Fired.load(); }, 1s));
+    AMB_CHECK(Clock::now() - Start < 500ms);
+}
+
+class CSleepingNode : public CExecuteNode {
+public:
+    std::atomic<bool> IsSleeping { false };
+    std::atomic<int> WokeNormally { -1 };
+
+protected:
+    CFlowTask ExecuteAsync() override
+    {
+        IsSleeping.store(true);
+        WokeNormally.store(co_await Sleep(300ms));
+    }
+};
+
+/// A stop request ends the wait long before the deadline, the timer still pending fires into nothing later
+void TestStopCancelsSleep()
+{
+    STestGraph Graph;
+    auto* Entry = Graph.Spawn<CTestEntranceNode>();
+    auto* Sleeper = Graph.Spawn<CSleepingNode>();
+    ConnectFlow(Entry, Sleeper);
+
+    std::atomic<bool> Completed { false };
+    const auto Flow = Graph.Manager->StartExecuteAsync(Entry, [&Completed] { Completed.store(true); });
+    AMB_CHECK(Flow != InvalidFlowId);
+    AMB_CHECK(WaitUntil([Sleeper] { return Sleeper->IsSleeping.load(); }));
+
+    const auto Stopped = Clock::now();
+    Graph.Manager->StopFlow(Flow);
+    AMB_CHECK(WaitUntil([&Completed] { return Completed.load(); }, 1s));
+    AMB_CHECK(Clock::now() - Stopped < 150ms);
+    AMB_CHECK(Sleeper->WokeNormally.load() == 0);
+
+    AMB_CHECK(WaitUntil([&Graph] { return Graph.Manager->GetTimerWheel()->GetPendingCount() == 0; }, 1s));
+}
+}
+
+int main()
+{
+    return RunTests({
+        { "timer/fires_in_deadline_order", TestFiresInDeadlineOrder },
+        { "timer/earlier_timer_wakes_sleeping_wheel", TestEarlierTimerWakesSleepingWheel },
+        { "timer/stop_cancels_sleep", TestStopCancelsSleep },
+    });
+}
@@ -0,0 +1,72 @@
+#include "TestHarness.hxx"
+
+#include <AMboard/Macro/DataPin.hxx>
+
+namespace {
+
+/// One int in, one int out
+class CPassNode : public CBaseNode {
+public:
+    CPassNode()
+    {
+        EmplacePin<CDataPin>(true)->SetValueType("int");
+        EmplacePin<CDataPin>(false)->SetValueType("int");
+    }
+};
+
+bool TryConnect(const CBaseNode* From, const CBaseNode* To)
+{
+    return From->GetOutputPins()[0]->ConnectPin(To->GetInputPins()[0].get());
+}
+
+/// Closing a loop is rejected, wherever the new edge sits in the order
+void TestRejectsCycles()
+{
+    STestGraph Graph;
+    auto* First = Graph.Spawn<CPassNode>();
+    auto* Second = Graph.Spawn<CPassNode>();
+    auto* Third = Graph.Spawn<CPassNode>();
+
+    AMB_CHECK(TryConnect(First, Second));
+    AMB_CHECK(TryConnect(Second, Third));
+    AMB_CHECK(!TryConnect(Third, First));
+    AMB_CHECK(!TryConnect(Third, Third));
+    AMB_CHECK(!*First->GetInputPins()[0]);
+}
+
+/// Connecting against the registration order reorders, producers always come first
+void TestReordersAfterConnect()
+{
+    STestGraph Graph;
+    auto* Consumer = Graph.Spawn<CPassNode>();
+    auto* Middle = Graph.Spawn<CPassNode>();
+    auto* Producer = Graph.Spawn<CPassNode>();
+
+    AMB_CHECK(TryConnect(Middle, Consumer));
+    AMB_CHECK(TryConnect(Producer, Middle));
+    AMB_CHECK(Producer->GetTopologicalOrder() < Middle->GetTopologicalOrder());
+    AMB_CHECK(Middle->GetTopologicalOrder() < Consumer->GetTopologicalOrder());
+    AMB_CHECK(!TryConnect(Consumer, Producer));
+}
+
+/// A node not registered yet has order 0, which says nothing about its place
+void TestUnregisteredNodeStillChecked()
+{
+    STestGraph Graph;
+    auto* Registered = Graph.Spawn<CPassNode>();
+    const auto Unregistered = std::make_unique<CPassNode>();
+
+    AMB_CHECK(TryConnect(Registered, Unregistered.get()));
+    AMB_CHECK(!TryConnect(Unregistered.get(), Registered));
+    AMB_CHECK(!*Registered->GetInputPins()[0]);
+}
+}
+
+int main()
+{
+    return RunTests({
+        { "topology/rejects_cycles", TestRejectsCycles },
+        { "topology/reorders_after_connect", TestReordersAfterConnect },
+        { "topology/unregistered_node_still_checked", TestUnregisteredNodeStillChecked },
+    });
+}
@@ -0,0 +1,87 @@
+#include "TestHarness.hxx"
+
+#include <AMboard/Macro/WorkStealingPool.hxx>
+
+#include <atomic>
+#include <latch>
+#include <mutex>
+#include <set>
+
+namespace {
+
+void TestGroupRunsEveryTask()
+{
+    CWorkStealingPool Pool { 3 };
+    std::atomic<int> Sum { 0 };
+
+    CWorkStealingPool::CTaskGroup Group { Pool };
+    for (int Index = 1; Index <= 1000; ++Index)
+        Group.Run([&Sum, Index] { Sum.fetch_add(Index, std::memory_order_relaxed); });
+    Group.Wait();
+
+    AMB_CHECK(Sum.load() == 500500);
+}
+
+/// Tasks block until every worker holds one, only possible if the pushed tasks got stolen off the caller's group
+void TestIdleWorkersSteal()
+{
+    CWorkStealingPool Pool { 3 };
+    std::latch AllBusy { 3 };
+    std::mutex IdMutex;
+    std::set<std::thread::id> Ids;
+
+    CWorkStealingPool::CTaskGroup Group { Pool };
+    for (int Index = 0; Index < 3; ++Index)
+        Group.Run([&] {
+            {
+                std::lock_guard Lock { IdMutex };
+                Ids.insert(std::this_thread::get_id());
+            }
+            AllBusy.arrive_and_wait();
+        });
+    Group.Wait();
+
+    AMB_CHECK(Ids.size() == 3);
+}
+
+/// A task joining a group of its own helps with it, so nesting deeper than the worker count never deadlocks
+void TestNestedGroupsJoin()
+{
+    CWorkStealingPool Pool { 1 };
+    std::atomic<int> Leaves { 0 };
+
+    const std::function<void(int)> Spawn = [&](const int Depth) {
+        if (Depth == 0) {
+            Leaves.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+
+        CWorkStealingPool::CTaskGroup Group { Pool };
+        Group.Run([&, Depth] { Spawn(Depth - 1); });
+        Group.Run([&, Depth] { Spawn(Depth - 1); });
+        Group.Wait();
+    };
+    Spawn(6);
+
+    AMB_CHECK(Leaves.load() == 64);
+}
+
+void TestDetachedTaskRuns()
+{
+    CWorkStealingPool Pool { 2 };
+    std::atomic<bool> Ran { false };
+
+    Pool.Detach([&Ran] { Ran.store(true); });
+    AMB_CHECK(WaitUntil([&Ran] { return Ran.load(); }));
+}
+}
+
+int main()
+{
+    return RunTests({
+        { "pool/group_runs_every_task", TestGroupRunsEveryTask },
+        { "pool/idle_workers_steal", TestIdleWorkersSteal },
+        { "pool/nested_groups_join", TestNestedGroupsJoin },
+        { "pool/detached_task_runs", TestDetachedTaskRuns },
+    });
+}
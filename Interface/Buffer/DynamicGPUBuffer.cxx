@@ -2,6 +2,7 @@
 // Created by LYS on 2/17/2026.
 //
 
+#include <algorithm>
 #include <utility>
 
 #include "DynamicGPUBuffer.hxx"
@@ -46,5 +47,27 @@ void CDynamicGPUBuffer::Resize(std::size_t Count)
 
 void CDynamicGPUBuffer::Upload(const std::size_t Offset, const std::size_t Count) const noexcept
 {
+    if (m_DeferDepth != 0) {
+        m_DirtyBegin = std::min(m_DirtyBegin, Offset);
+        m_DirtyEnd = std::max(m_DirtyEnd, Offset + Count);
+        return;
+    }
+
     m_Window->GetQueue().WriteBuffer(m_RenderBuffer, Offset * m_BytePerElement, m_Data.data() + Offset * m_BytePerElement, Count * m_BytePerElement);
+}
+
+void CDynamicGPUBuffer::BeginDeferredUpload() noexcept
+{
+    ++m_DeferDepth;
+}
+
+void CDynamicGPUBuffer::EndDeferredUpload() noexcept
+{
+    if (--m_DeferDepth != 0 || m_DirtyBegin >= m_DirtyEnd)
+        return;
+
+    const auto Begin = std::exchange(m_DirtyBegin, std::numeric_limits<std::size_t>::max());
+    const auto End = std::min<std::size_t>(std::exchange(m_DirtyEnd, 0), m_LogicalBufferSize);
+    if (Begin < End)
+        Upload(Begin, End - Begin);
 }
\ No newline at end of file
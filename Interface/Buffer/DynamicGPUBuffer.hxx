@@ -6,6 +6,7 @@
 
 #include <dawn/webgpu_cpp.h>
 
+#include <limits>
 #include <memory>
 #include <ranges>
 #include <stdexcept>
@@ -53,6 +54,10 @@ public:
 
     void Upload(std::size_t Offset, std::size_t Count = 1) const noexcept;
 
+    /// Until the matching end, uploads only widen a dirty range which is then written in one go
+    void BeginDeferredUpload() noexcept;
+    void EndDeferredUpload() noexcept;
+
     template <typename Ty>
     auto Upload(Ty* Value) const noexcept
     {
@@ -95,5 +100,9 @@ protected:
     wgpu::Buffer m_RenderBuffer;
     std::vector<uint8_t> m_Data;
 
+    uint32_t m_DeferDepth = 0;
+    mutable std::size_t m_DirtyBegin = std::numeric_limits<std::size_t>::max();
+    mutable std::size_t m_DirtyEnd = 0;
+
     const CWindowBase* m_Window;
 };